@@ -43,6 +43,8 @@ using namespace llvm;
 
 // This enables to give the database filename per command line paramater to llvm's opt
 static cl::opt<string> CLOPT_DB("mekong_db", cl::desc("specifies the database file for mekong (format .json)"), cl::value_desc("filename"));
+// Optional binary database, which the runtime loads at startup (see runtime/src/analysis_db_format.h)
+static cl::opt<string> CLOPT_BIN_DB("mekong_bin_db", cl::desc("specifies the binary database file for mekong's runtime"), cl::value_desc("filename"));
 
 struct bsp_analysis : public ModulePass {
 	static char ID; // Pass identification, replacement for typeid
@@ -119,7 +121,7 @@ bool bsp_analysis::runOnModule(Module& M) {
 	dbWriter.setIslArrayDimSizes(islArrayDimSizes_);
 
 	errs() << "  * Writing database to file " << CLOPT_DB.getValue() << '\n';
-	dbWriter.write(CLOPT_DB.getValue().c_str());
+	dbWriter.write(CLOPT_DB.getValue().c_str(), CLOPT_BIN_DB.getValue().c_str());
 	errs() << "[-] CLASS bsp_analysis, FUNC runOnModule()\n";
 	return false; // true if module was modificated //
 }
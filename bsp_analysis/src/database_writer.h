@@ -22,6 +22,7 @@
 #include <cstdint>
 
 #include "dashdb.h"
+#include "analysis_db_format.h" // binary database for the runtime
 
 using namespace std;
 using namespace llvm;
@@ -49,7 +50,8 @@ class DatabaseWriter {
 		                   { islArrayDimSizes_ = islArrayDimSizes; }
 		const vector<const Function*>& getKernels() const { return kernels_; }
 
-		void write(const char* filename); // can not be const, as root_ is changed
+		void write(const char* filename, // can not be const, as root_ is changed
+		           const char* binFilename = nullptr);
 
 	private:
 		vector<const Function*> kernels_;
@@ -86,7 +88,9 @@ void DatabaseWriter::setIslReadWriteParameterStrings(
 
 //! Only reasonable and available information will be written to the
 //! specified file. Thus empty read/write access maps will not be listed.
-void DatabaseWriter::write(const char* filename) {
+//! If \param binFilename is given, the same information is written to
+//! the binary database, which the runtime loads at startup.
+void DatabaseWriter::write(const char* filename, const char* binFilename) {
 	errs() << "[+] CLASS DatabaseWriter, FUNC write():\n";
 
 	// GETS THE POINTER LEVEL OF A TYPE
@@ -132,7 +136,9 @@ void DatabaseWriter::write(const char* filename) {
 	// BUILDING THE DASHDB OBJECT //
 	unsigned kernelNr = 0;
 	dashdb::Butler b;
+	AnalysisDBFormat::Writer binWriter;
 	for (const Function* kernel : kernels_) {
+		vector<AnalysisDBFormat::Writer::ArgDesc> binArgs;
 		errs() << "  * Creating dashdb object for kernel " << kernel->getName().str() << '\n';
 		b["kernels"][kernelNr]["partitioning"] = partitioning_.at(kernel);
 		b["kernels"][kernelNr]["name"] = kernel->getName().str();
@@ -156,6 +162,12 @@ void DatabaseWriter::write(const char* filename) {
 			// if an argument has a non-pointer type it has no elements to point to,
 			// thus we set the size of the elements to zero
 			b["kernels"][kernelNr]["arguments"][argumentNr]["element size"] = fundT != argType ? fundT->getPrimitiveSizeInBits() : 0;
+			AnalysisDBFormat::Writer::ArgDesc binArg;
+			binArg.typeName = getTypeString(argType);
+			binArg.pointerLevel = getPointerLVL(argType);
+			binArg.fundamentalType = getTypeChar(fundT)[0];
+			binArg.sizeBits = argType->getPrimitiveSizeInBits();
+			binArg.elementSizeBits = fundT != argType ? fundT->getPrimitiveSizeInBits() : 0;
 
 			// WRITE ISL READ AND WRITE MAPS
 			try { // write only information which is available
@@ -163,9 +175,11 @@ void DatabaseWriter::write(const char* filename) {
 				string wmap = islWrite_.at(kernel).at(argumentNr);
 				if (rmap != "null" && !rmap.empty()) {
 					b["kernels"][kernelNr]["arguments"][argumentNr]["isl read map"] = rmap;
+					binArg.islRead = rmap;
 				}
 				if (wmap != "null" && !wmap.empty()) {
 					b["kernels"][kernelNr]["arguments"][argumentNr]["isl write map"] = wmap;
+					binArg.islWrite = wmap;
 				}
 			} catch(...) {}
 
@@ -175,12 +189,14 @@ void DatabaseWriter::write(const char* filename) {
 				if (numReadParams != 0) {
 					for (int i = 0; i < numReadParams; ++i) {
 						b["kernels"][kernelNr]["arguments"][argumentNr]["isl read params"][i] = islReadParameters_.at(kernel)[argumentNr][i];
+						binArg.readParams.push_back(islReadParameters_.at(kernel)[argumentNr][i]);
 					}
 				}
 				int numWriteParams = islWriteParameters_.at(kernel)[argumentNr].size();
 				if (numWriteParams != 0) {
 					for (int i = 0; i < numWriteParams; ++i) {
 						b["kernels"][kernelNr]["arguments"][argumentNr]["isl write params"][i] = islWriteParameters_.at(kernel)[argumentNr][i];
+						binArg.writeParams.push_back(islWriteParameters_.at(kernel)[argumentNr][i]);
 					}
 				}
 			} catch(...) {}
@@ -190,6 +206,7 @@ void DatabaseWriter::write(const char* filename) {
 				int dimSize = islNumDimArrays_.at(kernel)[argumentNr];
 				if (dimSize != 0) { // write dim size only if it is not zero, as this is trivial
 					b["kernels"][kernelNr]["arguments"][argumentNr]["num dimensions"] = dimSize;
+					binArg.numDims = dimSize;
 				}
 			}
 			catch(...) {}
@@ -201,11 +218,14 @@ void DatabaseWriter::write(const char* filename) {
 					for (int i = 0; i < dimSizes.size(); ++i) {
 						b["kernels"][kernelNr]["arguments"][argumentNr]["dim sizes"][i] = dimSizes[i];
 					}
+					binArg.dimSizes = dimSizes;
 				}
 			}
 			catch(...) {}
+			binArgs.push_back(move(binArg));
 		}
 
+		binWriter.addKernel(kernel->getName().str(), partitioning_.at(kernel), binArgs);
 		++kernelNr;
 	}
 
@@ -214,6 +234,11 @@ void DatabaseWriter::write(const char* filename) {
 
 	b.write(filename);
 
+	if (binFilename != nullptr && *binFilename != '\0') {
+		errs() << "  * Building the binary database file...\n";
+		binWriter.write(binFilename);
+	}
+
 	errs() << "[-] CLASS DatabaseWriter, FUNC write()\n";
 }
 
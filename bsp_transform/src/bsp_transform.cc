@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <cctype> // toupper
 
 #include "promoter.h"
 #include "propagator.h"
@@ -42,6 +43,9 @@ namespace {
 // Here we get the command line argument from opt
 // CLOPT_DB.getValue().c_str() gets you the c-string
 static cl::opt<string> CLOPT_DB("mekong_db", cl::desc("specifies the database file for mekong (format .ddb)"), cl::value_desc("filename"));
+// the runtime may choose another partitioning than the database's
+// (USER_OPTION_PICK_PARTITIONING), thus add the offsets on every axis
+static cl::opt<bool> CLOPT_ALL_AXES("mekong_all_axes", cl::desc("adds the partition offset to every axis"), cl::init(false));
 
 /*! \brief Transforms the device code and splits along a specified dimension.
 
@@ -95,9 +99,22 @@ struct bsp_transform : public ModulePass {
 		else if (dbPattern == "y") {
 			pattern = "OneDim_Y";
 		}
+		else if (dbPattern == "z") {
+			pattern = "OneDim_Z";
+		}
+		else if (dbPattern == "xy" || dbPattern == "xz" || dbPattern == "yz" ||
+		         dbPattern == "xyz") {
+			pattern = "MultiDim_";
+			for (char axis : dbPattern) {
+				pattern += toupper(axis);
+			}
+		}
 		else {
 			throwError(string("I do not know the partitioning pattern: ") + dbPattern);
 		}
+		if (CLOPT_ALL_AXES) {
+			pattern = "MultiDim_XYZ";
+		}
 		Offsetter of(pr.getMapping(), pattern);
 		of.run();
 		return true; // true if module was modificated //
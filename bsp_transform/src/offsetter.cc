@@ -45,6 +45,13 @@ std::unique_ptr<Pattern> Offsetter::getPattern() const {
 	if (patternStr_ == std::string("OneDim_X")) {
 		return std::unique_ptr<Pattern>(new OneDim_X);
 	}
+	if (patternStr_ == std::string("OneDim_Z")) {
+		return std::unique_ptr<Pattern>(new OneDim_Z);
+	}
+	// MultiDim_XY, MultiDim_XYZ, ...
+	if (patternStr_.compare(0, 9, "MultiDim_") == 0) {
+		return std::unique_ptr<Pattern>(new MultiDim(patternStr_.substr(9)));
+	}
 	// more patterns will be added here //
 	else {
 		return nullptr;
@@ -183,4 +183,52 @@ void OneDim_X::operator()(Function* f) const {
 	DEBUG(errs() << "[-] CLASS OneDim_X, FUNC operator()\n");
 }
 
+void OneDim_Z::operator()(Function* f) const {
+	DEBUG(errs() << "[+] CLASS OneDim_Z, FUNC operator():\n");
+	if (!f) {
+		DEBUG(errs() << "\t* got nullptr\n");
+		DEBUG(errs() << "[-] CLASS OneDim_Z, FUNC operator()\n");
+		return;
+	}
+	DEBUG(errs() << "\t* given function name " << f->getName() << '\n');
+	// get the calls of get_global_id(2) //
+	std::vector<CallInst*> worklist(getWorkList(2, f));
+	for (auto* ci : worklist) {
+		addOffsetAndReplace(ci);
+	}
+	DEBUG(errs() << "[-] CLASS OneDim_Z, FUNC operator()\n");
+}
+
+MultiDim::MultiDim(const std::string& axes) {
+	for (char axis : axes) {
+		if (axis == 'X' || axis == 'x') {
+			axes_.push_back(0);
+		}
+		else if (axis == 'Y' || axis == 'y') {
+			axes_.push_back(1);
+		}
+		else if (axis == 'Z' || axis == 'z') {
+			axes_.push_back(2);
+		}
+	}
+}
+
+void MultiDim::operator()(Function* f) const {
+	DEBUG(errs() << "[+] CLASS MultiDim, FUNC operator():\n");
+	if (!f) {
+		DEBUG(errs() << "\t* got nullptr\n");
+		DEBUG(errs() << "[-] CLASS MultiDim, FUNC operator()\n");
+		return;
+	}
+	DEBUG(errs() << "\t* given function name " << f->getName() << '\n');
+	// every axis has its own offset argument, thus the axes are independent
+	for (short int axis : axes_) {
+		std::vector<CallInst*> worklist(getWorkList(axis, f));
+		for (auto* ci : worklist) {
+			addOffsetAndReplace(ci);
+		}
+	}
+	DEBUG(errs() << "[-] CLASS MultiDim, FUNC operator()\n");
+}
+
 #undef DEBUG_TYPE
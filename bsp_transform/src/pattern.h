@@ -84,6 +84,27 @@ class OneDim_X : public Pattern {
 	private:
 };
 
+class OneDim_Z : public Pattern {
+	public:
+		void operator()(Function* f) const;
+	private:
+};
+
+/*
+ *  DESCRIPTION - This pattern adds an offset to every split axis of a
+ *                block decomposition, e.g. the axes "XY" of a 2D
+ *                or "XYZ" of a 3D decomposition.
+ *
+ *  PARAMETER   - axes: the split axes, any of 'X', 'Y' and 'Z'
+ */
+class MultiDim : public Pattern {
+	public:
+		explicit MultiDim(const std::string& axes);
+		void operator()(Function* f) const;
+	private:
+		std::vector<short int> axes_;
+};
+
 // More patterns can be added here... //
 
 #endif
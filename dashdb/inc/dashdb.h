@@ -29,16 +29,82 @@
 
 	Reserved symbols: You can not use a '-', '=' or a key beginning with a
 	number.
+
+	Reading a database does not copy the single entries. The content is
+	copied once into one buffer, which is split into keys and values in
+	place. An index over the dashed key segments (a tree with sorted
+	children per node) answers the lookups. Thus reading values by
+	operator[] chains or by cursors does not allocate memory, except for
+	asString(), which returns a copy. Use asView() to avoid it.
 */
 #ifndef DASHDB_h
 #define DASHDB_h
 
 #include <unordered_map>
+#include <map>
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <cstddef>
 
 namespace dashdb {
 
+//! Non owning reference to characters inside a database buffer
+struct View {
+	const char* data = nullptr;
+	size_t size = 0;
+
+	View() = default;
+	View(const char* d, size_t s) : data(d), size(s) {}
+
+	bool empty() const { return size == 0; }
+	std::string str() const { return std::string(data, size); }
+	int compare(const char* other, size_t otherSize) const;
+	bool operator==(const char* other) const;
+	bool operator<(const View& other) const;
+};
+
+class Butler;
+
+/*! \brief Read only position inside a database.
+
+    In contrast to the Butler, a cursor can be stored and used as starting
+    point for further lookups, e.g. to resolve the prefix
+    "kernels-<k>-arguments-<a>" only once:
+
+	Butler::Cursor arg = b.root()["kernels"][k]["arguments"][a];
+	int size = arg["element size"].asInt();
+	View map = arg["isl read map"].asView();
+
+    Cursors ignore values, which were set with the Butler's assignment
+    operators, and must not outlive their Butler.
+*/
+class Cursor {
+	public:
+		Cursor operator[](const char* key) const;
+		Cursor operator[](int index) const;
+
+		//! False if the key does not exist in the database
+		bool isValid() const;
+		//! Get the length of current list (0 if no list)
+		int len() const;
+
+		View asView() const;
+		double asFloat() const;
+		long long asInt() const;
+		//! If the conversion fails, the function returns the alternative value
+		long long asInt(long long alternative) const;
+		bool asBool() const;
+		std::string asString() const;
+
+	private:
+		friend class Butler;
+		Cursor(const Butler* butler, uint32_t node) : butler_(butler), node_(node) {}
+
+		const Butler* butler_;
+		uint32_t node_;
+};
+
 /*! \brief He does everything for you.
 
     You can use the butler class to read a dashdb string:
@@ -52,10 +118,14 @@ namespace dashdb {
 
 	Butler child = b["kernels"][0]; // WON'T WORK
 	string name = child["name"]     // WON'T WORK
+
+	Use a Cursor (\sa root()) to keep a position inside the database.
 */
 class Butler {
 	public:
-		Butler() = default;
+		typedef dashdb::Cursor Cursor;
+
+		Butler();
 		//! Reads a database from a file
 		Butler(const char* filename);
 		//! Reads a database from a file
@@ -74,6 +144,9 @@ class Butler {
 		//! Prints each entry to one standard output line.
 		void dump() const;
 
+		//! Returns a cursor to the root of the read database
+		Cursor root() const;
+
 		//! Adds a current key
 		Butler& operator[](const char* key);
 		//! Adds a current key and introduces a list
@@ -89,6 +162,7 @@ class Butler {
 		Butler& operator=(const std::string& str);
 		Butler& operator=(const char* str);
 
+		View asView();
 		double asFloat();
 		long long asInt();
 		//! If the conversion fails, the function returns the alternative value
@@ -97,20 +171,58 @@ class Butler {
 		std::string asString();
 
 	private:
+		friend class dashdb::Cursor;
+
+		static const uint32_t npos = UINT32_MAX;
+		static const int maxDepth = 32;
+
+		//! One segment of a dashed key
+		struct Node {
+			View segment;
+			View value;
+			bool hasValue = false;
+			uint32_t firstChild = 0; ///< index into children_
+			uint32_t numChildren = 0;
+			int len = 0;             ///< highest numeric child + 1
+		};
+
+		//! One segment of the current key
+		struct Segment {
+			const char* key; ///< nullptr for list indices
+			int index;
+		};
+
+		void tokenize();
+		void clearKey();
+		uint32_t child(uint32_t node, const char* seg, size_t size) const;
+		uint32_t child(uint32_t node, int index) const;
+		std::string joinKey(int depth) const;
+		bool lookup(View* value);
+		void set(const std::string& value);
+
+		//! The database content, keys and values point into it
+		std::string content_;
+		//! (key, value) of every line in the order of the content
+		std::vector<std::pair<View, View>> entries_;
+		//! Index over the key segments, nodes_[0] is the root
+		std::vector<Node> nodes_;
+		//! Children of all nodes, sorted by segment per node
+		std::vector<uint32_t> children_;
+
 		//! Current key
-		std::string key_;
-		//! The original DB string
-		std::vector<std::string> lines_;
-		//! Underlaying container
-		std::unordered_map<std::string, std::string> db_;
-		//! To save a list length
+		uint32_t node_ = 0; ///< npos if the key is not in the index
+		Segment path_[maxDepth];
+		int depth_ = 0;
+
+		//! Values set with the assignment operators
+		std::map<std::string, std::string> db_;
+		//! To save a list length of assigned values
 		std::unordered_map<std::string, int> lengths_;
 };
 
 template<class Numeric_t>
 Butler& Butler::operator=(Numeric_t number) {
-	db_[key_] = std::to_string(number);
-	key_.clear();
+	set(std::to_string(number));
 	return *this;
 }
 
@@ -5,160 +5,495 @@
 #include <utility> // std::pair
 #include <sstream>
 #include <algorithm>
+#include <map>
+#include <cstring>
+#include <cstdlib> // strtoll, strtod
+#include <cerrno>
 
 namespace dashdb {
 
-Butler::Butler(const char* filename) {
-	std::fstream fs(filename, std::fstream::in);
-	std::string line;
+/*************
+ * VIEW      *
+ *************/
 
-	auto getKeyValue = [] (const std::string& line) {
-		int i = 0;
-		for (char c : line) {
-			++i;
-			if (c == '=') {
-				break;
-			}
-		}
-		return std::make_pair(line.substr(0, i - 1), line.substr(i));
-	};
+int View::compare(const char* other, size_t otherSize) const {
+	int res = memcmp(data, other, std::min(size, otherSize));
+	if (res != 0) {
+		return res;
+	}
+	return size < otherSize ? -1 : (size > otherSize ? 1 : 0);
+}
+
+bool View::operator==(const char* other) const {
+	return compare(other, strlen(other)) == 0;
+}
+
+bool View::operator<(const View& other) const {
+	return compare(other.data, other.size) < 0;
+}
+
+/*! \brief Checks if c = [0-9]
+*/
+bool isCipher(char c) {
+	// the numbers are sorted for their natural
+	// probability (Benford's law)
+	switch (c) {
+		case '1':
+			return true;
+		case '2':
+			return true;
+		case '3':
+			return true;
+		case '4':
+			return true;
+		case '5':
+			return true;
+		case '6':
+			return true;
+		case '7':
+			return true;
+		case '8':
+			return true;
+		case '9':
+			return true;
+		case '0':
+			return true;
+	}
+	return false;
+}
+
+// The conversion functions copy the value to the stack, as values must not
+// be null terminated. They return false if the value is no number.
 
-	while (std::getline(fs, line)) {
-		lines_.push_back(line);
-		auto keyVal = getKeyValue(line);
-		db_[keyVal.first] = keyVal.second;
+static bool toInt(View val, long long* res) {
+	char buf[64];
+	if (val.empty() || val.size >= sizeof(buf)) {
+		return false;
 	}
+	memcpy(buf, val.data, val.size);
+	buf[val.size] = '\0';
+	char* end;
+	errno = 0;
+	*res = strtoll(buf, &end, 10);
+	return end != buf && errno == 0;
+}
+
+static bool toFloat(View val, double* res) {
+	char buf[64];
+	if (val.empty() || val.size >= sizeof(buf)) {
+		return false;
+	}
+	memcpy(buf, val.data, val.size);
+	buf[val.size] = '\0';
+	char* end;
+	errno = 0;
+	*res = strtod(buf, &end);
+	return end != buf && errno == 0;
+}
+
+static bool toBool(View val) {
+	return val == "True" || val == "true" || val == "1";
+}
+
+//! Writes `index` to `buf` and returns the number of characters
+static size_t indexToChars(int index, char* buf) {
+	char tmp[16];
+	size_t n = 0;
+	do {
+		tmp[n++] = '0' + index % 10;
+		index /= 10;
+	} while (index > 0);
+	for (size_t i = 0; i < n; ++i) {
+		buf[i] = tmp[n - 1 - i];
+	}
+	return n;
+}
+
+/*************
+ * CURSOR    *
+ *************/
+
+Cursor Cursor::operator[](const char* key) const {
+	if (node_ == Butler::npos) {
+		return *this;
+	}
+	return Cursor(butler_, butler_->child(node_, key, strlen(key)));
+}
+
+Cursor Cursor::operator[](int index) const {
+	if (node_ == Butler::npos) {
+		return *this;
+	}
+	return Cursor(butler_, butler_->child(node_, index));
+}
+
+bool Cursor::isValid() const {
+	return node_ != Butler::npos;
+}
+
+int Cursor::len() const {
+	return isValid() ? butler_->nodes_[node_].len : 0;
+}
+
+//! Returns an empty view if there is no value
+View Cursor::asView() const {
+	if (isValid() && butler_->nodes_[node_].hasValue) {
+		return butler_->nodes_[node_].value;
+	}
+	return View();
+}
+
+double Cursor::asFloat() const {
+	double res;
+	if (!toFloat(asView(), &res)) {
+		throw std::invalid_argument(
+			"SPACE Dashdb, FUNC Cursor::asFloat(): "
+			"could not convert value '" + asView().str() + "' to a float."
+		);
+	}
+	return res;
+}
+
+long long Cursor::asInt() const {
+	long long res;
+	if (!toInt(asView(), &res)) {
+		throw std::invalid_argument(
+			"SPACE Dashdb, FUNC Cursor::asInt(): "
+			"could not convert value '" + asView().str() + "' to an int."
+		);
+	}
+	return res;
+}
+
+long long Cursor::asInt(long long alternative) const {
+	long long res;
+	return toInt(asView(), &res) ? res : alternative;
+}
+
+bool Cursor::asBool() const {
+	return toBool(asView());
+}
+
+std::string Cursor::asString() const {
+	return asView().str();
+}
+
+/*************
+ * BUTLER    *
+ *************/
+
+const uint32_t Butler::npos;
+const int Butler::maxDepth;
+
+Butler::Butler() {
+	nodes_.push_back(Node());
+}
+
+Butler::Butler(const char* filename) : Butler() {
+	std::fstream fs(filename, std::fstream::in);
+	std::stringstream ss;
+	ss << fs.rdbuf();
 	fs.close();
+	content_ = ss.str();
+	tokenize();
 }
 
 Butler::Butler(const std::string& filename) : Butler(filename.c_str()) {}
 
 void Butler::read(const char* content) {
+	content_ = content;
 	db_.clear();
 	lengths_.clear();
-	std::stringstream ss(content);
-	std::string line;
-
-	auto getKeyValue = [] (const std::string& line) {
-		int i = 0;
-		for (char c : line) {
-			++i;
-			if (c == '=') {
-				break;
+	clearKey();
+	tokenize();
+}
+
+/*! \brief Splits the content in place into keys and values and builds the
+           index over the key segments.
+
+    The line ends are replaced by null characters. If a key occurs more than
+    once, the last value wins.
+*/
+void Butler::tokenize() {
+	entries_.clear();
+	nodes_.assign(1, Node());
+	children_.clear();
+
+	char* pos = &content_[0];
+	char* end = pos + content_.size();
+	while (pos < end) {
+		char* lineEnd = std::find(pos, end, '\n');
+		if (lineEnd != end) {
+			*lineEnd = '\0';
+		}
+		if (lineEnd != pos) {
+			char* eq = std::find(pos, lineEnd, '=');
+			View key(pos, eq - pos);
+			View val;
+			if (eq != lineEnd) {
+				val = View(eq + 1, lineEnd - eq - 1);
 			}
+			entries_.push_back(std::make_pair(key, val));
 		}
-		return std::make_pair(line.substr(0, i - 1), line.substr(i));
+		pos = lineEnd + 1;
+	}
+
+	// BUILD THE INDEX
+	// Sort the keys segment wise, thus every subtree is a contiguous range
+	// of keys and the children of a node are created in sorted order. The
+	// sort is stable, as the last of equal keys must win.
+	auto keyLess = [] (const View& a, const View& b) {
+		size_t n = std::min(a.size, b.size);
+		for (size_t i = 0; i < n; ++i) {
+			// a dash ends a segment and sorts in front of everything
+			unsigned char ca = a.data[i] == '-' ? 0 : a.data[i];
+			unsigned char cb = b.data[i] == '-' ? 0 : b.data[i];
+			if (ca != cb) {
+				return ca < cb;
+			}
+		}
+		return a.size < b.size;
 	};
+	std::vector<uint32_t> order(entries_.size());
+	for (uint32_t i = 0; i < order.size(); ++i) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(),
+		[this, &keyLess] (uint32_t a, uint32_t b) {
+			return keyLess(entries_[a].first, entries_[b].first);
+		});
+
+	std::vector<uint32_t> parents(1, npos);
+	std::vector<uint32_t> path(1, 0); // nodes of the previous key, path[0] = root
+	for (uint32_t e : order) {
+		const View& key = entries_[e].first;
+		const char* seg = key.data;
+		const char* keyEnd = seg + key.size;
+		size_t depth = 0;
+		bool samePrefix = true;
+		while (true) {
+			const char* segEnd = std::find(seg, keyEnd, '-');
+			View segment(seg, segEnd - seg);
+			++depth;
+			if (samePrefix && depth < path.size() &&
+			    nodes_[path[depth]].segment.compare(segment.data, segment.size) == 0) {
+				// reuse the node of the previous key
+			}
+			else {
+				samePrefix = false;
+				path.resize(depth + 1);
+				path[depth] = nodes_.size();
+				nodes_.push_back(Node());
+				nodes_.back().segment = segment;
+				parents.push_back(path[depth - 1]);
+			}
+			if (segEnd == keyEnd) {
+				break;
+			}
+			seg = segEnd + 1;
+		}
+		path.resize(depth + 1);
+		nodes_[path[depth]].value = entries_[e].second;
+		nodes_[path[depth]].hasValue = true;
+	}
+
+	// FLATTEN THE CHILDREN AND CALCULATE THE LIST LENGTHS
+	// Nodes are created in sorted order, thus the children of every node
+	// stay sorted.
+	for (uint32_t node = 1; node < nodes_.size(); ++node) {
+		++nodes_[parents[node]].numChildren;
+	}
+	uint32_t first = 0;
+	for (auto& node : nodes_) {
+		node.firstChild = first;
+		first += node.numChildren;
+		node.numChildren = 0;
+	}
+	children_.resize(nodes_.size() - 1);
+	for (uint32_t node = 1; node < nodes_.size(); ++node) {
+		Node& parent = nodes_[parents[node]];
+		children_[parent.firstChild + parent.numChildren] = node;
+		++parent.numChildren;
+		const View& seg = nodes_[node].segment;
+		if (!seg.empty() && isCipher(seg.data[0])) {
+			long long index;
+			if (toInt(seg, &index) && parent.len <= index) {
+				parent.len = index + 1;
+			}
+		}
+	}
+}
+
+//! Returns the child of `node` with the dashed key or npos
+uint32_t Butler::child(uint32_t node, const char* seg, size_t size) const {
+	const char* keyEnd = seg + size;
+	while (node != npos) {
+		const char* segEnd = std::find(seg, keyEnd, '-');
+		const Node& n = nodes_[node];
+		// binary search in the sorted children
+		const uint32_t* first = children_.data() + n.firstChild;
+		const uint32_t* last = first + n.numChildren;
+		size_t segSize = segEnd - seg;
+		const uint32_t* it = std::lower_bound(first, last, seg,
+			[this, segSize] (uint32_t c, const char* s) {
+				return nodes_[c].segment.compare(s, segSize) < 0;
+			});
+		if (it == last || nodes_[*it].segment.compare(seg, segSize) != 0) {
+			return npos;
+		}
+		node = *it;
+		if (segEnd == keyEnd) {
+			break;
+		}
+		seg = segEnd + 1;
+	}
+	return node;
+}
+
+uint32_t Butler::child(uint32_t node, int index) const {
+	if (index < 0) {
+		return npos;
+	}
+	char buf[16];
+	return child(node, buf, indexToChars(index, buf));
+}
+
+Butler::Cursor Butler::root() const {
+	return Cursor(this, 0);
+}
+
+void Butler::clearKey() {
+	node_ = 0;
+	depth_ = 0;
+}
+
+//! Returns the first `depth` segments of the current key joined by dashes
+std::string Butler::joinKey(int depth) const {
+	std::string res;
+	for (int i = 0; i < depth; ++i) {
+		if (i > 0) {
+			res += "-";
+		}
+		if (path_[i].key != nullptr) {
+			res += path_[i].key;
+		}
+		else {
+			res += std::to_string(path_[i].index);
+		}
+	}
+	return res;
+}
+
+/*! \brief Searches the value of the current key.
+
+    Assigned values are preferred over read values. Only if there are
+    assigned values, the key string has to be built.
+*/
+bool Butler::lookup(View* value) {
+	if (!db_.empty()) {
+		auto it = db_.find(joinKey(depth_));
+		if (it != db_.end()) {
+			*value = View(it->second.data(), it->second.size());
+			return true;
+		}
+	}
+	if (node_ != npos && nodes_[node_].hasValue) {
+		*value = nodes_[node_].value;
+		return true;
+	}
+	*value = View();
+	return false;
+}
 
-	while (std::getline(ss, line)) {
-		lines_.push_back(line);
-		auto keyVal = getKeyValue(line);
-		db_[keyVal.first] = keyVal.second;
+//! Assigns `value` to the current key and resets it
+void Butler::set(const std::string& value) {
+	for (int i = 0; i < depth_; ++i) {
+		if (path_[i].key == nullptr) {
+			int& len = lengths_[joinKey(i)];
+			if (len <= path_[i].index) {
+				len = path_[i].index + 1;
+			}
+		}
 	}
+	db_[joinKey(depth_)] = value;
+	clearKey();
 }
 
 void Butler::write(const char* filename) const {
-	std::fstream fs(filename, std::fstream::out | std::fstream::trunc);
-	std::vector<std::string> keys;
+	std::map<std::string, std::string> all;
+	for (const auto& entry : entries_) {
+		all[entry.first.str()] = entry.second.str();
+	}
 	for (const auto& el : db_) {
-		keys.push_back(el.first);
+		all[el.first] = el.second;
 	}
-	std::sort(keys.begin(), keys.end());
-	for (const std::string& key : keys) {
-		fs << key << "=" << db_.at(key) << std::endl;
+	std::fstream fs(filename, std::fstream::out | std::fstream::trunc);
+	for (const auto& el : all) {
+		fs << el.first << "=" << el.second << std::endl;
 	}
 	fs.close();
 }
 
 void Butler::dump() const {
+	std::map<std::string, std::string> all;
+	for (const auto& entry : entries_) {
+		all[entry.first.str()] = entry.second.str();
+	}
 	for (const auto& el : db_) {
+		all[el.first] = el.second;
+	}
+	for (const auto& el : all) {
 		std::cout << el.first << "=" << el.second << std::endl;
 	}
 }
 
 Butler& Butler::operator[](const char * key) {
-	if (!key_.empty()) {
-		key_ += "-";
+	if (depth_ == maxDepth) {
+		throw std::length_error("SPACE Dashdb, FUNC Butler::operator[](): "
+		                        "key has too many segments");
+	}
+	path_[depth_].key = key;
+	path_[depth_].index = 0;
+	++depth_;
+	if (node_ != npos) {
+		node_ = child(node_, key, strlen(key));
 	}
-	key_ += key;
 	return *this;
 }
 
 Butler& Butler::operator[](int index) {
-	if (lengths_[key_] <= index) {
-		lengths_[key_] = index + 1;
+	if (depth_ == maxDepth) {
+		throw std::length_error("SPACE Dashdb, FUNC Butler::operator[](): "
+		                        "key has too many segments");
 	}
-	if (!key_.empty()) {
-		key_ += "-";
+	path_[depth_].key = nullptr;
+	path_[depth_].index = index;
+	++depth_;
+	if (node_ != npos) {
+		node_ = child(node_, index);
 	}
-	key_ += std::to_string(index);
 	return *this;
 }
 
-/*! \brief Checks if c = [0-9]
-*/
-bool isCipher(char c) {
-	// the numbers are sorted for their natural
-	// probability (Benford's law)
-	switch (c) {
-		case '1':
-			return true;
-		case '2':
-			return true;
-		case '3':
-			return true;
-		case '4':
-			return true;
-		case '5':
-			return true;
-		case '6':
-			return true;
-		case '7':
-			return true;
-		case '8':
-			return true;
-		case '9':
-			return true;
-		case '0':
-			return true;
-	}
-	return false;
-}
-
 int Butler::len() {
-	int res = lengths_[key_];
-	// if len is unset, we must check for it in the database string
-	if (res == 0) {
-		for (const auto& line : lines_) {
-			int ksize = std::string(key_).size();
-			if (line.compare(0, ksize, key_) == 0) {
-				if (isCipher(line[ksize + 1])) {
-					int num_end = 1;
-					while (line[ksize + num_end + 1] != '-') {
-						++num_end;
-					}
-					int index = std::stoi(line.substr(ksize + 1, num_end));
-					if (res <= index) {
-						res = index + 1;
-						lengths_[key_] = res;
-					}
-				}
-			}
+	int res = node_ != npos ? nodes_[node_].len : 0;
+	if (!lengths_.empty()) {
+		auto it = lengths_.find(joinKey(depth_));
+		if (it != lengths_.end() && res < it->second) {
+			res = it->second;
 		}
 	}
-	key_.clear();
+	clearKey();
 	return res;
 }
 
 Butler& Butler::operator=(bool b) {
-	db_[key_] = std::to_string(b);
-	key_.clear();
+	set(std::to_string(b));
 	return *this;
 }
 
 Butler& Butler::operator=(const std::string& str) {
-	db_[key_] = str;
-	key_.clear();
+	set(str);
 	return *this;
 }
 
@@ -166,59 +501,80 @@ Butler& Butler::operator=(const char* str) {
 	return this->operator=(std::string(str));
 }
 
+//! The view is valid until the next assignment or read()
+View Butler::asView() {
+	View res;
+	lookup(&res);
+	clearKey();
+	return res;
+}
+
 double Butler::asFloat() {
-	std::string res = db_[key_];
-	key_.clear();
-	return std::stod(res);
+	View val;
+	lookup(&val);
+	double res;
+	if (!toFloat(val, &res)) {
+		std::string key = joinKey(depth_);
+		clearKey();
+		throw std::invalid_argument(
+			"SPACE Dashdb, FUNC Butler::asFloat(): "
+			"could not convert value '" + val.str() + "' belonging "
+			"to key '" + key + "' to a float."
+		);
+	}
+	clearKey();
+	return res;
 }
 
 long long Butler::asInt() {
-	std::string res = db_[key_];
+	View val;
+	lookup(&val);
 	long long res_num;
-	if (res.empty()) {
+	if (val.empty()) {
+		std::string key = joinKey(depth_);
+		clearKey();
 		throw std::invalid_argument(
 			"SPACE Dashdb, FUNC Butler::asInt(): "
 			"could not convert empty value belonging "
-			"to key '" + std::string(key_) + "' to an int."
+			"to key '" + key + "' to an int."
 		);
 	}
-	try {
-		res_num = stoll(res);
-	}
-	catch(...) {
+	if (!toInt(val, &res_num)) {
+		std::string key = joinKey(depth_);
+		clearKey();
 		throw std::invalid_argument(
 			"SPACE Dashdb, FUNC Butler::asInt(): "
-			"could not convert value '" + res + "' belonging "
-			"to key '" + std::string(key_) + "' to an int."
+			"could not convert value '" + val.str() + "' belonging "
+			"to key '" + key + "' to an int."
 		);
 	}
-	key_.clear();
+	clearKey();
 	return res_num;
 }
 
 long long Butler::asInt(long long alternative) {
-	std::string res = db_[key_];
+	View val;
+	lookup(&val);
 	long long res_num;
-	try {
-		res_num = stoll(res);
-	}
-	catch(...) {
+	if (!toInt(val, &res_num)) {
 		res_num = alternative;
 	}
-	key_.clear();
+	clearKey();
 	return res_num;
 }
 
 bool Butler::asBool() {
-	std::string res = db_[key_];
-	key_.clear();
-	return res == "True" || res == "true" || res == "1";
+	View val;
+	lookup(&val);
+	clearKey();
+	return toBool(val);
 }
 
 std::string Butler::asString() {
-	std::string res = db_[key_];
-	key_.clear();
-	return res;
+	View val;
+	lookup(&val);
+	clearKey();
+	return val.str();
 }
 
 } // namespace end
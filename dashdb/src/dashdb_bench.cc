@@ -0,0 +1,164 @@
+/*! \brief Benchmark of the dashdb reader.
+
+    Generates a database with 1000 kernels, which looks like the output of
+    Mekong's kernel analysis, and measures reading it and querying every
+    entry the runtime needs (\sa Mekong::bsp_KernelInfo::createKInfos).
+    The number of heap allocations is counted by replacing operator new.
+*/
+#include "dashdb.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+using namespace dashdb;
+
+using Clock = chrono::high_resolution_clock;
+using Duration = chrono::duration<double>;
+
+static size_t numAllocs = 0;
+
+void* operator new(size_t size) {
+	++numAllocs;
+	void* ptr = malloc(size);
+	if (ptr == nullptr) {
+		throw bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+static string createDatabase(int numKernels, int numArgs) {
+	string db;
+	const string map = "[size_x, size_y, size_z] -> { Stmt_entry[i0, i1, i2] "
+	                   "-> MemRef_a[i0] : 0 <= i0 < size_x and 0 <= i1 < size_y "
+	                   "and 0 <= i2 < size_z }";
+	for (int k = 0; k < numKernels; ++k) {
+		string kernel = "kernels-" + to_string(k) + "-";
+		db += kernel + "name=kernel_" + to_string(k) + "\n";
+		db += kernel + "partitioning=y\n";
+		for (int a = 0; a < numArgs; ++a) {
+			string arg = kernel + "arguments-" + to_string(a) + "-";
+			db += arg + "element size=32\n";
+			db += arg + "fundamental type=f\n";
+			db += arg + "isl read map=" + map + "\n";
+			db += arg + "isl read params-0=size_x\n";
+			db += arg + "isl read params-1=size_y\n";
+			db += arg + "isl read params-2=size_z\n";
+			db += arg + "isl write map=" + map + "\n";
+			db += arg + "isl write params-0=size_x\n";
+			db += arg + "isl write params-1=size_y\n";
+			db += arg + "isl write params-2=size_z\n";
+			db += arg + "name=a" + to_string(a) + "\n";
+			db += arg + "num dimensions=1\n";
+			db += arg + "pointer level=1\n";
+			db += arg + "size=0\n";
+			db += arg + "type name=float*\n";
+		}
+	}
+	return db;
+}
+
+//! Queries like createKInfos, but without creating strings
+static size_t queryButler(Butler& b) {
+	size_t sum = 0;
+	for (int k = 0; k < b["kernels"].len(); ++k) {
+		sum += b["kernels"][k]["name"].asView().size;
+		sum += b["kernels"][k]["partitioning"].asView().size;
+		for (int a = 0; a < b["kernels"][k]["arguments"].len(); ++a) {
+			sum += b["kernels"][k]["arguments"][a]["type name"].asView().size;
+			sum += b["kernels"][k]["arguments"][a]["pointer level"].asInt();
+			sum += b["kernels"][k]["arguments"][a]["fundamental type"].asView().size;
+			sum += b["kernels"][k]["arguments"][a]["size"].asInt();
+			sum += b["kernels"][k]["arguments"][a]["element size"].asInt();
+			sum += b["kernels"][k]["arguments"][a]["isl write map"].asView().size;
+			sum += b["kernels"][k]["arguments"][a]["isl read map"].asView().size;
+			sum += b["kernels"][k]["arguments"][a]["num dimensions"].asInt(0);
+			for (int p = 0; p < b["kernels"][k]["arguments"][a]["isl read params"].len(); ++p) {
+				sum += b["kernels"][k]["arguments"][a]["isl read params"][p].asView().size;
+			}
+			for (int p = 0; p < b["kernels"][k]["arguments"][a]["isl write params"].len(); ++p) {
+				sum += b["kernels"][k]["arguments"][a]["isl write params"][p].asView().size;
+			}
+		}
+	}
+	return sum;
+}
+
+//! Same queries, but the kernel and argument prefixes are resolved once
+static size_t queryCursor(const Butler& b) {
+	size_t sum = 0;
+	Cursor kernels = b.root()["kernels"];
+	for (int k = 0; k < kernels.len(); ++k) {
+		Cursor kernel = kernels[k];
+		sum += kernel["name"].asView().size;
+		sum += kernel["partitioning"].asView().size;
+		Cursor args = kernel["arguments"];
+		for (int a = 0; a < args.len(); ++a) {
+			Cursor arg = args[a];
+			sum += arg["type name"].asView().size;
+			sum += arg["pointer level"].asInt();
+			sum += arg["fundamental type"].asView().size;
+			sum += arg["size"].asInt();
+			sum += arg["element size"].asInt();
+			sum += arg["isl write map"].asView().size;
+			sum += arg["isl read map"].asView().size;
+			sum += arg["num dimensions"].asInt(0);
+			Cursor readParams = arg["isl read params"];
+			for (int p = 0; p < readParams.len(); ++p) {
+				sum += readParams[p].asView().size;
+			}
+			Cursor writeParams = arg["isl write params"];
+			for (int p = 0; p < writeParams.len(); ++p) {
+				sum += writeParams[p].asView().size;
+			}
+		}
+	}
+	return sum;
+}
+
+int main(int argc, char** argv) {
+	int numKernels = argc > 1 ? atoi(argv[1]) : 1000;
+	int numArgs = argc > 2 ? atoi(argv[2]) : 8;
+	string db = createDatabase(numKernels, numArgs);
+
+	cout << "# DashDB Benchmark" << endl;
+	cout << endl;
+	cout << "  - kernels = " << numKernels << ", arguments per kernel = "
+	     << numArgs << ", database size = " << db.size() / 1e6 << " MB" << endl;
+
+	Butler b;
+	size_t allocs = numAllocs;
+	auto timestamp = Clock::now();
+	b.read(db.c_str());
+	Duration readTime = Clock::now() - timestamp;
+	cout << "  - read: " << readTime.count() << " s, "
+	     << numAllocs - allocs << " allocations" << endl;
+
+	allocs = numAllocs;
+	timestamp = Clock::now();
+	size_t sumButler = queryButler(b);
+	Duration butlerTime = Clock::now() - timestamp;
+	cout << "  - query with Butler::operator[]: " << butlerTime.count() << " s, "
+	     << numAllocs - allocs << " allocations" << endl;
+
+	allocs = numAllocs;
+	timestamp = Clock::now();
+	size_t sumCursor = queryCursor(b);
+	Duration cursorTime = Clock::now() - timestamp;
+	cout << "  - query with cursors: " << cursorTime.count() << " s, "
+	     << numAllocs - allocs << " allocations" << endl;
+
+	if (sumButler != sumCursor) {
+		cout << "[FAILED] the queries returned different results" << endl;
+		return 1;
+	}
+	return 0;
+}
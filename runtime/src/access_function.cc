@@ -1,6 +1,7 @@
 #include "argument.h"
 #include "access_function.h"
-#include "uparse.h"
+#include "isl_context.h"
+#include "param_expression.h"
 
 #include <string>
 #include <vector>
@@ -9,6 +10,7 @@
 #include <stdexcept>
 #include <tuple>
 #include <cstdint>
+#include <atomic>
 
 #include <isl/ctx.h>
 #include <isl/map.h>
@@ -21,6 +23,19 @@ namespace Mekong {
 
 using namespace std;
 
+// Source of the AccFunc ids
+static atomic<uint64_t> MEKONG_nextAccFuncId(0);
+
+//! Compiles the parameter strings of an isl map
+static vector<ParamExpr> compileParams(const vector<shared_ptr<const string>>& params) {
+	vector<ParamExpr> res;
+	res.reserve(params.size());
+	for (const auto& param : params) {
+		res.push_back(ParamExpr(*param));
+	}
+	return res;
+}
+
 /*! \param islReadParams list of strings to calculate the space parameters of
            the ISL read map. E.g. ['arg1', '30+40', 'arg3 + 10', 'arg4 * 3']
            can belong to [A,B,C,D] -> { [x,y,z,i] -> [A*x,B*y,C*z,D*i] }.
@@ -37,7 +52,10 @@ AccFunc::AccFunc(const vector<shared_ptr<const string>>& islReadParams,
 		  islRead_(islRead),
 		  islWriteParams_(islWriteParams),
 		  islWrite_(islWrite),
-		  argNr_(argNr) {}
+		  argNr_(argNr),
+		  readExprs_(compileParams(islReadParams)),
+		  writeExprs_(compileParams(islWriteParams)),
+		  id_(MEKONG_nextAccFuncId++) {}
 
 bool AccFunc::isAffine() const {
 	throw runtime_error("SPACE Mekong, CLASS AccFunc, FUNC isAffine():\n"
@@ -129,111 +147,21 @@ vector<size_t> AccFunc::getWriteAcc(const Array3& threadId,
 	return getAcc(threadId, args, gridSize, blockSize, false);
 }
 
-/*! \todo use a self written parser for positive integer types.
+/*! The parameters are compiled at construction, thus this function is
+    reentrant and does not allocate memory (\sa ParamExpr).
 */
 intmax_t AccFunc::getParam(unsigned short paramId,
                 const vector<shared_ptr<const KernelArg>>* args,
                 const Array3* gridSize, const Array3* blockSize,
                 bool is_read) const {
-	
-	auto throwError = [] (const string& msg) {
-		throw runtime_error("SPACE Mekong, CLASS AccFunc, FUNC getParam():\n" + msg);
-	};
-
-	const vector<shared_ptr<const string>>* islParams;
-	if (is_read) { // if true parse the read params
-		islParams = &islReadParams_;
-	}
-	else {
-		islParams = &islWriteParams_;
-	}
-
-	if (paramId >= islParams->size()) {
-		throwError(string("paramId = ") + to_string(paramId) + string(" exceeds the limits of\n") + 
-		           string("the given parameter descriptions (max = ") + to_string(islParams->size()) +
-		           string(")\n"));
-	}
-
-	// replaces occurrences of 'key' in 'str' with 'subst'
-	auto replace = [] (string& str, const string& key, const string& subst) {
-		size_t pos;
-		while (str.find(key) != string::npos) {
-			pos = str.find(key);
-			str.replace(pos, key.size(), subst);
-		}
-		return str;
-	};
-
-	auto foundSubStr = [] (const string& substr, const string& str) {
-		if (str.find(substr) != string::npos) {
-			return true;
-		}
-		else {
-			return false;
-		}
-	};
-
-	// PREPARE PARSER INPUT
-	// 1. Replace the arg<i> placeholder
-	//    with the value from the kernel argument
-	// 2. Replace the size_[x|y|z] placeholeder with
-	//    the value from the kernel launch grid size
-
-	string prsInput = *(*islParams)[paramId];
-	if (foundSubStr("arg", prsInput) && !args) {
-		throwError("Parameter depends on kernel arguments, but I did not get it!\n");
+	const vector<ParamExpr>& exprs = is_read ? readExprs_ : writeExprs_;
+	if (paramId >= exprs.size()) {
+		throw runtime_error("SPACE Mekong, CLASS AccFunc, FUNC getParam():\n"
+		                    "paramId = " + to_string(paramId) + " exceeds the "
+		                    "limits of\nthe given parameter descriptions (max = "
+		                    + to_string(exprs.size()) + ")\n");
 	}
-	if (foundSubStr("size_", prsInput) && (!gridSize || !blockSize)) {
-		throwError("Parameter depends on kernel launch size, but I did not get it!\n");
-	}
-
-	// 1.
-	for (unsigned short id = 0; id < args->size(); ++id) {
-		auto arg = args->operator[](id);
-		// if the argument is an double, int, float convert it correctly
-		if (arg->getType()->isFundType() && arg->getType()->getPtrlvl() == 0) {
-			string key = "arg" + to_string(id);
-			string subst;
-			// get the correct value of the argument
-			if (arg->getType()->isFloat()) {
-				subst = to_string(arg->asFloat());
-			}
-			else if (arg->getType()->isDouble()) {
-				subst = to_string(arg->asDouble()); 
-			}
-			else if (arg->getType()->isInt()) {
-				subst = to_string(arg->asInt());
-			}
-			replace(prsInput, key, subst);
-		}
-	}
-	// 2.
-	const string xKey = "size_x";
-	if (foundSubStr(xKey, prsInput)) {
-		size_t size_x = (*gridSize)[0] * (*blockSize)[0];
-		replace(prsInput, xKey, to_string(size_x));
-	}
-	const string yKey = "size_y";
-	if (foundSubStr(yKey, prsInput)) {
-		size_t size_y = (*gridSize)[1] * (*blockSize)[1];
-		replace(prsInput, yKey, to_string(size_y));
-	}
-	const string zKey = "size_z";
-	if (foundSubStr(zKey, prsInput)) {
-		size_t size_z = (*gridSize)[2] * (*blockSize)[2];
-		replace(prsInput, zKey, to_string(size_z));
-	}
-
-	uintmax_t parsRes;
-	try {
-		parsRes = Uparse::parse(prsInput.c_str());
-	}
-	catch(...) {
-		throwError("Could not parse isl read/write parameter. Maybe "
-		           "you introduced a new keyword and I do not know how "
-		           "to handle that.");
-	}
-	return parsRes;
+	return exprs[paramId].eval(args, gridSize, blockSize);
 }
 
 __isl_give isl_union_map* AccFunc::getIslMap(isl_ctx* ctx,
@@ -256,19 +184,49 @@ __isl_give isl_union_map* AccFunc::getIslMap(isl_ctx* ctx,
 	}
 
 	// ISL INITIALIZATION
-	isl_union_map* umap = isl_union_map_read_from_str(ctx, islStr->c_str());
+	// Parsing the map string is much more expensive than fixing the
+	// parameters, thus the map is parsed only once per thread and kept in the
+	// thread's IslContext. Other contexts get a freshly parsed map.
+	isl_union_map* umap;
+	isl_set* param_set;
+	int numParams;
+	IslContext& local = IslContext::get();
+	if (ctx == local.getCtx()) {
+		uint64_t key = (id_ << 1) | (is_read ? 1 : 0);
+		const IslContext::Template* t = local.getTemplate(key);
+		if (t == nullptr) {
+			t = local.addTemplate(key, isl_union_map_read_from_str(ctx, islStr->c_str()));
+		}
+		umap = isl_union_map_copy(t->map);
+		param_set = isl_set_copy(t->params);
+		numParams = t->numParams;
+	}
+	else {
+		umap = isl_union_map_read_from_str(ctx, islStr->c_str());
+		param_set = isl_union_map_params(isl_union_map_copy(umap));
+		numParams = isl_set_dim(param_set, isl_dim_param);
+	}
 	vector<intmax_t> params;
-	isl_set* param_set = isl_union_map_params(isl_union_map_copy(umap));
-	
+
 	// GET THE ISL MAP PARAMETER VALUES
-	for (int i = 0; i < isl_set_dim(param_set, isl_dim_param); ++i) {
-		params.push_back(getParam(i, args, gridSize, blockSize, is_read));
+	// the context outlives this call, thus we must not leak the maps
+	try {
+		for (int i = 0; i < numParams; ++i) {
+			params.push_back(getParam(i, args, gridSize, blockSize, is_read));
+		}
+	}
+	catch (...) {
+		isl_union_map_free(umap);
+		isl_set_free(param_set);
+		throw;
 	}
 
 	// CHECK THE VALUES FOR OVERFLOW
 	for (intmax_t param : params) {
 		if (param > numeric_limits<int>::max() ||
 			param < numeric_limits<int>::lowest()) {
+			isl_union_map_free(umap);
+			isl_set_free(param_set);
 			throw overflow_error("wanted parameter cannot be handled"
 								 "by isl. Maybe you should choose smaller"
 								 "arguments for the kernel");
@@ -299,9 +257,11 @@ size_t AccFunc::flatPoint (vector<size_t>& point, vector<size_t>& dimSizes) {
 		for (size_t dimSize : dimSizes) {
 			mul *= dimSize;
 		}
+		// point.back() is the outermost remaining dimension, whose stride
+		// is the product of the sizes of all inner dimensions
 		size_t add = mul * point.back();
 		point.pop_back();
-		dimSizes.pop_back();
+		dimSizes.erase(dimSizes.begin());
 		return add + flatPoint(point, dimSizes);
 	}
 }
@@ -328,7 +288,7 @@ vector<size_t> AccFunc::getAcc(const Array3& threadId,
 		return res;
 	}
 
-	isl_ctx* ctx = isl_ctx_alloc();
+	isl_ctx* ctx = IslContext::get().getCtx();
 
 	// SET THE THREAD ID IN THE ISL MAP
 	if (threadId[0] > numeric_limits<int>::max() ||
@@ -344,6 +304,7 @@ vector<size_t> AccFunc::getAcc(const Array3& threadId,
 
 	// now we collect the ranges of the accesses in variable 'ranges'
 	isl_union_map_foreach_map(umap, fixAndGetRange, &threadId_and_ResVector);
+	isl_union_map_free(umap);
 
 	if (ranges.empty()) {
 		return res;
@@ -370,8 +331,6 @@ vector<size_t> AccFunc::getAcc(const Array3& threadId,
 	}
 
 	isl_set_free(range);
-	isl_union_map_free(umap);
-	isl_ctx_free(ctx);
 	return res;
 }
 
@@ -393,10 +352,6 @@ isl_stat AccFunc::addPoint(__isl_take isl_point* point, void* points) {
 	vector<size_t> coords;
 	isl_space* space = isl_point_get_space(point);
 	unsigned numDim = isl_space_dim(space, isl_dim_out);
-	if (numDim > 2) {
-		throw runtime_error("SPACE Mekong, CLASS AccFunc, FUNC addPoint():\n"
-		                    "Polly array with dim > 2 are not supported");
-	}
 	// here we have to add in reverse order because of polly's internal array
 	// representation. E.g. an access arr[x + N * y] leads to an internal
 	// representation of arr[y, x] with dimSize(0) = inf and dimSize(1) = N
@@ -13,6 +13,8 @@
 #include <isl/union_map.h>
 #include <isl/point.h>
 
+#include "param_expression.h"
+
 namespace Mekong {
 
 class KernelArg;
@@ -50,6 +52,7 @@ class AccFunc {
 		                    const Array3* gridSize = nullptr, const Array3* blockSize = nullptr) const;
 
 		//! returns the isl read acces map with fixed parameters
+		//! the map is parsed once per thread if ctx is IslContext::get().getCtx()
 		__isl_give isl_union_map* getReadIslMap(isl_ctx* ctx,
 		                    const vector<shared_ptr<const KernelArg>>* args = nullptr,
 		                    const Array3* gridSize = nullptr, const Array3* blockSize = nullptr) const;
@@ -102,6 +105,11 @@ class AccFunc {
 		const vector<shared_ptr<const string>> islWriteParams_;
 		const string islWrite_;
 		const int argNr_; ///< arg number this access function belongs to
+		//! the parameter strings compiled once at construction
+		const vector<ParamExpr> readExprs_;
+		const vector<ParamExpr> writeExprs_;
+		//! unique id, which identifies the parsed maps in the IslContexts
+		const uint64_t id_;
 };
 
 }; // namespace end
@@ -5,6 +5,7 @@
 #include <vector>
 #include <stdexcept>
 #include <string>
+#include <utility> // std::move
 
 namespace Mekong {
 
@@ -30,7 +31,7 @@ vector<MEmodule>& AliasHandle::operator[](const MEmodule& mod) {
 //! We have to load a kernel function into every module for every GPU,
 //! although it is always logically the same function.
 vector<MEfunction>& AliasHandle::operator[](const MEfunction& func) {
-	return funcMap_[func];
+	return funcMap_[func].funcs;
 }
 
 //! Return linked device pointers
@@ -45,7 +46,34 @@ vector<MEdeviceptr>& AliasHandle::operator[](const MEdeviceptr& ptr) {
      \sa wrapLaunchKernel The kernel launch objects are created here.
 */
 string& AliasHandle::atName(const MEfunction& func) {
-	return nameMap_[func];
+	return funcMap_[func].name;
+}
+
+/*! \brief Returns the record of a registered kernel function.
+
+    References stay valid if other functions are registered, thus callers
+    may keep a pointer to the record.
+    \sa wrapModuleGetFunction fills the record.
+*/
+AliasHandle::FuncRecord& AliasHandle::getFuncRecord(const MEfunction& func) {
+	return funcMap_[func];
+}
+
+/*! \brief Returns the registered buffer, which contains `ptr`.
+
+    The user may pass a pointer into the middle of an allocation (e.g.
+    `devPtr + offset`) to a memory copy. We return the pointer of the
+    allocation, which is the greatest registered pointer not above `ptr`.
+*/
+MEdeviceptr AliasHandle::getBasePtr(MEdeviceptr ptr) const {
+	auto it = ptrMap_.upper_bound(ptr);
+	if (it == ptrMap_.begin()) {
+		throw invalid_argument("SPACE Mekong, CLASS AliasHandle, "
+		                       "FUNC getBasePtr(): device pointer does not "
+		                       "belong to any allocated buffer");
+	}
+	--it;
+	return it->first;
 }
 
 //! In case of a cuMemFree, we want to delete the stored information
@@ -93,9 +121,35 @@ const AliasHandle::ptrMap_t& AliasHandle::getDevPtrMap() const {
 	return ptrMap_;
 }
 
-//! Returns a map representing the linkage between the device functions.
+//! Returns a map with the records of all registered kernel functions.
 const AliasHandle::funcMap_t& AliasHandle::getFuncMap() const {
 	return funcMap_;
 }
 
+//! Saves the limits of the registered devices, in the order of getDevs()
+void AliasHandle::setDevLimits(vector<MEdevLimits>&& limits) {
+	devLimits_ = move(limits);
+}
+
+//! Returns the device limits, empty if they were not queried
+const vector<MEdevLimits>& AliasHandle::getDevLimits() const {
+	return devLimits_;
+}
+
+/*! \brief Saves the relative speed of the registered devices, in the order
+           of getDevs().
+
+    Kernel launches created afterwards split their grid proportional to
+    the weights.
+    \sa Partition::createPartitions
+*/
+void AliasHandle::setDevWeights(vector<double>&& weights) {
+	devWeights_ = move(weights);
+}
+
+//! Returns the device weights, empty if the grid is split evenly
+const vector<double>& AliasHandle::getDevWeights() const {
+	return devWeights_;
+}
+
 };
@@ -2,7 +2,9 @@
 #define MEKONG_ALIAS_HANDLER_H
 
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <memory>
 #include <stdexcept>
 #include <string>
 
@@ -12,6 +14,8 @@ namespace Mekong {
 
 using namespace std;
 
+class bsp_KernelInfo;
+
 //! Handles the mapping between single- and multiple-GPU pointers
 
 //! In the Mekong context we have to promote single GPU pointers
@@ -23,10 +27,29 @@ using namespace std;
 //! contexts, modules, functions, etc.
 class AliasHandle {
 	public:
+		//! Limits of a kernel function on one device
+		struct FuncLimits {
+			size_t maxThreadsPerBlock; ///< depends on the register usage
+			size_t staticShMem;        ///< shared memory in Bytes
+		};
+
+		/*! \brief Everything the runtime needs to know about a kernel function.
+
+		    Filled once by wrapModuleGetFunction, thus a kernel launch only
+		    looks up the function handle once instead of searching the
+		    kernel analysis by name.
+		*/
+		struct FuncRecord {
+			string name;                           ///< name of the kernel
+			vector<MEfunction> funcs;              ///< the function on every device
+			shared_ptr<const bsp_KernelInfo> info; ///< analysis, nullptr if there is none
+			vector<FuncLimits> limits;             ///< limits on every device, may be empty
+		};
+
 		typedef map<MEdevice, vector<MEdevice>> devMap_t;
 		typedef map<MEcontext, vector<MEcontext>> ctxMap_t;
 		typedef map<MEmodule, vector<MEmodule>> modMap_t;
-		typedef map<MEfunction, vector<MEfunction>> funcMap_t;
+		typedef unordered_map<MEfunction, FuncRecord> funcMap_t;
 		typedef map<MEdeviceptr, vector<MEdeviceptr>> ptrMap_t;
 
 		vector<MEdevice>& operator[](const MEdevice& dev);
@@ -39,11 +62,17 @@ class AliasHandle {
 		void erase(const MEdeviceptr& ptr);
 	
 		string& atName(const MEfunction& func);
+		FuncRecord& getFuncRecord(const MEfunction& func);
 		const vector<MEcontext>& getCtx() const;
 		unsigned short getNumDev() const;
 		const vector<MEdevice>& getDevs() const;
 		const ptrMap_t& getDevPtrMap() const;
+		MEdeviceptr getBasePtr(MEdeviceptr ptr) const;
 		const funcMap_t& getFuncMap() const;
+		void setDevLimits(vector<MEdevLimits>&& limits);
+		const vector<MEdevLimits>& getDevLimits() const;
+		void setDevWeights(vector<double>&& weights);
+		const vector<double>& getDevWeights() const;
 
 	private:
 
@@ -52,7 +81,8 @@ class AliasHandle {
 		modMap_t modMap_;                     ///< module mapping
 		funcMap_t funcMap_;                   ///< kernel function mapping
 		ptrMap_t ptrMap_;                     ///< device buffer mapping
-		map<MEfunction, string> nameMap_;     ///< kernel function to name
+		vector<MEdevLimits> devLimits_;       ///< limits of every device
+		vector<double> devWeights_;           ///< relative speed of every device
 };
 
 };
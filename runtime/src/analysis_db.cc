@@ -0,0 +1,242 @@
+#include "analysis_db.h"
+#include "analysis_db_format.h"
+#include "argument_type.h"
+#include "partitioning.h"
+#include "access_function.h"
+#include "kernel_info.h"
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <fcntl.h>    // open
+#include <unistd.h>   // close
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Maps the database file into memory and checks its header.
+
+    Throws a runtime_error if the file can not be read, is no analysis
+    database or was written with another format version.
+*/
+AnalysisDB::AnalysisDB(const char* filename) : filename_(filename) {
+	auto throwError = [this] (const string& msg) {
+		throw runtime_error("SPACE Mekong, CLASS AnalysisDB, FUNC AnalysisDB(): "
+		                    + msg + " (" + filename_ + ")");
+	};
+
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		throwError("could not open the analysis database");
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(AnalysisDBFormat::Header)) {
+		close(fd);
+		throwError("the file is too small to be an analysis database");
+	}
+	size_ = st.st_size;
+	data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping stays valid
+	if (data_ == MAP_FAILED) {
+		data_ = nullptr;
+		throwError("could not map the analysis database");
+	}
+
+	const char* pos = (const char*) data_;
+	header_ = (const AnalysisDBFormat::Header*) pos;
+	if (memcmp(header_->magic, AnalysisDBFormat::magic,
+	           sizeof(AnalysisDBFormat::magic)) != 0) {
+		munmap(data_, size_);
+		throwError("the file is no analysis database");
+	}
+	if (header_->version != AnalysisDBFormat::version) {
+		munmap(data_, size_);
+		throwError("the analysis database has version "
+		           + to_string(header_->version) + ", but I need version "
+		           + to_string(AnalysisDBFormat::version));
+	}
+	size_t expected = sizeof(AnalysisDBFormat::Header)
+	                + (size_t) header_->numKernels * sizeof(AnalysisDBFormat::Kernel)
+	                + (size_t) header_->numArgs * sizeof(AnalysisDBFormat::Arg)
+	                + (size_t) header_->numStrRefs * sizeof(StrRef)
+	                + header_->stringsSize;
+	if (expected != size_) {
+		munmap(data_, size_);
+		throwError("the size of the analysis database does not match its "
+		           "header");
+	}
+
+	pos += sizeof(AnalysisDBFormat::Header);
+	kernels_ = (const AnalysisDBFormat::Kernel*) pos;
+	pos += header_->numKernels * sizeof(AnalysisDBFormat::Kernel);
+	args_ = (const AnalysisDBFormat::Arg*) pos;
+	pos += header_->numArgs * sizeof(AnalysisDBFormat::Arg);
+	strRefs_ = (const StrRef*) pos;
+	pos += header_->numStrRefs * sizeof(StrRef);
+	strings_ = pos;
+
+	kinfos_.resize(header_->numKernels, nullptr);
+}
+
+AnalysisDB::~AnalysisDB() {
+	if (data_ != nullptr) {
+		munmap(data_, size_);
+	}
+}
+
+size_t AnalysisDB::getNumKernels() const {
+	return header_->numKernels;
+}
+
+string AnalysisDB::getKernelName(size_t idx) const {
+	if (idx >= getNumKernels()) {
+		throw out_of_range("SPACE Mekong, CLASS AnalysisDB, FUNC getKernelName(): "
+		                   "kernel index exceeds the number of kernels");
+	}
+	return getString(kernels_[idx].name);
+}
+
+//! Returns the index of the kernel `name` or -1 if there is no such kernel
+int AnalysisDB::find(const string& name) const {
+	// binary search, as the kernels are sorted by name
+	size_t first = 0;
+	size_t last = getNumKernels();
+	while (first < last) {
+		size_t mid = first + (last - first) / 2;
+		const StrRef& ref = kernels_[mid].name;
+		int cmp = memcmp(getChars(ref), name.data(), min<size_t>(ref.size, name.size()));
+		if (cmp == 0) {
+			cmp = ref.size < name.size() ? -1 : (ref.size > name.size() ? 1 : 0);
+		}
+		if (cmp == 0) {
+			return mid;
+		}
+		if (cmp < 0) {
+			first = mid + 1;
+		}
+		else {
+			last = mid;
+		}
+	}
+	return -1;
+}
+
+//! Returns nullptr if the database does not contain the kernel `name`
+shared_ptr<const bsp_KernelInfo> AnalysisDB::getKernelInfo(const string& name) {
+	int idx = find(name);
+	if (idx < 0) {
+		return nullptr;
+	}
+	return getKernelInfo((size_t) idx);
+}
+
+shared_ptr<const bsp_KernelInfo> AnalysisDB::getKernelInfo(size_t idx) {
+	if (idx >= getNumKernels()) {
+		throw out_of_range("SPACE Mekong, CLASS AnalysisDB, FUNC getKernelInfo(): "
+		                   "kernel index exceeds the number of kernels");
+	}
+	if (kinfos_[idx] == nullptr) {
+		kinfos_[idx] = createKernelInfo(idx);
+	}
+	return kinfos_[idx];
+}
+
+//! Returns the kernel info objects, which were requested so far
+vector<shared_ptr<const bsp_KernelInfo>> AnalysisDB::getLoadedKernelInfos() const {
+	vector<shared_ptr<const bsp_KernelInfo>> res;
+	for (const auto& kinfo : kinfos_) {
+		if (kinfo != nullptr) {
+			res.push_back(kinfo);
+		}
+	}
+	return res;
+}
+
+const char* AnalysisDB::getChars(const StrRef& ref) const {
+	if ((size_t) ref.offset + ref.size > header_->stringsSize) {
+		throw runtime_error("SPACE Mekong, CLASS AnalysisDB, FUNC getChars(): "
+		                    "string exceeds the analysis database ("
+		                    + filename_ + ")");
+	}
+	return strings_ + ref.offset;
+}
+
+string AnalysisDB::getString(const StrRef& ref) const {
+	return string(getChars(ref), ref.size);
+}
+
+vector<string> AnalysisDB::getStringList(uint32_t first, uint32_t num) const {
+	if ((size_t) first + num > header_->numStrRefs) {
+		throw runtime_error("SPACE Mekong, CLASS AnalysisDB, FUNC getStringList(): "
+		                    "string list exceeds the analysis database ("
+		                    + filename_ + ")");
+	}
+	vector<string> res;
+	res.reserve(num);
+	for (uint32_t i = first; i < first + num; ++i) {
+		res.push_back(getString(strRefs_[i]));
+	}
+	return res;
+}
+
+//! Analog to bsp_KernelInfo::createKInfos for one kernel of the binary database
+shared_ptr<const bsp_KernelInfo> AnalysisDB::createKernelInfo(size_t idx) {
+	auto throwError = [this] (const string& msg) {
+		throw runtime_error("SPACE Mekong, CLASS AnalysisDB, FUNC createKernelInfo(): "
+		                    + msg + " (" + filename_ + ")");
+	};
+
+	const auto& kernel = kernels_[idx];
+	if ((size_t) kernel.firstArg + kernel.numArgs > header_->numArgs) {
+		throwError("arguments exceed the analysis database");
+	}
+	string name = getString(kernel.name);
+
+	vector<shared_ptr<const bsp_ArgType>> argTypes;
+	vector<shared_ptr<const AccFunc>> accFuncs;
+	for (uint32_t argNr = 0; argNr < kernel.numArgs; ++argNr) {
+		const auto& arg = args_[kernel.firstArg + argNr];
+		string islRead = getString(arg.islRead);
+		string islWrite = getString(arg.islWrite);
+		argTypes.push_back(bsp_KernelInfo::createArgType(
+			getString(arg.typeName), arg.pointerLevel,
+			(char) arg.fundamentalType, arg.sizeBits, arg.elementSizeBits,
+			!islWrite.empty(), !islRead.empty(), arg.numDims,
+			getStringList(arg.firstDimSize, arg.numDimSizes)));
+
+		vector<shared_ptr<const string>> readParams;
+		for (auto& param : getStringList(arg.firstReadParam, arg.numReadParams)) {
+			readParams.push_back(shared_ptr<const string>(new string(move(param))));
+		}
+		vector<shared_ptr<const string>> writeParams;
+		for (auto& param : getStringList(arg.firstWriteParam, arg.numWriteParams)) {
+			writeParams.push_back(shared_ptr<const string>(new string(move(param))));
+		}
+		accFuncs.push_back(shared_ptr<const AccFunc>(
+			new AccFunc(readParams, islRead, writeParams, islWrite, argNr)));
+	}
+
+	// the partitioning objects are shared between the kernels
+	string partStr = getString(kernel.partitioning);
+	if (partStr.empty() || partStr == "None") {
+		throwError("could not find partitioning of kernel " + name);
+	}
+	auto it = parts_.find(partStr);
+	if (it == parts_.end()) {
+		it = parts_.insert(make_pair(partStr, shared_ptr<const Partitioning>(
+			new Partitioning(partStr)))).first;
+	}
+
+	return shared_ptr<const bsp_KernelInfo>(
+		new bsp_KernelInfo(name, argTypes, it->second, accFuncs));
+}
+
+}; // namespace end
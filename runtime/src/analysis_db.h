@@ -0,0 +1,70 @@
+/*! \file analysis_db.h
+    \brief Reader of the binary kernel analysis database.
+    \sa analysis_db_format.h for the file layout
+*/
+
+#ifndef MEKONG_ANALYSIS_DB_H
+#define MEKONG_ANALYSIS_DB_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+#include "analysis_db_format.h"
+
+namespace Mekong {
+
+class bsp_KernelInfo;
+class Partitioning;
+
+using namespace std;
+
+/*! \brief Maps a binary analysis database into memory.
+
+    Opening the database only checks the header, nothing is parsed. The
+    kernel info objects are created on the first request of a kernel and
+    cached afterwards.
+*/
+class AnalysisDB {
+	public:
+		AnalysisDB(const char* filename);
+		~AnalysisDB();
+
+		AnalysisDB(const AnalysisDB&) = delete;
+		AnalysisDB& operator=(const AnalysisDB&) = delete;
+
+		size_t getNumKernels() const;
+		string getKernelName(size_t idx) const;
+		int find(const string& name) const;
+
+		shared_ptr<const bsp_KernelInfo> getKernelInfo(const string& name);
+		shared_ptr<const bsp_KernelInfo> getKernelInfo(size_t idx);
+		vector<shared_ptr<const bsp_KernelInfo>> getLoadedKernelInfos() const;
+
+	private:
+		typedef AnalysisDBFormat::StrRef StrRef;
+
+		const char* getChars(const StrRef& ref) const;
+		string getString(const StrRef& ref) const;
+		vector<string> getStringList(uint32_t first, uint32_t num) const;
+		shared_ptr<const bsp_KernelInfo> createKernelInfo(size_t idx);
+
+		string filename_;
+		void* data_ = nullptr;
+		size_t size_ = 0;
+
+		const AnalysisDBFormat::Header* header_;
+		const AnalysisDBFormat::Kernel* kernels_;
+		const AnalysisDBFormat::Arg* args_;
+		const StrRef* strRefs_;
+		const char* strings_;
+
+		vector<shared_ptr<const bsp_KernelInfo>> kinfos_; ///< nullptr if not loaded yet
+		map<string, shared_ptr<const Partitioning>> parts_;
+};
+
+}; // namespace end
+
+#endif
@@ -0,0 +1,205 @@
+/*! \file analysis_db_format.h
+    \brief Binary format of the kernel analysis database.
+
+    The device code analysis (bsp_analysis) writes this file next to the
+    dashdb database and the runtime maps it into memory at startup
+    (\sa AnalysisDB). Thus the runtime does not have to be recompiled for
+    every application. The file consists of the following sections, which
+    directly follow each other:
+
+	Header
+	Kernel[numKernels]   sorted by kernel name
+	Arg[numArgs]         arguments of all kernels
+	StrRef[numStrRefs]   string lists (isl params, dim sizes)
+	char[stringsSize]    string data, not null terminated
+
+    All numbers are stored in the byte order of the machine, which wrote the
+    file. Increase `version` on every change of the layout.
+
+    This header is shared by the analysis pass and the runtime, thus it must
+    not depend on anything else than the standard library.
+*/
+
+#ifndef MEKONG_ANALYSIS_DB_FORMAT_H
+#define MEKONG_ANALYSIS_DB_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace Mekong {
+
+namespace AnalysisDBFormat {
+
+const char magic[8] = { 'M', 'E', 'K', 'O', 'N', 'G', 'D', 'B' };
+const uint32_t version = 1;
+
+//! Position of a string in the string data section
+struct StrRef {
+	uint32_t offset;
+	uint32_t size;
+};
+
+struct Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t numKernels;
+	uint32_t numArgs;
+	uint32_t numStrRefs;
+	uint32_t stringsSize;
+	uint32_t reserved;
+};
+
+struct Kernel {
+	StrRef name;
+	StrRef partitioning;
+	uint32_t firstArg; ///< index into the Arg section
+	uint32_t numArgs;
+};
+
+//! Sizes are given in bits, as in the dashdb database
+struct Arg {
+	StrRef typeName;
+	uint32_t pointerLevel;
+	uint32_t fundamentalType; ///< 'i', 'f', 'd' or 'N' (None)
+	uint32_t sizeBits;
+	uint32_t elementSizeBits;
+	uint32_t numDims;
+	StrRef islRead;  ///< empty if the argument is not read
+	StrRef islWrite; ///< empty if the argument is not written
+	uint32_t firstReadParam;  ///< index into the StrRef section
+	uint32_t numReadParams;
+	uint32_t firstWriteParam;
+	uint32_t numWriteParams;
+	uint32_t firstDimSize;
+	uint32_t numDimSizes;
+};
+
+//! Collects the analysis of all kernels and writes the binary database
+class Writer {
+	public:
+		//! Description of one kernel argument \sa Arg
+		struct ArgDesc {
+			std::string typeName;
+			unsigned pointerLevel = 0;
+			char fundamentalType = 'N';
+			unsigned sizeBits = 0;
+			unsigned elementSizeBits = 0;
+			unsigned numDims = 0;
+			std::string islRead;
+			std::string islWrite;
+			std::vector<std::string> readParams;
+			std::vector<std::string> writeParams;
+			std::vector<std::string> dimSizes;
+		};
+
+		void addKernel(const std::string& name, const std::string& partitioning,
+		               const std::vector<ArgDesc>& args);
+		void write(const char* filename);
+
+	private:
+		StrRef addString(const std::string& str);
+		uint32_t addStringList(const std::vector<std::string>& strs);
+
+		std::vector<Kernel> kernels_;
+		std::vector<Arg> args_;
+		std::vector<StrRef> strRefs_;
+		std::string strings_;
+		//! equal strings (e.g. isl maps) are stored only once
+		std::map<std::string, StrRef> stringPos_;
+};
+
+inline StrRef Writer::addString(const std::string& str) {
+	auto it = stringPos_.find(str);
+	if (it != stringPos_.end()) {
+		return it->second;
+	}
+	StrRef ref;
+	ref.offset = strings_.size();
+	ref.size = str.size();
+	strings_ += str;
+	stringPos_[str] = ref;
+	return ref;
+}
+
+inline uint32_t Writer::addStringList(const std::vector<std::string>& strs) {
+	uint32_t first = strRefs_.size();
+	for (const auto& str : strs) {
+		strRefs_.push_back(addString(str));
+	}
+	return first;
+}
+
+inline void Writer::addKernel(const std::string& name,
+                              const std::string& partitioning,
+                              const std::vector<ArgDesc>& args) {
+	Kernel kernel;
+	kernel.name = addString(name);
+	kernel.partitioning = addString(partitioning);
+	kernel.firstArg = args_.size();
+	kernel.numArgs = args.size();
+	for (const auto& desc : args) {
+		Arg arg;
+		arg.typeName = addString(desc.typeName);
+		arg.pointerLevel = desc.pointerLevel;
+		arg.fundamentalType = desc.fundamentalType;
+		arg.sizeBits = desc.sizeBits;
+		arg.elementSizeBits = desc.elementSizeBits;
+		arg.numDims = desc.numDims;
+		arg.islRead = addString(desc.islRead);
+		arg.islWrite = addString(desc.islWrite);
+		arg.firstReadParam = addStringList(desc.readParams);
+		arg.numReadParams = desc.readParams.size();
+		arg.firstWriteParam = addStringList(desc.writeParams);
+		arg.numWriteParams = desc.writeParams.size();
+		arg.firstDimSize = addStringList(desc.dimSizes);
+		arg.numDimSizes = desc.dimSizes.size();
+		args_.push_back(arg);
+	}
+	kernels_.push_back(kernel);
+}
+
+//! Sorts the kernels by name and writes the file
+inline void Writer::write(const char* filename) {
+	auto getStr = [this] (const StrRef& ref) {
+		return strings_.substr(ref.offset, ref.size);
+	};
+	std::sort(kernels_.begin(), kernels_.end(),
+	          [&getStr] (const Kernel& a, const Kernel& b) {
+	              return getStr(a.name) < getStr(b.name);
+	          });
+
+	Header header;
+	memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.numKernels = kernels_.size();
+	header.numArgs = args_.size();
+	header.numStrRefs = strRefs_.size();
+	header.stringsSize = strings_.size();
+	header.reserved = 0;
+
+	std::ofstream fs(filename, std::ofstream::out | std::ofstream::binary |
+	                           std::ofstream::trunc);
+	fs.write((const char*) &header, sizeof(header));
+	fs.write((const char*) kernels_.data(), kernels_.size() * sizeof(Kernel));
+	fs.write((const char*) args_.data(), args_.size() * sizeof(Arg));
+	fs.write((const char*) strRefs_.data(), strRefs_.size() * sizeof(StrRef));
+	fs.write(strings_.data(), strings_.size());
+	fs.close();
+	if (!fs) {
+		throw std::runtime_error("SPACE Mekong, CLASS AnalysisDBFormat::Writer, "
+		                         "FUNC write(): could not write the binary "
+		                         "analysis database " + std::string(filename));
+	}
+}
+
+}; // namespace AnalysisDBFormat
+
+}; // namespace end
+
+#endif
@@ -0,0 +1,113 @@
+/*! \file arena.h
+    \brief Chunked storage for the long living metadata of the runtime.
+*/
+
+#ifndef MEKONG_ARENA_H
+#define MEKONG_ARENA_H
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Stores objects of one category (e.g. partitions) in large chunks.
+
+    The runtime never frees kernel launches and the objects hanging on
+    them, thus there is no need to allocate and free every object on its
+    own. An arena places its objects next to each other in chunks, which
+    keeps related metadata close in memory and replaces one heap allocation
+    per object with one per chunk. The first chunk holds `firstChunkSize`
+    objects and every further chunk doubles the capacity.
+
+    Objects never move, thus the returned Index stays valid and can be used
+    as a compact handle, which is cheaper to store and compare than a
+    shared_ptr. get() turns it into a raw pointer. For interfaces, which
+    still hand out shared_ptrs, share() creates one without a control block,
+    thus copying and destroying it does no reference counting at all.
+    Objects are destroyed together with the arena, thus the arena has to
+    outlive all pointers to its objects. The arenas of the runtime are
+    never destroyed.
+*/
+template<class T, size_t firstChunkSize = 64>
+class Arena {
+	public:
+		typedef uint32_t Index;
+
+		Arena() {}
+		~Arena() {
+			for (size_t i = 0; i < size_; ++i) {
+				get(i)->~T();
+			}
+			for (auto chunk : chunks_) {
+				delete[] chunk;
+			}
+		}
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		//! Constructs a new object in the arena and returns its handle
+		template<class... Args>
+		Index create(Args&&... args) {
+			lock_guard<mutex> lock(mutex_);
+			if (size_ == (size_t) UINT32_MAX) {
+				throw length_error("SPACE Mekong, CLASS Arena, FUNC create(): "
+				                   "the arena is full");
+			}
+			size_t chunk = getChunk(size_);
+			if (chunks_[chunk] == nullptr) {
+				chunks_[chunk] = new Slot[firstChunkSize << chunk];
+			}
+			new (get(size_)) T(forward<Args>(args)...);
+			return size_++;
+		}
+
+		T& operator[](Index idx) {
+			return *get(idx);
+		}
+
+		const T& operator[](Index idx) const {
+			return *get(idx);
+		}
+
+		//! Lock free, as chunks are never moved or freed while the arena lives
+		T* get(size_t idx) const {
+			size_t chunk = getChunk(idx);
+			size_t offset = idx - firstChunkSize * ((size_t(1) << chunk) - 1);
+			return reinterpret_cast<T*>(&chunks_[chunk][offset]);
+		}
+
+		//! Returns a non owning shared_ptr to the object for legacy interfaces
+		shared_ptr<T> share(Index idx) {
+			return shared_ptr<T>(shared_ptr<T>(), get(idx));
+		}
+
+		size_t size() const {
+			lock_guard<mutex> lock(mutex_);
+			return size_;
+		}
+
+	private:
+		typedef typename aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+		//! Chunk k holds the indices [firstChunkSize * (2^k - 1), firstChunkSize * (2^(k+1) - 1))
+		static size_t getChunk(size_t idx) {
+			return 63 - __builtin_clzll(idx / firstChunkSize + 1);
+		}
+
+		static const int maxChunks = 64;
+		Slot* chunks_[maxChunks] = {};
+		size_t size_ = 0;
+		mutable mutex mutex_;
+};
+
+}; // namespace end
+
+#endif
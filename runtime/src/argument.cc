@@ -1,5 +1,8 @@
 #include <memory>
+#include <vector>
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 
 #include "argument.h"
 #include "argument_type.h"
@@ -11,6 +14,9 @@ namespace Mekong {
 using namespace std;
 
 //! Creates all kernel argument objects for a certain kernel launch object.
+
+//! The objects of one launch are stored next to each other in one shared
+//! block of memory, the returned pointers share the ownership of that block.
 vector<shared_ptr<const KernelArg>>
 KernelArg::createArgs(const vector<shared_ptr<const bsp_ArgType>>& types,
                       void** rawArgs) {
@@ -18,22 +24,10 @@ KernelArg::createArgs(const vector<shared_ptr<const bsp_ArgType>>& types,
 		throw runtime_error("SPACE Mekong, CLASS KernelArg, FUNC createArgs():\n" + msg);
 	};
 
-	vector<shared_ptr<const KernelArg>> res;
-	vector<vector<size_t>> allDimSizes(types.size());
-	vector<unique_ptr<const charPack>> charPacks;
-
-	// COLLECT RAW KERNEL VALUES FIRST
-	unsigned short arg_nr = 0;
-	for (auto arg_type : types) {
-		charPacks.push_back(unique_ptr<const charPack>(
-		                    new charPack(rawArgs[arg_nr], arg_type->getSize() * 8))); // *8 as charPacks deal with bits
-		++arg_nr;
-	}
-
-	auto parseArrayDimSizes = [&] (shared_ptr<const bsp_ArgType> arg_type) {
+	auto parseArrayDimSizes = [&] (const shared_ptr<const bsp_ArgType>& arg_type) {
 		vector<size_t> dimSizes(arg_type->getNumDims() - 1);
 		unsigned short dim_nr = 0;
-		for (string dim_pattern : arg_type->getDimSizePatterns()) {
+		for (const string& dim_pattern : arg_type->getDimSizePatterns()) {
 			if (dim_pattern.empty()) {
 				throwError("Could not deduce array size from empty pattern");
 			}
@@ -44,7 +38,9 @@ KernelArg::createArgs(const vector<shared_ptr<const bsp_ArgType>>& types,
 					throwError("I can not deduce an array size from a non-integral "
 					           "kernel argument with type " + types[arg_nr]->getName());
 				}
-				dimSizes[dim_nr] = charPacks[arg_nr]->asInt<int>();
+				int size = 0;
+				memcpy(&size, rawArgs[arg_nr], min<size_t>(types[arg_nr]->getSize(), sizeof(int)));
+				dimSizes[dim_nr] = size;
 			}
 			else {
 				throwError("Could not deduce array size from pattern '" + dim_pattern + "'");
@@ -55,65 +51,29 @@ KernelArg::createArgs(const vector<shared_ptr<const bsp_ArgType>>& types,
 		return dimSizes;
 	};
 
-	// COLLECT ARRAY DIMENSION SIZES
-	arg_nr = 0;
-	for (auto arg_type : types) {
-		if (arg_type->getPtrlvl() == 1) {
-			if (arg_type->getNumDims() > 1) {
-				allDimSizes[arg_nr] = parseArrayDimSizes(arg_type);
-			}
+	// CREATE THE ARGUMENT OBJECTS
+	// Only multi dimensional arrays need their dimension sizes, an empty
+	// vector does not allocate memory.
+	auto store = make_shared<vector<KernelArg>>();
+	store->reserve(types.size());
+	unsigned short arg_nr = 0;
+	for (auto& arg_type : types) {
+		if (arg_type->getPtrlvl() == 1 && arg_type->getNumDims() > 1) {
+			store->emplace_back(arg_type, rawArgs[arg_nr], parseArrayDimSizes(arg_type));
+		}
+		else {
+			store->emplace_back(arg_type, rawArgs[arg_nr], vector<size_t>());
 		}
 		++arg_nr;
 	}
-
-	// FINALLY CREATE THE ARGUMENT OBJECTS
-	arg_nr = 0;
-	for (auto arg_type : types) {
-		res.push_back(
-			shared_ptr<const KernelArg>(
-				new KernelArg(arg_type,
-				              move(charPacks[arg_nr]),
-				              allDimSizes[arg_nr])
-			)
-		);
-		++arg_nr;
+	vector<shared_ptr<const KernelArg>> res;
+	res.reserve(types.size());
+	for (const KernelArg& arg : *store) {
+		res.push_back(shared_ptr<const KernelArg>(store, &arg)); // aliasing, no allocation
 	}
 	return res;
 }
 
-/*! \brief Constructs a kernel argument object.
-
-    The binary data will be taken from the given character pack pointer. The 
-    pointer will be left in an undefined state after object construction.
-    Moreover the constructor throws if a wrong dimension sizes are given.
-    \param type E.g. contains the information of the argument's size in Bytes.
-    \param pc undefined after object creation.
-    \param dimSizes contains the dimension size in case of a multi dimensional
-           array.
-    \sa getDimSize for the array dimension size explanation.
-*/
-KernelArg::KernelArg(shared_ptr<const bsp_ArgType> type,
-                     unique_ptr<const charPack> cp,
-                     const vector<size_t>& dimSizes) :
-			type_(type),
-			cp_(move(cp)),
-			dimSizes_(dimSizes) {
-
-	if (dimSizes.size() != type->getNumDims() - 1 &&
-	    !(dimSizes.empty() && type->getNumDims() == 0)) {
-
-		throw invalid_argument(
-			"SPACE Mekong, CLASS KernelArg, FUNC KernelArg():\n"
-			"I got a type with num dims " + to_string(type->getNumDims()) +
-			", but you put " + to_string(dimSizes.size()) + " dimension sizes" +
-			" in the constructor function." +
-			"But I expect " + to_string(type->getNumDims() - 1) +
-			" dimension sizes\n"
-		);
-	}
-
-}
-
 /*! \brief Constructs a kernel argument object.
 
     At the construction of the object the binary data of the given memory
@@ -127,9 +87,9 @@ KernelArg::KernelArg(shared_ptr<const bsp_ArgType> type,
 */
 KernelArg::KernelArg(shared_ptr<const bsp_ArgType> type, const void* vptr,
                      const vector<size_t>& dimSizes) :
+			dimSizes_(dimSizes),
 			type_(type),
-			cp_(new charPack(vptr, type->getSize() * 8)),
-			dimSizes_(dimSizes) {
+			size_(type->getSize()) {
 
 	if (dimSizes.size() != type->getNumDims() - 1
 	    && !(dimSizes.empty() && type->getNumDims() == 0)) {
@@ -141,11 +101,26 @@ KernelArg::KernelArg(shared_ptr<const bsp_ArgType> type, const void* vptr,
 		                       "But I expect " + to_string(type->getNumDims() - 1)
 		                       + string(" dimension sizes\n"));
 	}
+
+	unsigned char* data = inline_;
+	if (size_ > inlineSize) {
+		heap_.reset(new unsigned char[size_]);
+		data = heap_.get();
+	}
+	memcpy(data, vptr, size_);
+
+	// FNV-1a over the bits
+	uint64_t h = 14695981039346656037ULL;
+	for (unsigned i = 0; i < size_; ++i) {
+		h = (h ^ data[i]) * 1099511628211ULL;
+	}
+	hash_ = h;
 }
 
 //! If all bits of the values are equal, the function returns true
 bool KernelArg::isEqualInBits(const KernelArg& other) const {
-	return *cp_ == *other.cp_; // compare value of character packs
+	return hash_ == other.hash_ && size_ == other.size_
+	       && memcmp(getRaw(), other.getRaw(), size_) == 0;
 }
 
 //! Returns an object containing the argument type.
@@ -182,19 +157,33 @@ size_t KernelArg::getDimSize(unsigned axis) const {
 	}
 }
 
-//! Converts the argument value to a intmax_t.
+//! Converts the argument value to a intmax_t. Narrow values are zero extended.
 intmax_t KernelArg::asInt() const {
-	return cp_->asInt<intmax_t>();
+	uint64_t res = 0;
+	memcpy(&res, getRaw(), min<size_t>(size_, sizeof(res))); // little endian
+	return res;
 }
 
-//! Converts the argument value to a double of IEEE754 standard.
+//! Converts the argument value to a float of IEEE754 standard.
 float KernelArg::asFloat() const {
-	return cp_->asFloat_IEEE754();
+	if (size_ != sizeof(float)) {
+		throw runtime_error("SPACE Mekong, CLASS KernelArg, FUNC asFloat():\n"
+		                    "the argument has " + to_string(size_) + " Bytes\n");
+	}
+	float res;
+	memcpy(&res, getRaw(), sizeof(res));
+	return res;
 }
 
 //! Converts the argument value to a double of IEEE754 standard.
 double KernelArg::asDouble() const {
-	return cp_->asDouble_IEEE754();
+	if (size_ != sizeof(double)) {
+		throw runtime_error("SPACE Mekong, CLASS KernelArg, FUNC asDouble():\n"
+		                    "the argument has " + to_string(size_) + " Bytes\n");
+	}
+	double res;
+	memcpy(&res, getRaw(), sizeof(res));
+	return res;
 }
 
 /*! \brief Returns the value of the argument as an intmax_t.
@@ -203,12 +192,7 @@ double KernelArg::asDouble() const {
     is an integer type.
 */
 MEdeviceptr KernelArg::asDevPtr() const {
-	auto throwError = [] (const string& msg) {
-		throw runtime_error("SPACE Mekong, CLASS KernelArg, FUNC asDevPtr():\n"
-		                    + msg);
-	};
-	if (getType()->getSize() != sizeof(MEdeviceptr)
-	    || sizeof(intmax_t) < sizeof(MEdeviceptr)) {
+	if (size_ != sizeof(MEdeviceptr)) {
 		throw runtime_error("Kernel argument of type '" + getType()->getName() +
 		                    "' can not be converted to a device pointer, "
 		                    "because the size of the argument's type is "
@@ -216,16 +200,28 @@ MEdeviceptr KernelArg::asDevPtr() const {
 		                    + ", whereas the size of a device ptr is equal to"
 		                    + " " + to_string(sizeof(MEdeviceptr)) + " Bytes.");
 	}
-	return cp_->asInt<intmax_t>();
+	MEdeviceptr res;
+	memcpy(&res, getRaw(), sizeof(res));
+	return res;
 }
 
-unique_ptr<charPack> KernelArg::cpyCharPack() const {
-	return unique_ptr<charPack>(new charPack(*cp_));
+const void* KernelArg::getRaw() const {
+	return heap_ ? heap_.get() : inline_;
+}
+
+//! Returns the size of the value in Bytes
+unsigned KernelArg::getSize() const {
+	return size_;
+}
+
+//! Returns the hash of the bits, which is calculated at construction
+size_t KernelArg::getHash() const {
+	return hash_;
 }
 
 ostream& operator<<(ostream& out, const KernelArg& arg) {
 	if (arg.getType()->getNumDims() > 1) {
-		out << "(Bits: " << *arg.cpyCharPack() << ", Type: " << *arg.getType();
+		out << "(Bits: " << charPack(arg.getRaw(), arg.getSize() * 8) << ", Type: " << *arg.getType();
 		out << ", NumDims: " << arg.getType()->getNumDims();
 		out << ", DimSizes: ";
 		for (auto dimSize : arg.getDimSizes()) {
@@ -234,7 +230,7 @@ ostream& operator<<(ostream& out, const KernelArg& arg) {
 		out << ")";
 	}
 	else {
-		out << "(Bits: " << *arg.cpyCharPack() << ", Type: " << *arg.getType();
+		out << "(Bits: " << charPack(arg.getRaw(), arg.getSize() * 8) << ", Type: " << *arg.getType();
 		out << ", NumDims: " << arg.getType()->getNumDims();
 		out << ")";
 	}
@@ -258,10 +254,7 @@ bool operator==(const KernelArg& a, const KernelArg& b) {
 	if (a.getType()->getPtrlvl() != b.getType()->getPtrlvl()) {
 		return false;
 	}
-	if (*a.cp_ != *b.cp_) {
-		return false;
-	}
-	return true;
+	return a.isEqualInBits(b);
 }
 
 bool operator!=(const KernelArg& a, const KernelArg& b) {
@@ -2,7 +2,9 @@
 #define MEKONG_ARGUMENT_H
 
 #include <memory>
+#include <vector>
 #include <cstdint>
+#include <cstring>
 
 #include "argument_type.h"
 #include "bitop.h"
@@ -20,17 +22,23 @@ using namespace bitop;
     wrapLaunchKernel function gets the kernel argument values with type void*.
     We want to have a generic interface to cast the arguments into their
     intended types.
+
+    The value is copied into a small buffer inside the object, thus capturing
+    the arguments of a launch does not allocate memory. Only values larger
+    than inlineSize Bytes (e.g. structs passed by value) are stored on the
+    heap. A hash of the bits is calculated once at construction to speed up
+    the comparison of kernel launches.
 */
 class KernelArg {
 	public:
+		static const unsigned inlineSize = 16;
+
 		static vector<shared_ptr<const KernelArg>>
 		createArgs(const vector<shared_ptr<const bsp_ArgType>>& types, void** rawArgs);
 
-		KernelArg(shared_ptr<const bsp_ArgType> type,
-		          unique_ptr<const charPack> cp,
-				  const vector<size_t>& dimSizes = {});
 		KernelArg(shared_ptr<const bsp_ArgType> type, const void* vptr,
 		          const vector<size_t>& dimSizes = {});
+		KernelArg(KernelArg&& other) = default;
 
 		bool isEqualInBits(const KernelArg& other) const;
 		shared_ptr<const bsp_ArgType> getType() const;
@@ -41,9 +49,10 @@ class KernelArg {
 		double asDouble() const;
 		MEdeviceptr asDevPtr() const;
 
-		// as the cuda kernel launch function expect a void* and not a const void* we
-		// need this copy function to get the raw void* pointer
-		unique_ptr<charPack> cpyCharPack() const;
+		//! Points to the bits of the argument, which are getSize() Bytes long
+		const void* getRaw() const;
+		unsigned getSize() const;
+		size_t getHash() const;
 
 		                  friend bool operator==(const KernelArg& a, const KernelArg& b);
 		template<class T> friend bool operator==(const KernelArg& a, T obj);
@@ -56,8 +65,11 @@ class KernelArg {
 		//! the dimension limits with exception of one dimension. Thus
 		//! dimSizes_.size() = numDims - 1.
 		vector<size_t> dimSizes_;
-		unique_ptr<const charPack> cp_;
 		shared_ptr<const bsp_ArgType> type_;
+		unsigned size_; ///< in Bytes
+		size_t hash_;
+		alignas(8) unsigned char inline_[inlineSize];
+		unique_ptr<unsigned char[]> heap_; ///< nullptr if size_ <= inlineSize
 };
 
 ostream& operator<<(ostream& out, const KernelArg& arg);
@@ -67,13 +79,13 @@ bool operator!=(const KernelArg& a, const KernelArg& b);
 //! Compares the bits of the two objects.
 template<class T>
 bool operator==(const KernelArg& a, T obj) {
-	return *a.cp_ == charPack(obj);
+	return a.size_ == sizeof(T) && memcmp(a.getRaw(), &obj, sizeof(T)) == 0;
 }
 
 //! Compares the bits of the two objects.
 template<class T>
 bool operator==(T obj, const KernelArg& a) {
-	return *a.cp_ == charPack(obj);
+	return a == obj;
 }
 
 //! Compares the bits of the two objects.
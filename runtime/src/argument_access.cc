@@ -45,6 +45,32 @@ ArgAccess::intersectIntervals(const tuple<size_t, size_t>& a,
 	return res;
 }
 
+/*! \param covered intervals sorted by their start, they may overlap
+    \return the uncovered pieces of `range` in ascending order
+*/
+vector<tuple<size_t, size_t>>
+ArgAccess::subtractIntervals(const tuple<size_t, size_t>& range,
+                             const vector<tuple<size_t, size_t>>& covered) {
+	vector<tuple<size_t, size_t>> res;
+	size_t pos = get<0>(range);
+	for (const auto& c : covered) {
+		if (get<0>(c) >= get<1>(range)) {
+			break;
+		}
+		if (get<1>(c) <= pos) {
+			continue;
+		}
+		if (get<0>(c) > pos) {
+			res.push_back(make_tuple(pos, get<0>(c)));
+		}
+		pos = get<1>(c);
+	}
+	if (pos < get<1>(range)) {
+		res.push_back(make_tuple(pos, get<1>(range)));
+	}
+	return res;
+}
+
 const ArgAccess::GpuToRangesMapping_t& ArgAccess::getMap() const {
 	return gpuToRanges_;
 }
@@ -47,6 +47,11 @@ class ArgAccess {
 		static tuple<size_t, size_t>
 		intersectIntervals(const tuple<size_t, size_t>& a,
 		                   const tuple<size_t, size_t>& b);
+
+		//! help function which gives the parts of a range, which are not covered
+		static vector<tuple<size_t, size_t>>
+		subtractIntervals(const tuple<size_t, size_t>& range,
+		                  const vector<tuple<size_t, size_t>>& covered);
 	private:
 		GpuToRangesMapping_t gpuToRanges_;
 };
@@ -3,6 +3,7 @@
 
 #include "mekong-cuda.h"
 #include "argument_type.h"
+#include "isl_context.h"
 
 #include "isl/union_map.h"
 
@@ -171,11 +172,10 @@ bool bsp_ArgType::isEmptyIslMap(const string& mapStr) {
 	if (mapStr == "null" || mapStr == "empty") {
 		return true;
 	}
-	isl_ctx* ctx = isl_ctx_alloc();
+	isl_ctx* ctx = IslContext::get().getCtx();
 	isl_union_map* umap = isl_union_map_read_from_str(ctx, mapStr.c_str());
 	bool result = isl_union_map_is_empty(umap);
 	isl_union_map_free(umap);
-	isl_ctx_free(ctx);
 	return result;
 }
 
@@ -0,0 +1,22 @@
+#ifndef MEKONG_CONTENT_HASH_H
+#define MEKONG_CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Fast non cryptographic 64 bit hash of a memory region.
+
+    The algorithm follows xxHash64. It consumes 32 Byte stripes with four
+    independent accumulators, which the compiler can keep in registers or
+    vectorize. We use it to recognize host buffers, which the user uploads
+    again without changing their content.
+*/
+uint64_t hashContent(const void* data, size_t size, uint64_t seed = 0);
+
+}; // namespace end
+
+#endif
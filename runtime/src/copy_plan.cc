@@ -0,0 +1,298 @@
+#include "copy_plan.h"
+#include "mekong-cuda.h"
+#include "alias_handle.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm> // std::stable_sort, std::remove_if, std::min
+#include <chrono>
+#include <tuple>
+
+namespace Mekong {
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+using Duration = chrono::duration<double>;
+
+size_t CopyPlan::chunkSize_ = 0;
+
+//! Appends a contiguous copy
+void CopyPlan::add(int src, int dst, size_t srcOff, size_t dstOff, size_t size) {
+	ops_.push_back({ src, dst, srcOff, dstOff, size, 1, 0, 0 });
+}
+
+void CopyPlan::add(const CopyOp& op) {
+	ops_.push_back(op);
+}
+
+//! Removes all operations, which copy no Byte
+CopyPlan& CopyPlan::dropEmpty() {
+	ops_.erase(remove_if(ops_.begin(), ops_.end(),
+	                     [] (const CopyOp& op) { return op.getBytes() == 0; }),
+	           ops_.end());
+	return *this;
+}
+
+/*! \brief Merges neighbouring operations between the same devices.
+
+    Two contiguous copies, which continue each other on the source and on
+    the destination, become one copy. A sequence of equally sized copies
+    with constant distances on the source and the destination (e.g. the
+    columns of a halo, if the grid is split along x) becomes one strided
+    copy. Only neighbours in the list are merged, thus call groupByDevice()
+    first.
+*/
+CopyPlan& CopyPlan::merge() {
+	if (ops_.empty()) {
+		return *this;
+	}
+	Ops res;
+	res.reserve(ops_.size());
+	res.push_back(ops_[0]);
+	for (size_t i = 1; i < ops_.size(); ++i) {
+		CopyOp& prev = res.back();
+		const CopyOp& op = ops_[i];
+		if (prev.src != op.src || prev.dst != op.dst || op.rows != 1) {
+			res.push_back(op);
+			continue;
+		}
+		// continues a contiguous copy
+		if (prev.rows == 1 && prev.srcOff + prev.size == op.srcOff
+		    && prev.dstOff + prev.size == op.dstOff) {
+			prev.size += op.size;
+			continue;
+		}
+		if (prev.size != op.size) {
+			res.push_back(op);
+			continue;
+		}
+		// second row of a new strided copy; a pitch must not be smaller
+		// than the row
+		if (prev.rows == 1 && op.srcOff >= prev.srcOff + prev.size
+		    && op.dstOff >= prev.dstOff + prev.size) {
+			prev.srcPitch = op.srcOff - prev.srcOff;
+			prev.dstPitch = op.dstOff - prev.dstOff;
+			prev.rows = 2;
+			continue;
+		}
+		// next row of a strided copy
+		if (prev.rows > 1 && op.srcOff == prev.srcOff + prev.rows * prev.srcPitch
+		    && op.dstOff == prev.dstOff + prev.rows * prev.dstPitch) {
+			++prev.rows;
+			continue;
+		}
+		res.push_back(op);
+	}
+	ops_ = move(res);
+	return *this;
+}
+
+/*! \brief Splits operations with more than `chunkSize` Bytes.
+
+    Contiguous copies are cut into pieces of `chunkSize` Bytes, strided
+    copies into groups of rows. A single row is never cut. Small pieces
+    allow to overlap the copies with other work.
+*/
+CopyPlan& CopyPlan::split(size_t chunkSize) {
+	if (chunkSize == 0) {
+		return *this;
+	}
+	Ops res;
+	res.reserve(ops_.size());
+	for (const auto& op : ops_) {
+		if (op.getBytes() <= chunkSize) {
+			res.push_back(op);
+		}
+		else if (op.rows == 1) {
+			for (size_t first = 0; first < op.size; first += chunkSize) {
+				CopyOp piece = op;
+				piece.srcOff += first;
+				piece.dstOff += first;
+				piece.size = min(chunkSize, op.size - first);
+				res.push_back(piece);
+			}
+		}
+		else {
+			size_t rowsPerChunk = max<size_t>(1, chunkSize / op.size);
+			for (size_t row = 0; row < op.rows; row += rowsPerChunk) {
+				CopyOp piece = op;
+				piece.srcOff += row * op.srcPitch;
+				piece.dstOff += row * op.dstPitch;
+				piece.rows = min(rowsPerChunk, op.rows - row);
+				res.push_back(piece);
+			}
+		}
+	}
+	ops_ = move(res);
+	return *this;
+}
+
+/*! \brief Orders the operations by the executing device and the device pair.
+
+    The executor switches the context only if the device changes, thus
+    afterwards there is only one switch per device. The order within a
+    device pair is kept.
+*/
+CopyPlan& CopyPlan::groupByDevice() {
+	stable_sort(ops_.begin(), ops_.end(), [] (const CopyOp& a, const CopyOp& b) {
+		return make_tuple(a.getDevice(), a.src, a.dst)
+		     < make_tuple(b.getDevice(), b.src, b.dst);
+	});
+	return *this;
+}
+
+//! Runs all passes; splits with the chunk size set by setChunkSize()
+CopyPlan& CopyPlan::optimize() {
+	return dropEmpty().groupByDevice().merge().split(chunkSize_);
+}
+
+/*! \brief Submits all operations and waits for them, if `sync` is set.
+
+    \param dst destination buffer. Must be a host buffer, if an operation
+           has the destination -1, and a device buffer otherwise.
+    \param src source buffer, see `dst`
+    \param hook if set, it is called after every submitted operation. The
+           copies are asynchronous, thus the time is only the submission
+           time of the operation.
+*/
+MEresult CopyPlan::exec(const CopyBuffer& dst, const CopyBuffer& src,
+                        AliasHandle& aliasH, bool sync,
+                        const TimingHook& hook) const {
+	auto throwError = [] (const string& msg) {
+		throw invalid_argument("SPACE Mekong, CLASS CopyPlan, FUNC exec():\n" + msg);
+	};
+
+	const vector<MEcontext>& ctxs = aliasH.getCtx();
+	if (ctxs.size() != aliasH.getNumDev()) {
+		throw runtime_error("SPACE Mekong, CLASS CopyPlan, FUNC exec(): not "
+		                    "enough device contexts for number of devices in "
+		                    "alias handle object");
+	}
+	// look up the device pointers only once
+	const vector<MEdeviceptr>* dstPtrs = nullptr;
+	const vector<MEdeviceptr>* srcPtrs = nullptr;
+	if (!dst.isHost()) {
+		dstPtrs = &aliasH[dst.dev];
+		if (dstPtrs->size() != aliasH.getNumDev()) {
+			throwError("not enough alias pointer for every device of the destination");
+		}
+	}
+	if (!src.isHost()) {
+		srcPtrs = &aliasH[src.dev];
+		if (srcPtrs->size() != aliasH.getNumDev()) {
+			throwError("not enough alias pointer for every device of the source");
+		}
+	}
+
+	MEresult res;
+	int currDev = -1; // device of the pushed context
+	for (const auto& op : ops_) {
+		if ((op.src < 0) != src.isHost() || (op.dst < 0) != dst.isHost()) {
+			throwError("the source or destination of an operation does not "
+			           "match the kind of the buffers");
+		}
+		if (op.src < 0 && op.dst < 0) {
+			throwError("host to host copies are not supported");
+		}
+		auto timestamp = Clock::now();
+		if (op.getDevice() != currDev) {
+			if (currDev >= 0) {
+				res &= meCtxPopCurrent(nullptr);
+			}
+			currDev = op.getDevice();
+			res &= meCtxPushCurrent(ctxs.at(currDev));
+		}
+		const unsigned char* srcHost = src.isHost()
+		                             ? (const unsigned char*) src.host + op.srcOff : nullptr;
+		unsigned char* dstHost = dst.isHost()
+		                       ? (unsigned char*) dst.host + op.dstOff : nullptr;
+		MEdeviceptr srcDev = srcPtrs ? srcPtrs->at(op.src) + op.srcOff : 0;
+		MEdeviceptr dstDev = dstPtrs ? dstPtrs->at(op.dst) + op.dstOff : 0;
+		if (op.rows > 1) {
+			res &= meMemcpy2DAsync(dstHost, dstDev, op.dstPitch,
+			                       srcHost, srcDev, op.srcPitch,
+			                       op.size, op.rows, 0);
+		}
+		else if (srcHost) {
+			res &= meMemcpyHtoDAsync(dstDev, srcHost, op.size, 0);
+		}
+		else if (dstHost) {
+			res &= meMemcpyDtoHAsync(dstHost, srcDev, op.size, 0);
+		}
+		else {
+			res &= meMemcpyDtoDAsync(dstDev, srcDev, op.size, 0);
+		}
+		if (hook) {
+			Duration time = Clock::now() - timestamp;
+			hook(op, time.count());
+		}
+		if (!res.isSuccess()) {
+			break;
+		}
+	}
+	if (currDev >= 0) {
+		res &= meCtxPopCurrent(nullptr);
+	}
+
+	// synchronize with each context
+	if (sync) {
+		for (auto ctx : ctxs) {
+			if (!res.isSuccess()) {
+				break;
+			}
+			res &= meCtxPushCurrent(ctx);
+			res &= meCtxSynchronize();
+			res &= meCtxPopCurrent(nullptr);
+		}
+	}
+	return res;
+}
+
+const CopyPlan::Ops& CopyPlan::getOps() const {
+	return ops_;
+}
+
+//! Returns the number of copied Bytes of one execution
+size_t CopyPlan::getBytes() const {
+	size_t res = 0;
+	for (const auto& op : ops_) {
+		res += op.getBytes();
+	}
+	return res;
+}
+
+bool CopyPlan::isEmpty() const {
+	return ops_.empty();
+}
+
+//! Sets the chunk size of optimize(). Zero (the default) disables splitting.
+void CopyPlan::setChunkSize(size_t chunkSize) {
+	chunkSize_ = chunkSize;
+}
+
+size_t CopyPlan::getChunkSize() {
+	return chunkSize_;
+}
+
+ostream& operator<<(ostream& out, const CopyOp& op) {
+	out << "(src: " << op.src << ", dst: " << op.dst
+	    << ", from: " << op.srcOff << ", to: " << op.dstOff
+	    << ", size: " << op.size << " Byte";
+	if (op.rows > 1) {
+		out << " x " << op.rows << " rows, pitches: " << op.srcPitch
+		    << "/" << op.dstPitch;
+	}
+	out << ")";
+	return out;
+}
+
+ostream& operator<<(ostream& out, const CopyPlan& plan) {
+	out << "CopyPlan(" << plan.getOps().size() << " ops, "
+	    << plan.getBytes() << " Bytes)";
+	return out;
+}
+
+}; // namespace end
@@ -0,0 +1,122 @@
+/*! \file copy_plan.h
+    \brief One representation and one executor for all memory copies.
+*/
+
+#ifndef MEKONG_COPY_PLAN_H
+#define MEKONG_COPY_PLAN_H
+
+#include <vector>
+#include <functional>
+#include <ostream>
+#include <cstddef>
+
+#include "mekong-cuda.h"
+#include "alias_handle.h"
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief One copy of `rows` blocks with `size` Bytes each.
+
+    Row i starts at `srcOff + i * srcPitch` on the source and at
+    `dstOff + i * dstPitch` on the destination. A contiguous copy has
+    exactly one row, its pitches are meaningless.
+*/
+struct CopyOp {
+	int src;         ///< -1 refers to host memory, 0-i targets gpu 0 to i
+	int dst;         ///< -1 refers to host memory, 0-i targets gpu 0 to i
+	size_t srcOff;   ///< first Byte on the source buffer
+	size_t dstOff;   ///< first Byte on the destination buffer
+	size_t size;     ///< Bytes per row
+	size_t rows;     ///< number of rows
+	size_t srcPitch; ///< distance between two rows on the source
+	size_t dstPitch; ///< distance between two rows on the destination
+
+	//! The device, whose context executes the copy
+	int getDevice() const {
+		return dst >= 0 ? dst : src;
+	}
+
+	size_t getBytes() const {
+		return size * rows;
+	}
+};
+
+ostream& operator<<(ostream& out, const CopyOp& op);
+
+/*! \brief Source or destination of a copy plan.
+
+    Either a host buffer or an application device pointer, whose aliases
+    on the devices are looked up in the alias handle.
+*/
+struct CopyBuffer {
+	const void* host; ///< nullptr for device buffers
+	MEdeviceptr dev;
+
+	static CopyBuffer onHost(const void* ptr) {
+		return CopyBuffer{ ptr, 0 };
+	}
+
+	static CopyBuffer onDevice(MEdeviceptr ptr) {
+		return CopyBuffer{ nullptr, ptr };
+	}
+
+	bool isHost() const {
+		return host != nullptr;
+	}
+};
+
+/*! \brief A list of copy operations, which can be optimized and executed.
+
+    Every memory copy of the runtime (host to device, device to host and
+    device to device) is described by a plan. The passes rewrite the list of
+    operations and can be chained, e.g.
+
+    \code
+    plan.dropEmpty().groupByDevice().merge().split(chunkSize);
+    \endcode
+
+    The passes assume, that no two operations write the same Byte of the
+    same destination device, which holds for all patterns of the runtime.
+    Thus the operations may be reordered.
+*/
+class CopyPlan {
+	public:
+		typedef vector<CopyOp> Ops;
+
+		//! Called after every submitted operation with the host time it needed
+		typedef function<void(const CopyOp& op, double seconds)> TimingHook;
+
+		void add(int src, int dst, size_t srcOff, size_t dstOff, size_t size);
+		void add(const CopyOp& op);
+
+		// PASSES
+		CopyPlan& dropEmpty();
+		CopyPlan& merge();
+		CopyPlan& split(size_t chunkSize);
+		CopyPlan& groupByDevice();
+		CopyPlan& optimize();
+
+		MEresult exec(const CopyBuffer& dst, const CopyBuffer& src,
+		              AliasHandle& aliasH, bool sync,
+		              const TimingHook& hook = TimingHook()) const;
+
+		const Ops& getOps() const;
+		size_t getBytes() const;
+		bool isEmpty() const;
+
+		static void setChunkSize(size_t chunkSize);
+		static size_t getChunkSize();
+
+	private:
+		Ops ops_;
+
+		static size_t chunkSize_; ///< used by optimize(), 0 disables splitting
+};
+
+ostream& operator<<(ostream& out, const CopyPlan& plan);
+
+}; // namespace end
+
+#endif
@@ -8,34 +8,51 @@
 #include <memory>
 #include <vector>
 #include <ostream>
+#include <tuple>
+#include <algorithm> // std::sort, std::upper_bound
 
 namespace Mekong {
 
+bool DepResolution::haloPacking_ = false;
+
 DepResolution::DepResolution(shared_ptr<KernelLaunch> master,
                        shared_ptr<KernelLaunch> slave,
                        shared_ptr<AliasHandle> aliasH) 
 		: master_(master),
 		  slave_(slave),
 		  aliasH_(aliasH),
-		  memcpys_(initMemcpys()) {}
+		  memcpys_(initMemcpys()),
+		  local_(isLocal()) {}
 
-//! Sync all devices; Execute resolving mem copies; Sync all devices again;
+//! Sync the involved devices; Execute resolving mem copies; Sync them again;
 MEresult DepResolution::exec() {
 	auto time_exec_begin = Clock::now();
 	MEresult res;
+	if (local_) {
+		++executions_;
+		return res;
+	}
 
 	// Ensure that the data is already calculated
 	// which we want to copy
 	res &= syncWithMaster();
 
-	for (const auto& memcpy : memcpys_) {
-		res &= memcpy->exec();
+	if (haloPacking_ && !memcpys_.empty()) {
+		if (!haloExchange_) {
+			haloExchange_.reset(new HaloExchange(memcpys_, aliasH_));
+		}
+		res &= haloExchange_->exec();
+	}
+	else {
+		for (const auto& memcpy : memcpys_) {
+			res &= memcpy->exec();
+		}
 	}
 
 	// SYNCHRONIZE
-	// TODO later we should have the possibility to synchronize with the
-	// specific kernel launch only. Up to now we make a total sync
-	for (auto& ctx : aliasH_->getCtx()) {
+	// The copies run on the devices of master and slave only, the devices
+	// of independent launches keep on computing \sa DeviceGroups
+	for (auto& ctx : getInvolvedCtx()) {
 		res &= meCtxPushCurrent(ctx);
 		res &= meCtxSynchronize();
 		res &= meCtxPopCurrent(0);
@@ -51,9 +68,11 @@ MEresult DepResolution::exec() {
 //! This means not neccessarily a total synchronization between the host
 //! and all devices. It can be possible to synchronize with certain
 //! launched partitions, which contains the dependencies.
+//! The devices of the slave are synchronized as well, because the copies
+//! overwrite data, which a running kernel of the slave's devices might read.
 MEresult DepResolution::syncWithMaster() const {
 	MEresult res;
-	for (auto& ctx : aliasH_->getCtx()) {
+	for (auto& ctx : getInvolvedCtx()) {
 		res &= meCtxPushCurrent(ctx);
 		res &= meCtxSynchronize();
 		res &= meCtxPopCurrent(0);
@@ -61,6 +80,24 @@ MEresult DepResolution::syncWithMaster() const {
 	return res;
 }
 
+//! Contexts of the devices, which run a partition of master or slave
+vector<MEcontext> DepResolution::getInvolvedCtx() const {
+	const vector<MEcontext>& ctxs = aliasH_->getCtx();
+	vector<bool> involved(ctxs.size(), false);
+	for (const auto& kl : { master_, slave_ }) {
+		for (const auto& part : kl->getPartitions()) {
+			involved.at(part->getDevice()) = true;
+		}
+	}
+	vector<MEcontext> res;
+	for (size_t gpu = 0; gpu < ctxs.size(); ++gpu) {
+		if (involved[gpu]) {
+			res.push_back(ctxs[gpu]);
+		}
+	}
+	return res;
+}
+
 /*! \brief Pointer based comparison.
 
     This is valid, because we create only unique kernel launch objects.
@@ -70,11 +107,34 @@ MEresult DepResolution::syncWithMaster() const {
     \sa Mekong::KernelLaunch::equal_to
     \sa Mekong::KernelLaunch::operator==
 */
-bool DepResolution::isResolutionOf(shared_ptr<KernelLaunch> master,
-                                   shared_ptr<KernelLaunch> slave) const {
+bool DepResolution::isResolutionOf(const shared_ptr<KernelLaunch>& master,
+                                   const shared_ptr<KernelLaunch>& slave) const {
 	return master == master_ && slave == slave_;
 }
 
+/*! \brief True if the slave reads only data, which the master wrote on
+           the same device.
+
+    Then there is nothing to copy, and the kernels of a device, which run
+    on its default stream, are executed in order. Only launches with
+    several partitions on one device use other streams, thus they are
+    still synchronized \sa KernelLaunch::hasConcurrentPartitions.
+    Overlapping partitions, which compute their halos redundantly, resolve
+    most of their dependencies this way \sa KernelLaunch::getBlockingPhase
+*/
+bool DepResolution::isLocal() const {
+	if (!master_ || !slave_ || master_->hasConcurrentPartitions() ||
+	    slave_->hasConcurrentPartitions()) {
+		return false;
+	}
+	for (const auto& memcpy : memcpys_) {
+		if (!memcpy->getPattern()->empty()) {
+			return false;
+		}
+	}
+	return true;
+}
+
 //! If a dep res object contains no mem cpy objects it is empty
 bool DepResolution::isEmpty() const {
 	return getMemCpys().empty();
@@ -100,6 +160,31 @@ const vector<unique_ptr<MemCpyDtoD>>& DepResolution::getMemCpys() const {
 	return memcpys_;
 }
 
+/*! \brief Packs the halos per device pair, if the cost model favours it.
+    \sa HaloExchange
+*/
+void DepResolution::setHaloPacking(bool enable) {
+	haloPacking_ = enable;
+}
+
+/*! \brief Creates the copy, which moves buffer `ptr` from the devices of the
+           access `from` to the devices of the access `to`.
+
+    Used after a re-partitioning: `from` is the write access of the old
+    partitions, `to` the one of the new partitions. Only the elements, whose
+    device changed, are copied. The copy synchronizes all devices.
+    \sa KernelLaunch::repartition
+*/
+unique_ptr<MemCpyDtoD>
+DepResolution::createMigration(MEdeviceptr ptr, const ArgAccess& from,
+                               const ArgAccess& to,
+                               shared_ptr<const bsp_ArgType> type,
+                               shared_ptr<AliasHandle> aliasH) {
+	shared_ptr<const vector<MemSubCopy>> pattern(
+		new vector<MemSubCopy>(memCpyIntersections(from, to, type)));
+	return unique_ptr<MemCpyDtoD>(new MemCpyDtoD(ptr, pattern, aliasH, true));
+}
+
 /*! \brief Creates the mem copies out of the accessed indices
 
      Example: you have two GPUs and kernel launch `master` writes
@@ -108,10 +193,15 @@ const vector<unique_ptr<MemCpyDtoD>>& DepResolution::getMemCpys() const {
      object describes which _indices_ are read and written. This
      function calculates the intersection of the indices and creates
      the appropriate `MemSubCopy` objects.
+     Elements, which the master wrote on the slave's GPU as well, are up
+     to date there and not copied. Thus partitions, which overlap and
+     compute the overlap redundantly, exchange only the rest, and every
+     element is copied at most once per slave GPU.
      \param type is necessary, because we have to transfer the indices
             to accessed Bytes. Thus we need to know the size of one
             array element.
      \sa ArgAccess::intersectIntervals
+     \sa KernelLaunch::getBlockingPhase
      \sa Mekong::MemSubCopy
 */
 vector<MemSubCopy>
@@ -122,13 +212,23 @@ DepResolution::memCpyIntersections(const ArgAccess& master,
 	const auto& mMap = master.getMap();
 	const auto& sMap = slave.getMap();
 	for (auto sit = sMap.begin(); sit != sMap.end(); ++sit) {
+		// sorted by start, grows with every copy to this gpu
+		vector<tuple<size_t, size_t>> covered;
+		auto own = mMap.find(sit->first);
+		if (own != mMap.end()) {
+			covered = own->second;
+			sort(covered.begin(), covered.end());
+		}
 		for (auto mit = mMap.begin(); mit != mMap.end(); ++mit) {
 			if (mit->first != sit->first) { // if gpus are not equal
 				for (const auto& sRange : sit->second) {
 					for (const auto& mRange : mit->second) {
 						auto isect = ArgAccess::intersectIntervals(sRange, mRange);
 						// if intersection is not range is not null
-						if (get<0>(isect) != 0 || get<1>(isect) != 0) {
+						if (get<0>(isect) == 0 && get<1>(isect) == 0) {
+							continue;
+						}
+						for (const auto& piece : ArgAccess::subtractIntervals(isect, covered)) {
 							// TODO optimize the construction of
 							// mem sub copy objects
 							MemSubCopy subcpy;
@@ -136,11 +236,13 @@ DepResolution::memCpyIntersections(const ArgAccess& master,
 							subcpy.dst  = sit->first;
 							// as we do no reshaping yet we have the same start
 							// position on both arrays
-							subcpy.from = type->getElSize() * get<0>(isect);
-							subcpy.to   = type->getElSize() * get<0>(isect);
-							subcpy.size = (get<1>(isect) - get<0>(isect))
+							subcpy.from = type->getElSize() * get<0>(piece);
+							subcpy.to   = type->getElSize() * get<0>(piece);
+							subcpy.size = (get<1>(piece) - get<0>(piece))
 							              * type->getElSize();
 							res.push_back(move(subcpy));
+							covered.insert(upper_bound(covered.begin(), covered.end(), piece),
+							               piece);
 						}
 					}
 				}
@@ -5,6 +5,7 @@
 #include "memory_copy.h"
 #include "mekong-cuda.h"
 #include "alias_handle.h"
+#include "halo_exchange.h"
 
 #include <stdexcept>
 #include <memory>
@@ -24,8 +25,8 @@ class DepResolution {
 		MEresult exec();
 		MEresult syncWithMaster() const;
 
-		bool isResolutionOf(shared_ptr<KernelLaunch> master,
-		                    shared_ptr<KernelLaunch> slave) const;
+		bool isResolutionOf(const shared_ptr<KernelLaunch>& master,
+		                    const shared_ptr<KernelLaunch>& slave) const;
 		bool isEmpty() const;
 		shared_ptr<KernelLaunch> getMaster() const;
 		shared_ptr<KernelLaunch> getSlave() const;
@@ -33,6 +34,11 @@ class DepResolution {
 		size_t getExecs() const;
 		const vector<unique_ptr<MemCpyDtoD>>& getMemCpys() const;
 
+		static void setHaloPacking(bool enable);
+		static unique_ptr<MemCpyDtoD>
+		createMigration(MEdeviceptr ptr, const ArgAccess& from,
+		                const ArgAccess& to, shared_ptr<const bsp_ArgType> type,
+		                shared_ptr<AliasHandle> aliasH);
 
 	private:
 
@@ -57,6 +63,14 @@ class DepResolution {
 		// different device ptrs
 		const vector<unique_ptr<MemCpyDtoD>> memcpys_;
 		vector<unique_ptr<MemCpyDtoD>> initMemcpys() const;
+		vector<MEcontext> getInvolvedCtx() const;
+		bool isLocal() const;
+		//! nothing to copy and nothing to wait for \sa isLocal
+		const bool local_ = false;
+
+		//! created on the first execution, if halo packing is enabled
+		unique_ptr<HaloExchange> haloExchange_;
+		static bool haloPacking_;
 };
 
 ostream& operator<<(ostream& out, const DepResolution& depRes); 
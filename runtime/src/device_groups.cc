@@ -0,0 +1,150 @@
+#include "device_groups.h"
+#include "partition.h"
+
+#include <vector>
+#include <map>
+#include <set>
+#include <ostream>
+#include <stdexcept>
+#include <numeric> // std::iota
+
+namespace Mekong {
+
+using namespace std;
+
+DeviceGroups::DeviceGroups(unsigned short numDev)
+		: numDev_(numDev) {
+	if (numDev == 0) {
+		throw invalid_argument("SPACE Mekong, CLASS DeviceGroups, FUNC "
+		                       "DeviceGroups(): need at least one device");
+	}
+}
+
+/*! \brief Adds a new kernel launch and assigns the devices to the groups
+           again.
+
+    A new launch starts on all devices \sa KernelLaunch::setPartitions.
+    \param cost expected costs of one execution, e.g. the number of threads
+    \return ids of the launches, whose device range changed, including
+            `id`, if its group does not get all devices
+*/
+vector<unsigned> DeviceGroups::addLaunch(unsigned id,
+                                         const vector<MEdeviceptr>& reads,
+                                         const vector<MEdeviceptr>& writes,
+                                         double cost) {
+	Launch launch;
+	launch.id = id;
+	launch.buffers = reads;
+	launch.buffers.insert(launch.buffers.end(), writes.begin(), writes.end());
+	launch.writes = writes;
+	launch.cost = cost;
+	launches_.push_back(move(launch));
+
+	map<unsigned, Range> old = move(ranges_);
+	old[id] = { 0, numDev_ };
+	assign();
+
+	vector<unsigned> res;
+	for (const auto& l : launches_) {
+		const Range& a = old.at(l.id);
+		const Range& b = ranges_.at(l.id);
+		if (a.first != b.first || a.count != b.count) {
+			res.push_back(l.id);
+		}
+	}
+	return res;
+}
+
+//! Devices of the group of launch `id` \throw out_of_range for unknown ids
+DeviceGroups::Range DeviceGroups::getRange(unsigned id) const {
+	return ranges_.at(id);
+}
+
+size_t DeviceGroups::getNumGroups() const {
+	return numGroups_;
+}
+
+unsigned short DeviceGroups::getNumDev() const {
+	return numDev_;
+}
+
+//! Finds the groups of all launches and splits the devices between them
+void DeviceGroups::assign() {
+	set<MEdeviceptr> written;
+	for (const auto& l : launches_) {
+		written.insert(l.writes.begin(), l.writes.end());
+	}
+
+	// union find over the launches, connected by written buffers
+	vector<size_t> parent(launches_.size());
+	iota(parent.begin(), parent.end(), 0);
+	auto find = [&parent] (size_t i) {
+		while (parent[i] != i) {
+			i = parent[i] = parent[parent[i]];
+		}
+		return i;
+	};
+	map<MEdeviceptr, size_t> firstUser;
+	for (size_t i = 0; i < launches_.size(); ++i) {
+		for (auto ptr : launches_[i].buffers) {
+			if (written.count(ptr) == 0) {
+				continue;
+			}
+			auto it = firstUser.find(ptr);
+			if (it == firstUser.end()) {
+				firstUser[ptr] = i;
+			}
+			else {
+				parent[find(i)] = find(it->second);
+			}
+		}
+	}
+
+	// groups in order of their first launch
+	map<size_t, size_t> root2group;
+	vector<size_t> groupOf(launches_.size());
+	vector<double> costs;
+	for (size_t i = 0; i < launches_.size(); ++i) {
+		size_t root = find(i);
+		auto it = root2group.find(root);
+		if (it == root2group.end()) {
+			it = root2group.emplace(root, costs.size()).first;
+			costs.push_back(0);
+		}
+		groupOf[i] = it->second;
+		costs[it->second] += launches_[i].cost;
+	}
+	numGroups_ = costs.size();
+
+	vector<Range> groupRanges(numGroups_);
+	if (numGroups_ <= numDev_) {
+		// every group gets at least one device
+		for (auto& c : costs) {
+			c = c > 0 ? c : 1;
+		}
+		vector<unsigned> counts = Partition::splitWeighted(numDev_, numGroups_, costs);
+		unsigned short first = 0;
+		for (size_t g = 0; g < numGroups_; ++g) {
+			groupRanges[g] = { first, (unsigned short) counts[g] };
+			first += counts[g];
+		}
+	}
+	else {
+		for (size_t g = 0; g < numGroups_; ++g) {
+			groupRanges[g] = { (unsigned short) (g % numDev_), 1 };
+		}
+	}
+
+	ranges_.clear();
+	for (size_t i = 0; i < launches_.size(); ++i) {
+		ranges_[launches_[i].id] = groupRanges[groupOf[i]];
+	}
+}
+
+ostream& operator<<(ostream& out, const DeviceGroups& groups) {
+	out << "DeviceGroups(" << groups.getNumGroups() << " groups on "
+	    << groups.getNumDev() << " devices)";
+	return out;
+}
+
+}; // namespace end
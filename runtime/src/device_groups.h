@@ -0,0 +1,73 @@
+/*! \file device_groups.h
+    \brief Assigns independent kernel launches to disjoint device groups.
+*/
+
+#ifndef MEKONG_DEVICE_GROUPS_H
+#define MEKONG_DEVICE_GROUPS_H
+
+#include <vector>
+#include <map>
+#include <ostream>
+
+#include "mekong-cuda.h"
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Splits the devices between independent groups of kernel launches.
+
+    Kernels, which do not scale to all devices, e.g. the separate components
+    of a solver, run side by side on disjoint device groups instead of one
+    after another on all devices. Two launches belong to the same group, if
+    they access a common buffer and at least one launch writes it. Buffers,
+    which are only read, are broadcast to all devices, thus they do not
+    connect launches.
+
+    Every group gets a contiguous range of devices proportional to its
+    expected costs, the threads of all its launches. Groups keep their
+    order of appearance, thus the first group starts at device 0. If a new
+    launch connects two groups, they are merged. Their data moves to the
+    devices of the merged group like after a re-partitioning. If there are
+    more groups than devices, the groups share the devices round robin.
+    \sa KernelLaunch::setDeviceRange
+*/
+class DeviceGroups {
+	public:
+		//! Contiguous range of devices
+		struct Range {
+			unsigned short first;
+			unsigned short count;
+		};
+
+		DeviceGroups(unsigned short numDev);
+
+		vector<unsigned> addLaunch(unsigned id,
+		                           const vector<MEdeviceptr>& reads,
+		                           const vector<MEdeviceptr>& writes,
+		                           double cost);
+		Range getRange(unsigned id) const;
+		size_t getNumGroups() const;
+		unsigned short getNumDev() const;
+
+	private:
+		struct Launch {
+			unsigned id;
+			vector<MEdeviceptr> buffers; ///< read and written buffers
+			vector<MEdeviceptr> writes;
+			double cost;
+		};
+
+		void assign();
+
+		unsigned short numDev_;
+		vector<Launch> launches_;   ///< in order of appearance
+		map<unsigned, Range> ranges_; ///< launch id -> devices of its group
+		size_t numGroups_ = 0;
+};
+
+ostream& operator<<(ostream& out, const DeviceGroups& groups);
+
+}; // namespace end
+
+#endif
@@ -0,0 +1,351 @@
+#include "halo_exchange.h"
+#include "mekong-cuda.h"
+#include "alias_handle.h"
+#include "memory_copy.h"
+#include "copy_plan.h"
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+namespace Mekong {
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+using Duration = chrono::duration<double>;
+
+/*! \brief Generic gather and scatter kernel.
+
+    mekong_copy_segments(const Segment* table, uint64_t num) copies segment
+    blockIdx.x of the table, every thread copies every blockDim.x-th word.
+    If the addresses and the size of a segment are not multiples of four,
+    it copies Bytes instead. The kernel is compiled by the driver for every
+    device, as it is loaded from PTX.
+*/
+static const char* MEKONG_segmentCopyPTX = R"(
+.version 4.3
+.target sm_30
+.address_size 64
+
+.visible .entry mekong_copy_segments(
+	.param .u64 mekong_copy_segments_param_0,
+	.param .u64 mekong_copy_segments_param_1
+)
+{
+	.reg .pred 	%p<4>;
+	.reg .b32 	%r<6>;
+	.reg .b64 	%rd<18>;
+
+	ld.param.u64 	%rd1, [mekong_copy_segments_param_0];
+	ld.param.u64 	%rd2, [mekong_copy_segments_param_1];
+	mov.u32 	%r1, %ctaid.x;
+	cvt.u64.u32 	%rd3, %r1;
+	setp.ge.u64 	%p1, %rd3, %rd2;
+	@%p1 bra 	DONE;
+	cvta.to.global.u64 	%rd4, %rd1;
+	mul.lo.s64 	%rd5, %rd3, 24;
+	add.s64 	%rd6, %rd4, %rd5;
+	ld.global.u64 	%rd7, [%rd6];
+	ld.global.u64 	%rd8, [%rd6+8];
+	ld.global.u64 	%rd9, [%rd6+16];
+	cvta.to.global.u64 	%rd7, %rd7;
+	cvta.to.global.u64 	%rd8, %rd8;
+	mov.u32 	%r2, %tid.x;
+	cvt.u64.u32 	%rd10, %r2;
+	mov.u32 	%r3, %ntid.x;
+	cvt.u64.u32 	%rd11, %r3;
+	or.b64 	%rd12, %rd7, %rd8;
+	or.b64 	%rd12, %rd12, %rd9;
+	and.b64 	%rd12, %rd12, 3;
+	setp.ne.s64 	%p2, %rd12, 0;
+	@%p2 bra 	BYTES;
+	shl.b64 	%rd13, %rd10, 2;
+	shl.b64 	%rd14, %rd11, 2;
+WORDS:
+	setp.ge.u64 	%p3, %rd13, %rd9;
+	@%p3 bra 	DONE;
+	add.s64 	%rd15, %rd7, %rd13;
+	ld.global.u32 	%r4, [%rd15];
+	add.s64 	%rd16, %rd8, %rd13;
+	st.global.u32 	[%rd16], %r4;
+	add.s64 	%rd13, %rd13, %rd14;
+	bra.uni 	WORDS;
+BYTES:
+	setp.ge.u64 	%p3, %rd10, %rd9;
+	@%p3 bra 	DONE;
+	add.s64 	%rd15, %rd7, %rd10;
+	ld.global.u8 	%r5, [%rd15];
+	add.s64 	%rd16, %rd8, %rd10;
+	st.global.u8 	[%rd16], %r5;
+	add.s64 	%rd10, %rd10, %rd11;
+	bra.uni 	BYTES;
+DONE:
+	ret;
+}
+)";
+
+//! Threads per block of the segment copy kernel
+static const unsigned MEKONG_segmentCopyThreads = 128;
+
+//! The segment copy kernel of every context, loaded on first use
+static map<MEcontext, MEfunction> MEKONG_segmentCopyKernels;
+
+HaloExchange::CostModel HaloExchange::model_;
+
+HaloExchange::HaloExchange(const vector<unique_ptr<MemCpyDtoD>>& memcpys,
+                           shared_ptr<AliasHandle> aliasH)
+		: memcpys_(memcpys),
+		  aliasH_(aliasH) {}
+
+//! Frees the staging buffers, errors are ignored
+HaloExchange::~HaloExchange() {
+	release();
+}
+
+/*! \brief Gathers, copies and scatters the packed pairs and executes the
+           direct copies of all other pairs.
+
+    The copies are asynchronous. The caller has to synchronize all devices
+    afterwards, like it does after the direct copies.
+*/
+MEresult HaloExchange::exec() {
+	auto time_exec_begin = Clock::now();
+	MEresult res;
+
+	// the tables contain absolute addresses
+	if (built_ && getBasePtrs() != basePtrs_) {
+		res &= release();
+	}
+	if (!built_) {
+		res &= build();
+		if (!res.isSuccess()) {
+			return res;
+		}
+	}
+
+	const auto& ctxs = aliasH_->getCtx();
+	// pack and move the staging buffers, the copy is ordered after the
+	// gather kernel by the stream
+	for (auto& p : pairs_) {
+		res &= meCtxPushCurrent(ctxs.at(p.src));
+		res &= launchSegmentCopy(ctxs.at(p.src), p.gatherTable, p.gather.size());
+		res &= meMemcpyDtoDAsync(p.dstStaging, p.srcStaging, p.bytes, 0);
+		res &= meEventRecord(p.copied, 0);
+		res &= meCtxPopCurrent(nullptr);
+	}
+	// the direct copies overlap with the packed ones
+	for (size_t i = 0; i < memcpys_.size(); ++i) {
+		if (!direct_[i].isEmpty()) {
+			res &= direct_[i].exec(CopyBuffer::onDevice(memcpys_[i]->getDst()),
+			                       CopyBuffer::onDevice(memcpys_[i]->getSrc()),
+			                       *aliasH_, false);
+		}
+	}
+	// unpack as soon as the staging buffer arrived
+	for (auto& p : pairs_) {
+		res &= meCtxPushCurrent(ctxs.at(p.dst));
+		res &= meStreamWaitEvent(0, p.copied);
+		res &= launchSegmentCopy(ctxs.at(p.dst), p.scatterTable, p.scatter.size());
+		res &= meCtxPopCurrent(nullptr);
+	}
+
+	Duration time_exec = Clock::now() - time_exec_begin;
+	for (const auto& memcpy : memcpys_) {
+		memcpy->markExecuted(time_exec.count() / memcpys_.size());
+	}
+	return res;
+}
+
+//! Number of device pairs, which are packed
+size_t HaloExchange::getNumPackedPairs() const {
+	return pairs_.size();
+}
+
+/*! \brief Compares the direct copies of a device pair with the packed ones.
+
+    The direct copies cost one latency per copy. Packing costs two kernel
+    launches and one copy, and the kernels read and write every Byte twice
+    in device memory. Both transfer the same Bytes over the link.
+    \param numOps number of direct copies of the device pair
+    \param bytes number of Bytes of the direct copies
+*/
+bool HaloExchange::isPackingCheaper(size_t numOps, size_t bytes,
+                                    const CostModel& model) {
+	if (numOps < 2) {
+		return false;
+	}
+	double transfer = bytes / model.linkBW;
+	double direct = numOps * model.copyLatency + transfer;
+	double packed = 2 * model.launchLatency + model.copyLatency + transfer
+	              + 4 * bytes / model.devBW;
+	return packed < direct;
+}
+
+//! Sets the cost model of all halo exchanges built afterwards
+void HaloExchange::setCostModel(const CostModel& model) {
+	model_ = model;
+}
+
+const HaloExchange::CostModel& HaloExchange::getCostModel() {
+	return model_;
+}
+
+/*! \brief Decides for every device pair, creates the tables and allocates the
+           staging buffers.
+*/
+MEresult HaloExchange::build() {
+	MEresult res;
+	pairs_.clear();
+	direct_.clear();
+	basePtrs_ = getBasePtrs();
+
+	// number of ops and Bytes of every device pair
+	map<pair<int, int>, pair<size_t, size_t>> pairStats;
+	for (const auto& memcpy : memcpys_) {
+		for (const auto& op : memcpy->getPlan()->getOps()) {
+			auto& stats = pairStats[make_pair(op.src, op.dst)];
+			++stats.first;
+			stats.second += op.getBytes();
+		}
+	}
+	map<pair<int, int>, size_t> packedIds;
+	for (const auto& stats : pairStats) {
+		if (isPackingCheaper(stats.second.first, stats.second.second, model_)) {
+			packedIds[stats.first] = pairs_.size();
+			pairs_.emplace_back();
+			pairs_.back().src = stats.first.first;
+			pairs_.back().dst = stats.first.second;
+		}
+	}
+
+	// one segment per row, the staging offsets are relative until the
+	// staging buffers exist
+	for (const auto& memcpy : memcpys_) {
+		const vector<MEdeviceptr>& aliases = (*aliasH_)[memcpy->getDst()];
+		CopyPlan direct;
+		for (const auto& op : memcpy->getPlan()->getOps()) {
+			auto it = packedIds.find(make_pair(op.src, op.dst));
+			if (it == packedIds.end()) {
+				direct.add(op);
+				continue;
+			}
+			PackedPair& p = pairs_[it->second];
+			for (size_t row = 0; row < op.rows; ++row) {
+				// aligned, thus the kernel can copy words
+				uint64_t offset = (p.bytes + 7) & ~(size_t) 7;
+				p.gather.push_back({ aliases.at(op.src) + op.srcOff + row * op.srcPitch,
+				                     offset, op.size });
+				p.scatter.push_back({ offset,
+				                      aliases.at(op.dst) + op.dstOff + row * op.dstPitch,
+				                      op.size });
+				p.bytes = offset + op.size;
+			}
+		}
+		direct_.push_back(move(direct));
+	}
+
+	const auto& ctxs = aliasH_->getCtx();
+	for (auto& p : pairs_) {
+		res &= meCtxPushCurrent(ctxs.at(p.src));
+		res &= meMemAlloc(&p.srcStaging, p.bytes);
+		res &= meMemAlloc(&p.gatherTable, p.gather.size() * sizeof(Segment));
+		for (auto& seg : p.gather) {
+			seg.dst += p.srcStaging;
+		}
+		res &= meMemcpyHtoD(p.gatherTable, p.gather.data(),
+		                    p.gather.size() * sizeof(Segment));
+		res &= meEventCreate(&p.copied);
+		res &= meCtxPopCurrent(nullptr);
+
+		res &= meCtxPushCurrent(ctxs.at(p.dst));
+		res &= meMemAlloc(&p.dstStaging, p.bytes);
+		res &= meMemAlloc(&p.scatterTable, p.scatter.size() * sizeof(Segment));
+		for (auto& seg : p.scatter) {
+			seg.src += p.dstStaging;
+		}
+		res &= meMemcpyHtoD(p.scatterTable, p.scatter.data(),
+		                    p.scatter.size() * sizeof(Segment));
+		res &= meCtxPopCurrent(nullptr);
+	}
+	built_ = true;
+	if (!res.isSuccess()) {
+		release();
+	}
+	return res;
+}
+
+//! Frees the staging buffers and tables of all packed pairs
+MEresult HaloExchange::release() {
+	MEresult res;
+	const auto& ctxs = aliasH_->getCtx();
+	for (auto& p : pairs_) {
+		res &= meCtxPushCurrent(ctxs.at(p.src));
+		if (p.srcStaging) {
+			res &= meMemFree(p.srcStaging);
+		}
+		if (p.gatherTable) {
+			res &= meMemFree(p.gatherTable);
+		}
+		if (p.copied) {
+			res &= meEventDestroy(p.copied);
+		}
+		res &= meCtxPopCurrent(nullptr);
+		res &= meCtxPushCurrent(ctxs.at(p.dst));
+		if (p.dstStaging) {
+			res &= meMemFree(p.dstStaging);
+		}
+		if (p.scatterTable) {
+			res &= meMemFree(p.scatterTable);
+		}
+		res &= meCtxPopCurrent(nullptr);
+	}
+	pairs_.clear();
+	direct_.clear();
+	built_ = false;
+	return res;
+}
+
+//! The device pointers of all buffers on all devices
+vector<MEdeviceptr> HaloExchange::getBasePtrs() const {
+	vector<MEdeviceptr> res;
+	for (const auto& memcpy : memcpys_) {
+		const vector<MEdeviceptr>& aliases = (*aliasH_)[memcpy->getDst()];
+		res.insert(res.end(), aliases.begin(), aliases.end());
+	}
+	return res;
+}
+
+/*! \brief Launches the segment copy kernel on the default stream of `ctx`.
+
+    The context must be current. One block copies one segment.
+*/
+MEresult HaloExchange::launchSegmentCopy(MEcontext ctx, MEdeviceptr table,
+                                         size_t numSegments) {
+	MEresult res;
+	if (numSegments == 0) {
+		return res;
+	}
+	auto it = MEKONG_segmentCopyKernels.find(ctx);
+	if (it == MEKONG_segmentCopyKernels.end()) {
+		MEmodule module;
+		MEfunction func;
+		res &= meModuleLoadData(&module, MEKONG_segmentCopyPTX);
+		res &= meModuleGetFunction(&func, module, "mekong_copy_segments");
+		if (!res.isSuccess()) {
+			return res;
+		}
+		it = MEKONG_segmentCopyKernels.insert(make_pair(ctx, func)).first;
+	}
+	uint64_t tableArg = table;
+	uint64_t numArg = numSegments;
+	void* args[] = { &tableArg, &numArg };
+	res &= meLaunchKernel(it->second, numSegments, 1, 1,
+	                      MEKONG_segmentCopyThreads, 1, 1, 0, 0, args, nullptr);
+	return res;
+}
+
+}; // namespace end
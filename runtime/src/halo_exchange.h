@@ -0,0 +1,105 @@
+/*! \file halo_exchange.h
+    \brief Packs the halos of several device to device copies per device pair.
+*/
+
+#ifndef MEKONG_HALO_EXCHANGE_H
+#define MEKONG_HALO_EXCHANGE_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "mekong-cuda.h"
+#include "alias_handle.h"
+#include "memory_copy.h"
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Exchanges the halos of several DtoD copies at once.
+
+    A kernel split along a dimension orthogonal to the memory layout, or a
+    kernel with many small halos on several buffers, needs a lot of tiny
+    copies between the same two devices. Every copy costs a fixed latency,
+    which dominates the exchange. For such a device pair the exchange runs
+    a gather kernel on the source device, which packs every halo element of
+    all buffers into one contiguous staging buffer, copies the staging
+    buffer with one copy and runs a scatter kernel on the destination
+    device, which unpacks it. Both kernels are one generic segment copy
+    kernel, which reads a table of (source, destination, size) segments.
+
+    The cost model decides per device pair, whether packing is cheaper than
+    the direct copies. The pairs, which are not packed, execute the copy
+    plans of their memcpys as usual.
+    \sa CopyPlan
+*/
+class HaloExchange {
+	public:
+		//! Estimated costs of the hardware, times in seconds, bandwidths in Byte/s
+		struct CostModel {
+			double copyLatency = 10e-6;  ///< fixed costs of one submitted copy
+			double launchLatency = 5e-6; ///< fixed costs of one kernel launch
+			double linkBW = 10e9;        ///< bandwidth between two devices
+			double devBW = 200e9;        ///< bandwidth of the device memory
+		};
+
+		HaloExchange(const vector<unique_ptr<MemCpyDtoD>>& memcpys,
+		             shared_ptr<AliasHandle> aliasH);
+		~HaloExchange();
+
+		HaloExchange(const HaloExchange&) = delete;
+		HaloExchange& operator=(const HaloExchange&) = delete;
+
+		MEresult exec();
+
+		size_t getNumPackedPairs() const;
+
+		static bool isPackingCheaper(size_t numOps, size_t bytes,
+		                             const CostModel& model);
+		static void setCostModel(const CostModel& model);
+		static const CostModel& getCostModel();
+
+	private:
+		//! Table entry of the segment copy kernel, absolute device addresses
+		struct Segment {
+			uint64_t src;
+			uint64_t dst;
+			uint64_t size;
+		};
+
+		//! A device pair, whose copies are packed into one staging buffer
+		struct PackedPair {
+			int src;
+			int dst;
+			size_t bytes = 0;           ///< size of the staging buffers
+			vector<Segment> gather;     ///< buffers -> srcStaging, on src
+			vector<Segment> scatter;    ///< dstStaging -> buffers, on dst
+			MEdeviceptr srcStaging = 0;
+			MEdeviceptr dstStaging = 0;
+			MEdeviceptr gatherTable = 0;
+			MEdeviceptr scatterTable = 0;
+			MEevent copied = nullptr;   ///< recorded after the staging copy
+		};
+
+		MEresult build();
+		MEresult release();
+		vector<MEdeviceptr> getBasePtrs() const;
+
+		static MEresult launchSegmentCopy(MEcontext ctx, MEdeviceptr table,
+		                                  size_t numSegments);
+
+		const vector<unique_ptr<MemCpyDtoD>>& memcpys_;
+		shared_ptr<AliasHandle> aliasH_;
+		vector<PackedPair> pairs_;
+		vector<CopyPlan> direct_;       ///< unpacked ops, one plan per memcpy
+		vector<MEdeviceptr> basePtrs_;  ///< aliases, the tables were built for
+		bool built_ = false;
+
+		static CostModel model_;
+};
+
+}; // namespace end
+
+#endif
@@ -0,0 +1,60 @@
+#include "isl_context.h"
+
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+#include <isl/ctx.h>
+#include <isl/set.h>
+#include <isl/union_map.h>
+
+namespace Mekong {
+
+using namespace std;
+
+IslContext::IslContext() : ctx_(isl_ctx_alloc()) {}
+
+//! Frees all templates before the context, otherwise isl complains
+IslContext::~IslContext() {
+	for (auto& entry : templates_) {
+		isl_union_map_free(entry.second.map);
+		isl_set_free(entry.second.params);
+	}
+	isl_ctx_free(ctx_);
+}
+
+//! Returns the context of the calling thread, which is created on first use
+IslContext& IslContext::get() {
+	static thread_local IslContext context;
+	return context;
+}
+
+isl_ctx* IslContext::getCtx() const {
+	return ctx_;
+}
+
+//! Returns nullptr if there is no template for `key`
+const IslContext::Template* IslContext::getTemplate(uint64_t key) const {
+	auto it = templates_.find(key);
+	if (it == templates_.end()) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+//! Stores `map`, which must belong to this context, as template for `key`
+const IslContext::Template* IslContext::addTemplate(uint64_t key,
+                                                    __isl_take isl_union_map* map) {
+	Template t;
+	t.map = map;
+	t.params = isl_union_map_params(isl_union_map_copy(map));
+	t.numParams = isl_set_dim(t.params, isl_dim_param);
+	auto res = templates_.insert(make_pair(key, t));
+	if (!res.second) { // keep the template we already have
+		isl_union_map_free(t.map);
+		isl_set_free(t.params);
+	}
+	return &res.first->second;
+}
+
+}; // namespace end
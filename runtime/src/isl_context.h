@@ -0,0 +1,56 @@
+/*! \file isl_context.h
+    \brief Long living isl contexts, one per thread.
+*/
+
+#ifndef MEKONG_ISL_CONTEXT_H
+#define MEKONG_ISL_CONTEXT_H
+
+#include <unordered_map>
+#include <cstdint>
+
+#include <isl/ctx.h>
+#include <isl/set.h>
+#include <isl/union_map.h>
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Owns the isl_ctx of the calling thread and the maps parsed in it.
+
+    isl objects must not be shared between threads, thus every thread, which
+    calculates accesses, needs its own isl_ctx. Allocating a context and
+    parsing the access maps for every calculation is expensive, so the
+    context lives as long as its thread and keeps parsed maps as templates.
+    The templates are identified by a key chosen by the user (\sa AccFunc)
+    and are freed together with the context when the thread exits.
+*/
+class IslContext {
+	public:
+		//! A parsed map together with the set of its space parameters
+		struct Template {
+			isl_union_map* map;
+			isl_set* params;
+			int numParams;
+		};
+
+		static IslContext& get();
+		~IslContext();
+
+		IslContext(const IslContext&) = delete;
+		IslContext& operator=(const IslContext&) = delete;
+
+		isl_ctx* getCtx() const;
+		const Template* getTemplate(uint64_t key) const;
+		const Template* addTemplate(uint64_t key, __isl_take isl_union_map* map);
+
+	private:
+		IslContext();
+
+		isl_ctx* ctx_;
+		unordered_map<uint64_t, Template> templates_;
+};
+
+}; // namespace end
+
+#endif
@@ -29,53 +29,49 @@ bsp_KernelInfo::createKInfos(const char* bspAnalysis) {
 	// PARSE THE DASHDB STRING
 	dashdb::Butler b;
 	b.read(bspAnalysis);
+	// the cursors resolve the key prefixes only once
+	dashdb::Butler::Cursor kernels = b.root()["kernels"];
 
 	vector<shared_ptr<const bsp_KernelInfo>> res;
 	// as we only want to create argument type and
 	// partitioning objects once, we need the following maps
 	map<string, shared_ptr<const Partitioning>> parts;
-	for (int kernelNr = 0; kernelNr < b["kernels"].len(); ++kernelNr) {
-		
+	for (int kernelNr = 0; kernelNr < kernels.len(); ++kernelNr) {
+		dashdb::Butler::Cursor kernel = kernels[kernelNr];
+		dashdb::Butler::Cursor args = kernel["arguments"];
+
 		// GET ACTUAL KERNEL NAME
-		string name = b["kernels"][kernelNr]["name"].asString();
+		string name = kernel["name"].asString();
 
 		// COLLECT KERNEL ARGUMENT TYPE OBJECTS
 		vector<shared_ptr<const bsp_ArgType>> thisArgs;
-		for (int argNr = 0; argNr < b["kernels"][kernelNr]["arguments"].len(); ++argNr) {
-			string argt_name = b["kernels"][kernelNr]["arguments"][argNr]["type name"].asString();
-			unsigned argt_ptrlevel = b["kernels"][kernelNr]["arguments"][argNr]["pointer level"].asInt();
-			string argt_fundT = b["kernels"][kernelNr]["arguments"][argNr]["fundamental type"].asString();
-
-			// Read the size of the argument type and convert it to Bytes
-			unsigned argt_size = b["kernels"][kernelNr]["arguments"][argNr]["size"].asInt() / 8;
-			// if the we have a pointer type LLVM's function
-			// 'getPrimitiveSizeInBits()' returns a size of zero.
-			// Thus we set the size to the default pointer size of
-			// the system.
-			argt_size = argt_size == 0 && argt_ptrlevel == 1 ?
-			            sizeof(void*) : argt_size;
-			// Read the size of the pointed type and convert it to Bytes
-			unsigned argt_elsize = b["kernels"][kernelNr]["arguments"][argNr]["element size"].asInt() / 8;
-			bool argt_isModified = !b["kernels"][kernelNr]["arguments"][argNr]["isl write map"].asString().empty();
-			bool argt_isRead = !b["kernels"][kernelNr]["arguments"][argNr]["isl read map"].asString().empty();
+		for (int argNr = 0; argNr < args.len(); ++argNr) {
+			dashdb::Butler::Cursor arg = args[argNr];
+			string argt_name = arg["type name"].asString();
+			unsigned argt_ptrlevel = arg["pointer level"].asInt();
+			string argt_fundT = arg["fundamental type"].asString();
+
+			unsigned argt_sizeBits = arg["size"].asInt();
+			unsigned argt_elsizeBits = arg["element size"].asInt();
+			bool argt_isModified = !arg["isl write map"].asView().empty();
+			bool argt_isRead = !arg["isl read map"].asView().empty();
 
 			// Get the number of array dimensions with 0 as alternative value
 			// e.g. if there is no entry in the database
-			unsigned argt_numDims = b["kernels"][kernelNr]["arguments"][argNr]["num dimensions"].asInt(0);
+			unsigned argt_numDims = arg["num dimensions"].asInt(0);
 			vector<string> dimSizePatterns;
-			int dsp_size = b["kernels"][kernelNr]["arguments"][argNr]["dim sizes"].len();
+			int dsp_size = arg["dim sizes"].len();
 			for (int dsp = 0; dsp < dsp_size; ++dsp) {
-				dimSizePatterns.push_back(b["kernels"][kernelNr]["arguments"][argNr]["dim sizes"][dsp].asString());
+				dimSizePatterns.push_back(arg["dim sizes"][dsp].asString());
 			}
-			thisArgs.emplace_back(shared_ptr<const bsp_ArgType>(
-					 new bsp_ArgType(argt_name, argt_ptrlevel,
-					                 argt_fundT[0], argt_size,
-					                 argt_elsize, argt_isModified,
-					                 argt_isRead, argt_numDims,
-					                 dimSizePatterns)));
+			thisArgs.push_back(createArgType(argt_name, argt_ptrlevel,
+			                                 argt_fundT[0], argt_sizeBits,
+			                                 argt_elsizeBits, argt_isModified,
+			                                 argt_isRead, argt_numDims,
+			                                 dimSizePatterns));
 		}
 		// CREATE THE PARTITIONING OBJECT IF NECESSARY
-		const string partStr = b["kernels"][kernelNr]["partitioning"].asString();
+		const string partStr = kernel["partitioning"].asString();
 		shared_ptr<const Partitioning> thisPart = nullptr;
 
 		if (partStr.size() == 0 || partStr == "None") {
@@ -94,27 +90,28 @@ bsp_KernelInfo::createKInfos(const char* bspAnalysis) {
 
 		// CREATE ACCESS FUNCTIONS
 		vector<shared_ptr<const AccFunc>> accFuncs;
-		for (int argNr = 0; argNr < b["kernels"][kernelNr]["arguments"].len(); ++argNr) {
+		for (int argNr = 0; argNr < args.len(); ++argNr) {
+			dashdb::Butler::Cursor arg = args[argNr];
 			vector<shared_ptr<const string>> readParams;
-			int numIslParams = b["kernels"][kernelNr]["arguments"][argNr]["isl read params"].len();
+			int numIslParams = arg["isl read params"].len();
 			// collect isl parameter description
 			for (int islParamNr = 0; islParamNr < numIslParams; ++islParamNr) { 
-				string islParamStr = b["kernels"][kernelNr]["arguments"][argNr]["isl read params"][islParamNr].asString();
+				string islParamStr = arg["isl read params"][islParamNr].asString();
 				readParams.push_back(shared_ptr<const string>(new string(islParamStr)));
 
 			}
 
 			vector<shared_ptr<const string>> writeParams;
 			// collect isl parameter description
-			numIslParams = b["kernels"][kernelNr]["arguments"][argNr]["isl write params"].len();
+			numIslParams = arg["isl write params"].len();
 			for (int islParamNr = 0; islParamNr < numIslParams; ++islParamNr) { 
-				string islParamStr = b["kernels"][kernelNr]["arguments"][argNr]["isl write params"][islParamNr].asString();
+				string islParamStr = arg["isl write params"][islParamNr].asString();
 				writeParams.push_back(shared_ptr<const string>(new string(islParamStr)));
 			}
 
 			accFuncs.push_back(shared_ptr<const AccFunc>(
-				new AccFunc(readParams, b["kernels"][kernelNr]["arguments"][argNr]["isl read map"].asString(),
-				            writeParams, b["kernels"][kernelNr]["arguments"][argNr]["isl write map"].asString(), argNr)));
+				new AccFunc(readParams, arg["isl read map"].asString(),
+				            writeParams, arg["isl write map"].asString(), argNr)));
 		}
 		
 		// FINALLY CREATE THE KERNEL INFO OBJECT
@@ -127,6 +124,28 @@ bsp_KernelInfo::createKInfos(const char* bspAnalysis) {
 	return res;
 }
 
+/*! \brief Creates an argument type from the values of the analysis database.
+
+    The database contains the sizes in bits, the argument type gets them
+    in Bytes.
+*/
+shared_ptr<const bsp_ArgType>
+bsp_KernelInfo::createArgType(const string& name, unsigned ptrlevel,
+                              char fundT, unsigned sizeBits,
+                              unsigned elSizeBits, bool isModified,
+                              bool isRead, unsigned numDims,
+                              const vector<string>& dimSizePatterns) {
+	unsigned size = sizeBits / 8;
+	// if the we have a pointer type LLVM's function
+	// 'getPrimitiveSizeInBits()' returns a size of zero.
+	// Thus we set the size to the default pointer size of
+	// the system.
+	size = size == 0 && ptrlevel == 1 ? sizeof(void*) : size;
+	return shared_ptr<const bsp_ArgType>(
+		new bsp_ArgType(name, ptrlevel, fundT, size, elSizeBits / 8,
+		                isModified, isRead, numDims, dimSizePatterns));
+}
+
 bsp_KernelInfo::bsp_KernelInfo(const string& name,
                                const vector<shared_ptr<const bsp_ArgType>>& args,
                                shared_ptr<const Partitioning> part,
@@ -22,6 +22,11 @@ using namespace std;
 class bsp_KernelInfo {
 	public:
 		static vector<shared_ptr<const bsp_KernelInfo>> createKInfos(const char* bspAnalysis);
+		static shared_ptr<const bsp_ArgType>
+		createArgType(const string& name, unsigned ptrlevel, char fundT,
+		              unsigned sizeBits, unsigned elSizeBits, bool isModified,
+		              bool isRead, unsigned numDims,
+		              const vector<string>& dimSizePatterns);
 		bsp_KernelInfo(const string& name,
 		               const vector<shared_ptr<const bsp_ArgType>>& args,
 					   shared_ptr<const Partitioning> part,
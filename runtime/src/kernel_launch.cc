@@ -8,17 +8,22 @@
 #include "partitioning.h"
 #include "partition.h"
 #include "kernel_launch.h"
+#include "isl_context.h"
+#include "worker_pool.h"
+#include "arena.h"
 
 #include <memory>     // smart pointer
-#include <algorithm>  // std::sort
+#include <algorithm>  // std::sort, std::upper_bound
 #include <new>        // std::bad_alloc
 #include <chrono>     // time measurements
-#include <thread>     // for parallel linearization
+#include <exception>  // std::exception_ptr
+#include <mutex>      // guards the arg accesses against background threads
 #include <utility>    // std::move
 #include <limits>     // needed for overflow check
 #include <functional> // std::hash
 #include <ostream>
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include <tuple>
@@ -39,8 +44,90 @@ namespace Mekong {
 
 using namespace std;
 
+// Guards the set of all kernel launches and the cached arg accesses and
+// memcpy objects of every launch. They are also built in the background,
+// which happens without holding this mutex, only the results are published
+// under it. \sa KernelLaunch::precomputeWrittenData
+static recursive_mutex MEKONG_launchMutex;
+
+// Guards the linearization pool below. Never acquire MEKONG_launchMutex
+// while holding it.
+static mutex MEKONG_linearizationMutex;
+
+// Threads of the arg access linearization. They live as long as the process,
+// thus their IslContexts and the parsed access maps are reused by every
+// launch. The pool is never destroyed, as background tasks might still
+// calculate arg accesses during the static destruction.
+static WorkerPool* MEKONG_linearizationPool = nullptr;
+
+//! Returns a pool with at least `numThreads` threads. Needs MEKONG_linearizationMutex.
+static WorkerPool& getLinearizationPool(unsigned numThreads) {
+	if (MEKONG_linearizationPool == nullptr ||
+	    MEKONG_linearizationPool->getNumThreads() < numThreads) {
+		// the old pool is idle, as it is only used under MEKONG_linearizationMutex
+		delete MEKONG_linearizationPool;
+		MEKONG_linearizationPool = new WorkerPool(numThreads);
+	}
+	return *MEKONG_linearizationPool;
+}
+
+// Storage of all kernel launches in KernelLaunch::all and of their arg
+// accesses. Both live as long as the process, thus the arenas are never
+// destroyed, like the pool above.
+static Arena<KernelLaunch>* MEKONG_launchArena = new Arena<KernelLaunch>;
+static Arena<ArgAccess>* MEKONG_argAccessArena = new Arena<ArgAccess>;
+
+// Streams of the partitions of over-decomposed launches, one per device and
+// slot, the index of a partition among the partitions of its device. They
+// are blocking streams, thus the copies on the default stream still wait
+// for the kernels and vice versa. Shared by all launches and never
+// destroyed, like the arenas above.
+static vector<vector<MEstream>> MEKONG_partStreams;
+
+//! Returns the stream of `slot` on device `gpu`. Needs the context of `gpu`.
+static MEresult getPartStream(unsigned short gpu, unsigned slot, MEstream* stream) {
+	MEresult res;
+	if (MEKONG_partStreams.size() <= gpu) {
+		MEKONG_partStreams.resize(gpu + 1);
+	}
+	vector<MEstream>& streams = MEKONG_partStreams[gpu];
+	while (streams.size() <= slot) {
+		MEstream created = nullptr;
+		res &= meStreamCreate(&created);
+		streams.push_back(created);
+	}
+	*stream = streams[slot];
+	return res;
+}
+
+//! True if both partition vectors launch the same boxes on the same devices
+static bool isEqualSplit(const vector<shared_ptr<const Partition>>& a,
+                         const vector<shared_ptr<const Partition>>& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t partId = 0; partId < a.size(); ++partId) {
+		if (a[partId]->getGrid() != b[partId]->getGrid() ||
+		    a[partId]->getOffset() != b[partId]->getOffset() ||
+		    a[partId]->getDevice() != b[partId]->getDevice()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool KernelLaunch::balancing_ = false;
+double KernelLaunch::balanceThreshold_ = 0.1;
+unsigned KernelLaunch::balancePatience_ = 3;
+unsigned KernelLaunch::blockingDepth_ = 1;
 
 /*! \brief Avoids redundundant Object creating using a static set.
+
+    The lookup uses a launch on the stack without partitions, thus only a
+    new launch is allocated, in the launch arena, and gets partitions. Its
+    arena index becomes its id. The planner evaluates its candidates with
+    isl, which takes long, thus it runs without MEKONG_launchMutex and
+    other threads keep on launching meanwhile.
     \return the object and if it was successfully inserted
     \sa KernelLaunch::all
 */
@@ -51,17 +138,93 @@ KernelLaunch::getOrInsert(MEfunction func, const Array3& grid,
                           void** rawArgs,
                           shared_ptr<const bsp_KernelInfo> info,
                           shared_ptr<AliasHandle> aliasH) {
-	auto kl = initBare(func, grid, block, shMem, rawArgs, info);
+	KernelLaunch bare(func, grid, block, shMem, rawArgs, info);
+	// non owning pointer without control block, just for the lookup
+	shared_ptr<KernelLaunch> key(shared_ptr<KernelLaunch>(), &bare);
+	unique_lock<recursive_mutex> lock(MEKONG_launchMutex);
 
 	// add only different kernel launches
-	auto it_and_bool = all.insert(kl);
-	if (get<1>(it_and_bool)) { // element was inserted successfully
-		kl->setPartitions(aliasH); // calculate partitions
+	auto it = all.find(key);
+	if (it != all.end()) { // take already existing kernel launch object
+		return make_pair(*it, false);
+	}
+	bare.initPartitioning(aliasH);
+	pair<shared_ptr<const Partitioning>, vector<shared_ptr<const Partition>>> plan;
+	if (bare.isPlanned() && !bare.findEqualLaunch()) {
+		PartitionPlanner::CostModel model = PartitionPlanner::getCostModel();
+		lock.unlock();
+		plan = bare.planPartitions(model);
+		lock.lock();
+		// another thread might have inserted the launch meanwhile, then the
+		// transient plan is dropped
+		it = all.find(key);
+		if (it != all.end()) {
+			return make_pair(*it, false);
+		}
+	}
+	unsigned id = MEKONG_launchArena->create(move(bare));
+	auto kl = MEKONG_launchArena->share(id);
+	kl->id_ = id;
+	kl->setPartitions(plan); // calculate partitions
+	if (balancing_) {
+		kl->joinBalanceGroup();
+	}
+	all.insert(kl);
+	return make_pair(kl, true);
+}
+
+//! Returns the launch with the id `id` \sa getId
+shared_ptr<KernelLaunch> KernelLaunch::getById(unsigned id) {
+	if (id >= MEKONG_launchArena->size()) {
+		throw out_of_range("SPACE Mekong, CLASS KernelLaunch, FUNC getById(): "
+		                   "there is no kernel launch with id " + to_string(id));
 	}
-	else { // element was not inserted
-		kl = *get<0>(it_and_bool); // take already existing kernel launch object
+	return MEKONG_launchArena->share(id);
+}
+
+/*! \brief Turns the measurement-driven load balancing on or off.
+
+    Affects only launches created afterwards.
+    \sa LoadBalancer
+*/
+void KernelLaunch::setLoadBalancing(bool enable, double threshold,
+                                    unsigned patience) {
+	balancing_ = enable;
+	balanceThreshold_ = threshold;
+	balancePatience_ = patience;
+}
+
+/*! \brief Turns the temporal blocking of launches, which swap their
+           buffers, on or off.
+
+    \param maxDepth the most iterations, whose halos are exchanged at once,
+           0 or 1 turns it off
+    \sa getBlockingPhase
+*/
+void KernelLaunch::setTemporalBlocking(unsigned maxDepth) {
+	blockingDepth_ = maxDepth;
+}
+
+/*! \brief Joins the balance group of an equal launch or starts a new one.
+
+    All launches with equal arg accesses must have equal partitions, thus
+    a new member takes the current partitions of its group. Launches on
+    another device range are not members \sa DeviceGroups. Needs
+    MEKONG_launchMutex.
+*/
+void KernelLaunch::joinBalanceGroup() {
+	for (const auto& other : all) {
+		if (other->balancer_ && hasEqualArgAccess(*other) &&
+		    hasEqualDeviceRange(*other)) {
+			balancer_ = other->balancer_;
+			parts_ = other->parts_;
+			break;
+		}
+	}
+	if (!balancer_) {
+		balancer_ = make_shared<LoadBalancer>(balanceThreshold_, balancePatience_);
 	}
-	return make_pair(kl, get<1>(it_and_bool));
+	balancer_->addMember(id_);
 }
 
 KernelLaunch::KernelLaunch(MEfunction func, const Array3& grid,
@@ -77,6 +240,7 @@ KernelLaunch::KernelLaunch(MEfunction func, const Array3& grid,
 			 info_(info), 
 			 aliasH_(aliasH),
 			 args_(KernelArg::createArgs(info->getArgTypes(), rawArgs)),
+			 parting_(info->getPartitioning()),
 			 parts_(Partition::createPartitions(grid,
 			                                    block,
 			                                    aliasH,
@@ -86,7 +250,7 @@ KernelLaunch::KernelLaunch(MEfunction func, const Array3& grid,
 
 //! Checks if \param ptr is a given argument of this launch.
 bool KernelLaunch::isArg(MEdeviceptr ptr) const {
-	for (auto arg : args_) {
+	for (const auto& arg : args_) {
 		if (*arg == ptr) {
 			return true;
 		}
@@ -95,8 +259,8 @@ bool KernelLaunch::isArg(MEdeviceptr ptr) const {
 }
 
 //! Checks if \param arg is a given argument of this launch.
-bool KernelLaunch::isArg(shared_ptr<const KernelArg> arg) const {
-	for (auto thisarg : args_) {
+bool KernelLaunch::isArg(const shared_ptr<const KernelArg>& arg) const {
+	for (const auto& thisarg : args_) {
 		if (thisarg == arg) {
 			return true;
 		}
@@ -107,6 +271,33 @@ bool KernelLaunch::isArg(shared_ptr<const KernelArg> arg) const {
 	return false;
 }
 
+//! True if a device executes several partitions on own streams \sa orderPartitions
+bool KernelLaunch::hasConcurrentPartitions() const {
+	set<int> devs;
+	for (const auto& part : parts_) {
+		if (!devs.insert(part->getDevice()).second) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//! True if both launches run on the same devices \sa setDeviceRange
+bool KernelLaunch::hasEqualDeviceRange(const KernelLaunch& other) const {
+	return devFirst_ == other.devFirst_ && devCount_ == other.devCount_;
+}
+
+/*! \brief True if both launches launch the same boxes on the same devices.
+
+    Launches with equal arg accesses (\sa hasEqualArgAccess) access the same
+    elements on the same devices only with equal partitions, e.g. not on
+    different device groups or as a phase of temporal blocking
+    \sa getBlockingPhase.
+*/
+bool KernelLaunch::hasEqualPartitions(const KernelLaunch& other) const {
+	return hasEqualDeviceRange(other) && isEqualSplit(parts_, other.parts_);
+}
+
 //! Only the partitioning, grid size, block size, non-pointer kernel arguments and
 //! the kernel function  affect the argument access.
 bool KernelLaunch::hasEqualArgAccess(const KernelLaunch& other) const {
@@ -153,7 +344,7 @@ bool KernelLaunch::hasEqualArgAccess(const KernelLaunch& other) const {
 
 //! If no argument is equal to \param ptr the function returns a nullptr.
 shared_ptr<const KernelArg> KernelLaunch::getArg(MEdeviceptr ptr) const {
-	for (auto arg : args_) {
+	for (const auto& arg : args_) {
 		if (*arg == ptr) {
 			return arg;
 		}
@@ -164,7 +355,7 @@ shared_ptr<const KernelArg> KernelLaunch::getArg(MEdeviceptr ptr) const {
 //! Returns -1 if \param ptr is not one of the arguments
 int KernelLaunch::getArgId(MEdeviceptr ptr) const {
 	int res = 0;
-	for (auto arg : args_) {
+	for (const auto& arg : args_) {
 		if (*arg == ptr) {
 			return res;
 		}
@@ -177,9 +368,9 @@ int KernelLaunch::getArgId(MEdeviceptr ptr) const {
 
 //! If the given KernelArg object is not an argument in this launch the
 //! function will return -1.
-int KernelLaunch::getArgId(shared_ptr<const KernelArg> arg) const {
+int KernelLaunch::getArgId(const shared_ptr<const KernelArg>& arg) const {
 	int res = 0;
-	for (auto thisarg : args_) {
+	for (const auto& thisarg : args_) {
 		if (thisarg == arg) { // pointer comparison
 			return res;
 		}
@@ -194,7 +385,7 @@ int KernelLaunch::getArgId(shared_ptr<const KernelArg> arg) const {
 //! returns the device pointers, which will be written in the kernel launch
 vector<MEdeviceptr> KernelLaunch::getWrites() const {
 	vector<MEdeviceptr> res;
-	for (auto arg : args_) {
+	for (const auto& arg : args_) {
 		if (arg->getType()->isModified() && arg->getType()->getPtrlvl() == 1) {
 			res.push_back(arg->asDevPtr());
 		}
@@ -205,7 +396,7 @@ vector<MEdeviceptr> KernelLaunch::getWrites() const {
 //! returns the device pointers, which will be read in the kernel launch
 vector<MEdeviceptr> KernelLaunch::getReads() const {
 	vector<MEdeviceptr> res;
-	for (auto arg : args_) {
+	for (const auto& arg : args_) {
 		if (arg->getType()->isRead() && arg->getType()->getPtrlvl() == 1) {
 			res.push_back(arg->asDevPtr());
 		}
@@ -216,7 +407,7 @@ vector<MEdeviceptr> KernelLaunch::getReads() const {
 //! returns all device pointers, given as kernel arguments in this launch.
 vector<MEdeviceptr> KernelLaunch::getPtrs() const {
 	vector<MEdeviceptr> res;
-	for (auto arg : args_) {
+	for (const auto& arg : args_) {
 		if (arg->getType()->getPtrlvl() == 1) {
 			res.push_back(arg->asDevPtr());
 		}
@@ -229,6 +420,164 @@ void KernelLaunch::depsResolved() {
 	depResolved_ = true;
 }
 
+/*! \brief Replaces the partitions by a split proportional to `weights`.
+
+    Drops everything, which was derived from the old partitions: the arg
+    accesses and the device to host copies. The caller has to drop the
+    dependency resolutions of this launch and to migrate the data, which
+    the old partitions wrote.
+    \sa LoadBalancer
+*/
+void KernelLaunch::repartition(const vector<double>& weights) {
+	lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+	parts_ = Partition::commit(
+		Partition::createPartitions(orgGrid_, orgBlock_, devFirst_,
+		                            getNumDevUsed(), parting_, weights));
+	resetPartitionData();
+}
+
+/*! \brief Sets the launch order and the stream slots of the partitions.
+
+    Partitions, which touch a partition of another device, are launched
+    first, thus the halos of an over-decomposed launch are ready before the
+    inner partitions finish. Only devices with several partitions use the
+    partition streams, the others keep the default stream.
+*/
+void KernelLaunch::orderPartitions() {
+	launchOrder_.clear();
+	partSlots_.assign(parts_.size(), (unsigned) noSlot);
+	vector<size_t> inner;
+	map<int, unsigned> numParts; // device -> number of partitions
+	for (size_t partId = 0; partId < parts_.size(); ++partId) {
+		const Partition& part = *parts_[partId];
+		++numParts[part.getDevice()];
+		bool boundary = false;
+		for (const auto& other : parts_) {
+			if (other->getDevice() != part.getDevice() && part.touches(*other)) {
+				boundary = true;
+				break;
+			}
+		}
+		(boundary ? launchOrder_ : inner).push_back(partId);
+	}
+	launchOrder_.insert(launchOrder_.end(), inner.begin(), inner.end());
+
+	map<int, unsigned> nextSlot;
+	for (size_t partId : launchOrder_) {
+		int dev = parts_[partId]->getDevice();
+		if (numParts[dev] > 1) {
+			partSlots_[partId] = nextSlot[dev]++;
+		}
+	}
+}
+
+//! Drops everything, which was derived from the old partitions
+void KernelLaunch::resetPartitionData() {
+	readAccs_.assign(args_.size(), nullptr);
+	writeAccs_.assign(args_.size(), nullptr);
+	argId2memcpy_.clear();
+	range2memcpy_.clear();
+	limitsChecked_ = false;
+	timesPending_ = false;
+	launchOrder_.clear();
+	// the events belong to the contexts of the old partitions
+	for (size_t partId = 0; partId < partStart_.size(); ++partId) {
+		if (partStart_[partId] != nullptr) {
+			meEventDestroy(partStart_[partId]);
+			meEventDestroy(partStop_[partId]);
+		}
+	}
+	partStart_.clear();
+	partStop_.clear();
+	// the phases widen the old partitions, they live on as the writers of
+	// their buffers
+	phases_.clear();
+}
+
+//! The balancer of the group of this launch, nullptr if balancing is off
+shared_ptr<LoadBalancer> KernelLaunch::getBalancer() const {
+	return balancer_;
+}
+
+/*! \brief Returns the seconds every partition of the last execution took.
+
+    Waits for the partitions, thus call it right before the next execution
+    of this launch, when they are usually finished. The times of an
+    execution are returned only once, later calls and failed measurements
+    return an empty vector.
+*/
+vector<double> KernelLaunch::getPartitionTimes() {
+	vector<double> res;
+	if (!timesPending_) {
+		return res;
+	}
+	timesPending_ = false;
+	MEresult err;
+	for (size_t partId = 0; partId < parts_.size(); ++partId) {
+		float ms = 0;
+		err &= meCtxPushCurrent(aliasH_->getCtx().at(parts_[partId]->getDevice()));
+		err &= meEventSynchronize(partStop_[partId]);
+		err &= meEventElapsedTime(&ms, partStart_[partId], partStop_[partId]);
+		err &= meCtxPopCurrent(0);
+		res.push_back(ms / 1e3);
+	}
+	if (!err.isSuccess()) {
+		res.clear();
+	}
+	return res;
+}
+
+/*! \brief Checks every partition against the limits of its device.
+
+    The result is cached: after a successful check later calls return
+    immediately, until new partitions reset it \sa resetPartitionData.
+    \param devLimits limits of every device, \sa AliasHandle::getDevLimits
+    \param funcLimits limits of the kernel function on every device. May be
+           empty, then only the device limits are checked.
+    \throw invalid_argument if a partition exceeds the limits
+*/
+void KernelLaunch::checkLimits(const vector<MEdevLimits>& devLimits,
+                               const vector<AliasHandle::FuncLimits>& funcLimits) {
+	auto throwError = [] (const string& msg) {
+		throw invalid_argument("SPACE Mekong, CLASS KernelLaunch, FUNC checkLimits():\n"
+		                       "Your kernel configuration exceeds the device "
+		                       "limits: " + msg);
+	};
+
+	if (limitsChecked_) {
+		return;
+	}
+	for (const auto& part : parts_) {
+		int dev = part->getDevice();
+		const MEdevLimits& limits = devLimits.at(dev);
+		const Array3& grid = part->getGrid();
+		const Array3& block = part->getBlock();
+		if (grid[0] > limits.grid[0] || grid[1] > limits.grid[1] ||
+		    grid[2] > limits.grid[2]) {
+			throwError("grid size is too big.");
+		}
+		if (block[0] > limits.block[0] || block[1] > limits.block[1] ||
+		    block[2] > limits.block[2]) {
+			throwError("block size is too big.");
+		}
+		size_t threads = (size_t) block[0] * block[1] * block[2];
+		size_t staticShMem = 0;
+		if (!funcLimits.empty()) {
+			if (threads > funcLimits.at(dev).maxThreadsPerBlock) {
+				throwError("the kernel function allows less threads per block.");
+			}
+			staticShMem = funcLimits.at(dev).staticShMem;
+		}
+		if (threads > limits.threadsPerBlock) {
+			throwError("maximum number of threads per block is too big.");
+		}
+		if (shMem_ + staticShMem > limits.shMemPerBlock) {
+			throwError("not enough shared memory.");
+		}
+	}
+	limitsChecked_ = true;
+}
+
 //! Comparison functor to save KernelLaunch objects in a std::set.
 bool KernelLaunch::equal_to::operator()(const shared_ptr<KernelLaunch>& a,
                                         const shared_ptr<KernelLaunch>& b) const {
@@ -239,10 +588,16 @@ bool KernelLaunch::equal_to::operator()(const shared_ptr<KernelLaunch>& a,
 size_t KernelLaunch::hash::operator()(const shared_ptr<KernelLaunch>& kl) const {
 	std::hash<unsigned> h;
 	std::hash<unsigned int> h_dummy;
-	return ((((h(kl->orgGrid_[0]) ^ (h(kl->orgGrid_[1]) << 1)) >> 1 )
-	         ^ h(kl->orgGrid_[2]))
-	       ^ (((h(kl->orgBlock_[0]) ^ (h(kl->orgBlock_[1]) >> 1)) << 1 )
-	         ^ h(kl->orgBlock_[2]))) ^ (((size_t) kl->func_));
+	size_t res = ((((h(kl->orgGrid_[0]) ^ (h(kl->orgGrid_[1]) << 1)) >> 1 )
+	               ^ h(kl->orgGrid_[2]))
+	             ^ (((h(kl->orgBlock_[0]) ^ (h(kl->orgBlock_[1]) >> 1)) << 1 )
+	               ^ h(kl->orgBlock_[2]))) ^ (((size_t) kl->func_));
+	// the argument hashes are precomputed, thus launches of the same kernel
+	// with different arguments end up in different buckets for free
+	for (auto& arg : kl->args_) {
+		res = (res ^ arg->getHash()) * 1099511628211ULL;
+	}
+	return res;
 
 }
 
@@ -252,94 +607,24 @@ size_t KernelLaunch::hash::operator()(const shared_ptr<KernelLaunch>& kl) const
 //! an invalid_argument exception.
 unsigned short KernelLaunch::getGPU(const Array3& id) const {
 
-	auto mult3 = [] (const Array3& a, const Array3& b) {
-		return Array3({ a[0] * b[0],
-		                a[1] * b[1],
-		                a[2] * b[2] });
-	};
-
-	auto add3 = [] (const Array3& a, const Array3& b) {
-		return Array3({ a[0] + b[0],
-		                a[1] + b[1],
-		                a[2] + b[2] });
-	};
-
-	auto sub3 = [] (const Array3& a, const Array3& b) {
-		return Array3({ a[0] - b[0],
-		                a[1] - b[1],
-		                a[2] - b[2] });
-	};
-
-	for (auto part : parts_) {
-
-		// get the partition size in threads
-		auto size = mult3(part->getGrid(), part->getBlock());
-		
-		// get the maximum indexes which are still inside the partition
-		auto max  = sub3(add3(part->getOffset(), size), { 1, 1, 1 });
-
-		isl_ctx* ctx = isl_ctx_alloc();
-		isl_space* space;
-		isl_basic_set* bset;
-		isl_basic_set* sing;
-		isl_basic_set* inter;
-		isl_point* pmin;
-		isl_point* pmax;
-		isl_point* p;
-		isl_val* val;
-
-		space = isl_space_set_alloc(ctx, 0, 3);
-		pmin = isl_point_zero(isl_space_copy(space));
-		pmax = isl_point_zero(isl_space_copy(space));
-		p    = isl_point_zero(space);
-
-		// MIN POINT
-		// x
-		val = isl_val_int_from_ui(ctx, part->getOffset()[0]);
-		pmin = isl_point_set_coordinate_val(pmin, isl_dim_set, 0, val);
-		// y
-		val = isl_val_int_from_ui(ctx, part->getOffset()[1]);
-		pmin = isl_point_set_coordinate_val(pmin, isl_dim_set, 1, val);
-		// z
-		val = isl_val_int_from_ui(ctx, part->getOffset()[2]);
-		pmin = isl_point_set_coordinate_val(pmin, isl_dim_set, 2, val);
-
-		// MAX POINT
-		// x
-		val = isl_val_int_from_ui(ctx, max[0]);
-		pmax = isl_point_set_coordinate_val(pmax, isl_dim_set, 0, val);
-		// y
-		val = isl_val_int_from_ui(ctx, max[1]);
-		pmax = isl_point_set_coordinate_val(pmax, isl_dim_set, 1, val);
-		// z
-		val = isl_val_int_from_ui(ctx, max[2]);
-		pmax = isl_point_set_coordinate_val(pmax, isl_dim_set, 2, val);	
-
-		// CREATING THE BOX
-		bset = isl_basic_set_box_from_points(pmin, pmax);
-		
-		// POINT TO CHECK IF IT IS IN THE BOX
-		// x
-		val = isl_val_int_from_ui(ctx, id[0]);
-		p = isl_point_set_coordinate_val(p, isl_dim_set, 0, val);
-		// y
-		val = isl_val_int_from_ui(ctx, id[1]);
-		p = isl_point_set_coordinate_val(p, isl_dim_set, 1, val);
-		// z
-		val = isl_val_int_from_ui(ctx, id[2]);
-		p = isl_point_set_coordinate_val(p, isl_dim_set, 2, val);
-		
-		// CREATING SINGLETON
-		sing = isl_basic_set_from_point(p);
-		
-		// INTERSECT
-		inter = isl_basic_set_intersect(bset, sing);
-		
-		if (!isl_basic_set_is_empty(inter)) {
+	// The partitions are boxes, thus a comparison of the coordinates is
+	// enough. No isl objects are needed.
+	for (const auto& part : parts_) {
+		const Array3& offset = part->getOffset();
+		const Array3& grid = part->getGrid();
+		const Array3& block = part->getBlock();
+		bool inside = true;
+		for (int dim = 0; dim < 3; ++dim) {
+			// size_t, as offset + size can exceed an unsigned
+			size_t end = (size_t) offset[dim] + (size_t) grid[dim] * block[dim];
+			if (id[dim] < offset[dim] || id[dim] >= end) {
+				inside = false;
+				break;
+			}
+		}
+		if (inside) {
 			return part->getDevice();
 		}
-		isl_basic_set_free(inter);
-		isl_ctx_free(ctx);
 	}
 	throw invalid_argument("could not find thread id in this kernel launch!");
 }
@@ -359,7 +644,7 @@ const vector<shared_ptr<const Partition>>& KernelLaunch::getPartitions() const {
 
 //! Returns the partitioning used for this kernel launch, e.g. splitted at X-Dim, splitted at XY-Dim.
 shared_ptr<const Partitioning> KernelLaunch::getPartitioning() const {
-	return info_->getPartitioning();
+	return parting_;
 }
 
 /*! \brief Executes the kernel launch.
@@ -403,19 +688,16 @@ MEresult KernelLaunch::exec() {
 
 	// GET ORIGINAL ARGUMENTS //
 	unsigned short i = 0;
-	vector<unique_ptr<charPack>> rawData;
-	for (auto arg : args_) {
-		// kernel launch function expects a void* and not a const void*, thus
-		// we need to copy the data and hold it in memory until the
-		// kernel launch is done.
-		rawData.push_back(arg->cpyCharPack()); // CAUTION: removing this line will lead to a seg fault
-		rawArgs[i++] = rawData.back()->getRaw();
+	for (auto& arg : args_) {
+		// the kernel launch function expects a void*, but only reads the
+		// values, thus we can pass the bits stored in the arguments
+		rawArgs[i++] = const_cast<void*>(arg->getRaw());
 	}
 
 	// get devptr args //
 	vector<tuple<unsigned short, shared_ptr<const KernelArg>>> devptrArgs;
 	unsigned short argid = 0;
-	for (auto arg : args_) {
+	for (const auto& arg : args_) {
 		if (arg->getType()->getPtrlvl() > 0) {
 			devptrArgs.push_back(make_tuple(argid, arg));
 		}
@@ -429,8 +711,17 @@ MEresult KernelLaunch::exec() {
 	rawArgs[args_.size() + 5] = &globalSize[2];
 
 	// ITERATE OVER EVERY PARTITION AND LAUNCH IT //
-	for (auto part : parts_) {
-		for (auto devptrArg : devptrArgs) {
+	const vector<MEfunction>& funcs = (*aliasH_)[func_];
+	// the load balancer needs the time of every partition
+	bool timed = balancer_ != nullptr || replanPending_;
+	if (launchOrder_.size() != parts_.size()) {
+		orderPartitions();
+	}
+	partStart_.resize(parts_.size(), nullptr);
+	partStop_.resize(parts_.size(), nullptr);
+	for (size_t partId : launchOrder_) {
+		const auto& part = parts_[partId];
+		for (const auto& devptrArg : devptrArgs) {
 			// in the mekong context there exists one device ptr per memory
 			// buffer, which can be accessed by many gpus. On hardware level we
 			// have to allocate one dev ptr on every gpu refering that memory
@@ -445,16 +736,32 @@ MEresult KernelLaunch::exec() {
 		rawArgs[args_.size() + 2] = &offCpy[2];
 
 		res &= meCtxPushCurrent(aliasH_->getCtx().at(part->getDevice()));
-		res &= meLaunchKernel((*aliasH_)[func_].at(part->getDevice()), 
+		// several partitions of a device run concurrently on own streams
+		MEstream stream = 0;
+		if (partSlots_[partId] != noSlot) {
+			res &= getPartStream(part->getDevice(), partSlots_[partId], &stream);
+		}
+		if (timed) {
+			if (partStart_[partId] == nullptr) {
+				res &= meEventCreate(&partStart_[partId], true);
+				res &= meEventCreate(&partStop_[partId], true);
+			}
+			res &= meEventRecord(partStart_[partId], stream);
+		}
+		res &= meLaunchKernel(funcs.at(part->getDevice()),
 		                        part->getGrid()[0],
 		                        part->getGrid()[1],
 		                        part->getGrid()[2],
 		                        part->getBlock()[0],
 		                        part->getBlock()[1],
 		                        part->getBlock()[2],
-		                        shMem_, 0, rawArgs, 0); // TODO support streams and extra args
+		                        shMem_, stream, rawArgs, 0); // TODO support extra args
+		if (timed) {
+			res &= meEventRecord(partStop_[partId], stream);
+		}
 		res &= meCtxPopCurrent(0);
 	}
+	timesPending_ = timed && res.isSuccess();
 
 	delete[] rawArgs;
 	++executions_;
@@ -531,6 +838,7 @@ KernelLaunch::getWriteArgAccess(unsigned short argNr) {
 //! the wrapKernelLaunch *and* wrapDtoH function, thus the total time spent in this function
 //! can be greater as the total time spent in the wrapKernelLaunch function.
 shared_ptr<const ArgAccess> KernelLaunch::getArgAccess(unsigned short argNr, bool getReadArgAccess) {
+	unique_lock<recursive_mutex> lock(MEKONG_launchMutex);
 	++numArgAccessCalls_;
 	auto time_argAcc_begin = Clock::now();
 
@@ -560,7 +868,7 @@ shared_ptr<const ArgAccess> KernelLaunch::getArgAccess(unsigned short argNr, boo
 		if (&**kernel_it == this) { // skip yourself
 			continue;
 		}
-		if (hasEqualArgAccess(**kernel_it)) {
+		if (hasEqualArgAccess(**kernel_it) && hasEqualPartitions(**kernel_it)) {
 			if (getReadArgAccess) {
 				if ((*kernel_it)->readAccs_[argNr] != nullptr) {
 					accs[argNr] = (*kernel_it)->readAccs_[argNr];
@@ -581,10 +889,11 @@ shared_ptr<const ArgAccess> KernelLaunch::getArgAccess(unsigned short argNr, boo
 	}
 
 	++numArgAccessCalcs_;
-	auto numDims = args_[argNr]->getType()->getNumDims();
-	if (numDims > 2) {
-		throwError("polly arrays with num dimensions > 2 are not supported.");
-	}
+	// The calculation runs without MEKONG_launchMutex, thus it does not block
+	// new launches if it runs in the background. It uses the partitions of
+	// this moment.
+	auto parts = parts_;
+	lock.unlock();
 
 	// If no equal kernel launch was found calculate the arg access here
 	// 1. For every partition create the range set, which represents the accessed
@@ -593,7 +902,7 @@ shared_ptr<const ArgAccess> KernelLaunch::getArgAccess(unsigned short argNr, boo
 	//    on that gpu, thus we get all indices accessed by a certain gpu.
 	// 3. Make that union disjoint and simplify its representation.
 	// 4. For every gpu calculate the linear intervals from the union set.
-	//    This can be more expensive for 2D access maps
+	//    This can be more expensive for nD access maps
 	
 	// Here we have to initialize the map on the main thread.
 	// Otherwise the threads will create the interval vectors,
@@ -607,9 +916,10 @@ shared_ptr<const ArgAccess> KernelLaunch::getArgAccess(unsigned short argNr, boo
 	// This lambda represents the calculations, which must be done for
 	// every GPU. This encapsulation enables us easy parallelization.
 	auto calcIndices = [&] (unsigned short gpuId) {
-		// As you must use one isl_ctx per thread we have to do some work
-		// for every thread
-		isl_ctx* ctx = isl_ctx_alloc();
+		// As you must use one isl_ctx per thread we use the long living
+		// context of the linearization thread, which already contains the
+		// parsed access map after the first launch
+		isl_ctx* ctx = IslContext::get().getCtx();
 		isl_union_map* accFuncMap;
 		if (getReadArgAccess) {
 			accFuncMap = getInfo()->getAccFunc(argNr)->getReadIslMap(ctx,
@@ -625,118 +935,179 @@ shared_ptr<const ArgAccess> KernelLaunch::getArgAccess(unsigned short argNr, boo
 		}
 		// end of additional work
 
-		// 1.
-		// Collect all sets of current GPU
-		vector<isl_set*> setVector;
-		for (auto part : parts_) { // iterate over the partitions
-			if (part->getDevice() == gpuId) { // only work on current device
-				isl_union_map* umap = isl_union_map_copy(accFuncMap);
-				umap = partIntoUnionMap(part, umap); // __isl_take
-				isl_union_set* range_uset = isl_union_map_range(umap); // __isl_take
-				// As all accesses in an isl_union_map MUST have the same array as
-				// the target space, the range_uset MUST be trivially convertible
-				// to an isl_set
-				isl_set* rangeSet = isl_set_from_union_set(range_uset); // __isl_take
-				setVector.push_back(rangeSet);
-			}
-		}
-		if (setVector.empty()) {
+		// 1. - 3.
+		isl_set* currPoints = accessedSet(accFuncMap, parts, gpuId);
+		if (!currPoints) {
 			isl_union_map_free(accFuncMap);
-			isl_ctx_free(ctx);
 			return;
 		}
-
-		// 2. Union all sets of current GPU
-		// __isl_give isl_space* isl_set_get_space(__isl_keep isl_set*)
-		// __isl_give isl_set* isl_set_empty(__isl_take isl_space*)
-		isl_set* currPoints = isl_set_empty(isl_set_get_space(setVector[0]));
-		for (auto* set : setVector) {
-			currPoints = isl_set_union(currPoints, set); // __isl_take, __isl_take
-		}
-
-		// 3. Simplify the representation of a set, relation or functions by trying to combine
-		//    pairs of basic sets or relations into a single basic set or relation.
-		currPoints = isl_set_make_disjoint(currPoints); // __isl_take
-		currPoints = isl_set_coalesce(currPoints); // __isl_take
-		currPoints = isl_set_remove_redundancies(currPoints); // __isl_take
 		// 4.
-		if (numDims == 1) {
-			isl_set_foreach_basic_set(currPoints, addMinAndMax_1D, &gpuToRanges[gpuId]);
-		}
-		else if (numDims == 2) {
-			// Now we collect the intervals contained in the basic set
-			vector<tuple<size_t, size_t>>& intervals = gpuToRanges[gpuId];
-			size_t dimSize = args_[argNr]->getDimSize(0);
-			auto dimSize_intervals = make_tuple(dimSize, &intervals);
-			isl_set_foreach_basic_set(currPoints, bset_2D_to_1D_intervals, &dimSize_intervals);
-
-			// Now consider the following accessed points on a 2D array
-			// ('O' denotes accessed elements):
-			//
-			// y    Array                basic sets
-			// 0    * * * * * * * * *
-			// 1    * O O O O O O O O    <- bset1
-			// 2    * * O O O O O O O    <- bset1
-			// 3    * * * O O O O O O    <- bset1
-			// 4    O O O O O O * * *    <- bset0
-			// 5    O O O O O O O O O    <- bset0
-			// 6    O O O O O O O O O    <- bset0
-			// 7    * * * * * * * * *
-			//
-			// It could happen that the lower basic will be processed first,
-			// which will result in a seperation of interval y = 3 and y = 4.
-			// As we want to have the minimum amount of memcpys we want to have
-			// one interval for y = 3,4. Thus we have to sort the calculated
-			// intervals at this point of the program
-
-			// FOR PERFORMANCE REASONS WE IGNORE THIS. THE SORT IS VERY EXPENSIVE
-			// AND MIGHT BE NOT AMORTIZED BY A LOWER NUMBER OF MEMCPYS 
-			/*sort(intervals.begin(), intervals.end(), [] (const tuple<size_t, size_t>& a,
-														 const tuple<size_t, size_t>& b) {
-															   return get<0>(a) < get<0>(b);
-													 }
-			);*/
-
-			// Now we can try to concatenate the intervals where it is possible
-			if (!intervals.empty()) {
-				for (auto interval_it = intervals.begin() + 1;
-				     interval_it != intervals.end();
-				     ++interval_it) {
-					auto predecessor = interval_it - 1;
-					if (get<1>(*predecessor) == get<0>(*interval_it)) {
-						get<1>(*predecessor) = get<1>(*interval_it);
-						intervals.erase(interval_it);
-						--interval_it;
-					}
-				}
-			}
-			// 5. save the results
-			//gpuToRanges.emplace(gpuId, move(intervals));
-			gpuToRanges.insert(make_pair(gpuId, intervals));
-		}
-
-		isl_set_free(currPoints);
+		gpuToRanges[gpuId] = linearize(currPoints, argNr);
 		isl_union_map_free(accFuncMap);
-		isl_ctx_free(ctx);
 	}; // end of lambda function
 
-	// start a thread for every gpu to calculate the accessed indices
+	// calculate the accessed indices of every gpu on its own thread
 	auto time_linearization_begin = Clock::now();
-	vector<thread> threads;
-	for (unsigned short gpuId = 0; gpuId < aliasH_->getNumDev(); ++gpuId) {
-		//calcIndices(gpuId);
-		threads.push_back(thread(calcIndices, gpuId));
+	vector<exception_ptr> errors(aliasH_->getNumDev());
+	{
+		lock_guard<mutex> poolLock(MEKONG_linearizationMutex);
+		WorkerPool& pool = getLinearizationPool(aliasH_->getNumDev());
+		for (unsigned short gpuId = 0; gpuId < aliasH_->getNumDev(); ++gpuId) {
+			pool.submit([&calcIndices, &errors, gpuId] {
+				try {
+					calcIndices(gpuId);
+				}
+				catch (...) {
+					errors[gpuId] = current_exception();
+				}
+			});
+		}
+		pool.wait();
 	}
-	for (auto& t : threads) {
-		t.join();
+	for (auto& error : errors) {
+		if (error) {
+			rethrow_exception(error);
+		}
 	}
 	Duration time_linearization = Clock::now() - time_linearization_begin;
-	linearizationTime_ += time_linearization.count();
-	accs[argNr] = shared_ptr<const ArgAccess>(new ArgAccess(move(gpuToRanges)));
+	shared_ptr<const ArgAccess> argAcc = MEKONG_argAccessArena->share(
+	                                     MEKONG_argAccessArena->create(move(gpuToRanges)));
 
+	lock.lock();
+	linearizationTime_ += time_linearization.count();
+	// Another thread might have published the arg access meanwhile. The arg
+	// access of partitions, which were replaced meanwhile, is not cached.
+	if (accs[argNr]) {
+		argAcc = accs[argNr];
+	}
+	else if (parts == parts_) {
+		accs[argNr] = argAcc;
+	}
 	Duration time_argAcc = Clock::now() - time_argAcc_begin;
 	argAccessTime_ += time_argAcc.count();
-	return accs[argNr];
+	return argAcc;
+}
+
+/*! \brief Unions the accessed elements of all partitions of device `gpuId`.
+
+    Adjacent partitions of the device are merged first, thus an
+    over-decomposed launch applies the access map about once per device
+    \sa Partition::coalesce.
+    \param accFuncMap read or write map of an argument, __isl_keep
+    \return a disjoint and coalesced set, nullptr if the device has no
+            partition
+*/
+__isl_give isl_set*
+KernelLaunch::accessedSet(__isl_keep isl_union_map* accFuncMap,
+                          const vector<shared_ptr<const Partition>>& parts,
+                          unsigned short gpuId) {
+	// 1.
+	// Collect all sets of current GPU
+	vector<shared_ptr<const Partition>> devParts;
+	for (const auto& part : parts) { // iterate over the partitions
+		if (part->getDevice() == gpuId) { // only work on current device
+			devParts.push_back(part);
+		}
+	}
+	if (devParts.empty()) {
+		return nullptr;
+	}
+	vector<isl_set*> setVector;
+	for (const auto& part : Partition::coalesce(devParts)) {
+		isl_union_map* umap = isl_union_map_copy(accFuncMap);
+		umap = partIntoUnionMap(part, umap); // __isl_take
+		isl_union_set* range_uset = isl_union_map_range(umap); // __isl_take
+		// As all accesses in an isl_union_map MUST have the same array as
+		// the target space, the range_uset MUST be trivially convertible
+		// to an isl_set
+		isl_set* rangeSet = isl_set_from_union_set(range_uset); // __isl_take
+		setVector.push_back(rangeSet);
+	}
+
+	// 2. Union all sets of current GPU
+	// __isl_give isl_space* isl_set_get_space(__isl_keep isl_set*)
+	// __isl_give isl_set* isl_set_empty(__isl_take isl_space*)
+	isl_set* currPoints = isl_set_empty(isl_set_get_space(setVector[0]));
+	for (auto* set : setVector) {
+		currPoints = isl_set_union(currPoints, set); // __isl_take, __isl_take
+	}
+
+	// 3. Simplify the representation of a set, relation or functions by trying to combine
+	//    pairs of basic sets or relations into a single basic set or relation.
+	currPoints = isl_set_make_disjoint(currPoints); // __isl_take
+	currPoints = isl_set_coalesce(currPoints); // __isl_take
+	currPoints = isl_set_remove_redundancies(currPoints); // __isl_take
+	return currPoints;
+}
+
+/*! \brief Linearizes a set of accessed elements of argument `argNr` into
+           intervals of element indices.
+
+    This can be more expensive for nD access maps. Frees `set`.
+*/
+vector<tuple<size_t, size_t>>
+KernelLaunch::linearize(__isl_take isl_set* set, unsigned short argNr) const {
+	auto numDims = args_[argNr]->getType()->getNumDims();
+	vector<tuple<size_t, size_t>> intervals;
+	if (numDims == 1) {
+		isl_set_foreach_basic_set(set, addMinAndMax_1D, &intervals);
+	}
+	else {
+		// Now we collect the intervals contained in the basic set.
+		// The stride of polly dimension d is the product of the sizes
+		// of all inner dimensions, dimSizes[d] is the size of dimension
+		// d + 1 \sa KernelArg::getDimSize
+		const vector<size_t>& dimSizes = args_[argNr]->getDimSizes();
+		vector<size_t> strides(numDims, 1);
+		for (int d = numDims - 2; d >= 0; --d) {
+			strides[d] = strides[d + 1] * dimSizes[d];
+		}
+		auto strides_intervals = make_tuple(&strides, &intervals);
+		isl_set_foreach_basic_set(set, bset_nD_to_1D_intervals, &strides_intervals);
+
+		// Now consider the following accessed points on a 2D array
+		// ('O' denotes accessed elements):
+		//
+		// y    Array                basic sets
+		// 0    * * * * * * * * *
+		// 1    * O O O O O O O O    <- bset1
+		// 2    * * O O O O O O O    <- bset1
+		// 3    * * * O O O O O O    <- bset1
+		// 4    O O O O O O * * *    <- bset0
+		// 5    O O O O O O O O O    <- bset0
+		// 6    O O O O O O O O O    <- bset0
+		// 7    * * * * * * * * *
+		//
+		// It could happen that the lower basic will be processed first,
+		// which will result in a seperation of interval y = 3 and y = 4.
+		// As we want to have the minimum amount of memcpys we want to have
+		// one interval for y = 3,4. Thus we have to sort the calculated
+		// intervals at this point of the program
+
+		// FOR PERFORMANCE REASONS WE IGNORE THIS. THE SORT IS VERY EXPENSIVE
+		// AND MIGHT BE NOT AMORTIZED BY A LOWER NUMBER OF MEMCPYS 
+		/*sort(intervals.begin(), intervals.end(), [] (const tuple<size_t, size_t>& a,
+													 const tuple<size_t, size_t>& b) {
+														   return get<0>(a) < get<0>(b);
+												 }
+		);*/
+
+		// Now we can try to concatenate the intervals where it is possible
+		if (!intervals.empty()) {
+			for (auto interval_it = intervals.begin() + 1;
+			     interval_it != intervals.end();
+			     ++interval_it) {
+				auto predecessor = interval_it - 1;
+				if (get<1>(*predecessor) == get<0>(*interval_it)) {
+					get<1>(*predecessor) = get<1>(*interval_it);
+					intervals.erase(interval_it);
+					--interval_it;
+				}
+			}
+		}
+	}
+	isl_set_free(set);
+	return intervals;
 }
 
 //! Returns a memcpy object, to get written data.
@@ -765,33 +1136,135 @@ shared_ptr<MemCpyDtoH> KernelLaunch::getWrittenData(MEdeviceptr ptr, void* hptr)
 		}
 	}*/
 
-	// IF IT ALREADY EXISTS, RETURN IT
-	if (argId2memcpy_.find(argId) != argId2memcpy_.end()) {
-		argId2memcpy_[argId]->setDst(hptr);
-		return argId2memcpy_[argId];
+	auto cpy = getWrittenPattern(argId);
+	lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+	cpy->setDst(hptr);
+	return cpy;
+}
+
+/*! \brief Returns the cached memcpy object of all elements written to the
+           argument `argId` and creates it if necessary.
+
+    The destination pointer of a newly created object is not set. Like the
+    arg access, the pattern is calculated without MEKONG_launchMutex and only
+    published under it.
+*/
+shared_ptr<MemCpyDtoH> KernelLaunch::getWrittenPattern(unsigned short argId) {
+	unique_lock<recursive_mutex> lock(MEKONG_launchMutex);
+	auto it = argId2memcpy_.find(argId);
+	if (it != argId2memcpy_.end()) {
+		return it->second;
 	}
-	// ELSE CREATE THE OBJECT
+	auto parts = parts_;
+	lock.unlock();
 	auto argAcc = getWriteArgAccess(argId);
 	vector<MemSubCopy> subcpys;
+	// overlapping partitions wrote equal values, which are copied only once
+	vector<tuple<size_t, size_t>> covered;
 	for (auto it = argAcc->getMap().begin(); it != argAcc->getMap().end(); ++it) { // loop over gpus
 		auto gpuId = it->first;
 		auto& intervals = it->second;
 		for (auto& interval : intervals) {
-			MemSubCopy subcpy;
-			subcpy.src = gpuId;
-			subcpy.dst = -1; // always host as aim
-			size_t elSize = args_[argId]->getType()->getElSize();
-			size_t offset = get<0>(interval) * elSize;  
-			subcpy.from = offset; 
-			subcpy.to = offset;
-			subcpy.size = get<1>(interval) * elSize - offset;
-			subcpys.push_back(move(subcpy));
+			for (auto& piece : ArgAccess::subtractIntervals(interval, covered)) {
+				MemSubCopy subcpy;
+				subcpy.src = gpuId;
+				subcpy.dst = -1; // always host as aim
+				size_t elSize = args_[argId]->getType()->getElSize();
+				size_t offset = get<0>(piece) * elSize;
+				subcpy.from = offset;
+				subcpy.to = offset;
+				subcpy.size = get<1>(piece) * elSize - offset;
+				subcpys.push_back(move(subcpy));
+				// keep `covered` sorted for subtractIntervals
+				covered.insert(upper_bound(covered.begin(), covered.end(), piece),
+				               piece);
+			}
 		}
 	}
 	auto pattern = shared_ptr<const vector<MemSubCopy>>(new vector<MemSubCopy>(move(subcpys)));
-	auto cpy = shared_ptr<MemCpyDtoH>(new MemCpyDtoH(hptr, ptr, pattern, aliasH_));
-	argId2memcpy_[argId] = cpy;
+	auto cpy = shared_ptr<MemCpyDtoH>(new MemCpyDtoH(nullptr, args_[argId]->asDevPtr(),
+	                                                    pattern, aliasH_));
+	lock.lock();
+	// the first published pattern wins, the pattern of replaced partitions
+	// is not cached
+	it = argId2memcpy_.find(argId);
+	if (it != argId2memcpy_.end()) {
+		return it->second;
+	}
+	if (parts == parts_) {
+		argId2memcpy_[argId] = cpy;
+	}
+	return cpy;
+}
+
+/*! \brief Calculates the write arg accesses and the device to host memcpy
+           patterns of all written arguments.
+
+    Meant to be called by a background thread right after the launch was
+    submitted, thus a later getWrittenData() only has to set the host
+    pointer. Already calculated patterns are skipped.
+*/
+void KernelLaunch::precomputeWrittenData() {
+	for (unsigned short argId = 0; argId < args_.size(); ++argId) {
+		auto type = args_[argId]->getType();
+		if (type->isModified() && type->getPtrlvl() == 1) {
+			getWrittenPattern(argId);
+		}
+	}
+}
+
+/*! \brief Returns a memcpy of the written elements in the device Bytes
+           [offset, offset + size) of buffer `ptr`.
+
+    The host buffer `hptr` corresponds to the device Byte `offset`. The
+    pattern of the complete buffer is clipped to the requested range. If
+    `broadcastBase` is set, the buffer was broadcast before this launch wrote
+    to it. Then the elements in the range not written by this launch are
+    copied from the first GPU, as they are equal on all devices.
+    The memcpy objects are cached for every range.
+    \sa getWrittenData(MEdeviceptr, void*) for the complete pattern
+*/
+shared_ptr<MemCpyDtoH> KernelLaunch::getWrittenData(MEdeviceptr ptr, void* hptr,
+                                                    size_t offset, size_t size,
+                                                    bool broadcastBase) {
+	lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+	auto full = getWrittenData(ptr, hptr);
+	auto& pattern = *full->getPattern();
+
+	// the complete pattern fits if we do not need to fill any gaps
+	// and every sub copy lies in the requested range
+	if (offset == 0 && !broadcastBase) {
+		bool fits = true;
+		for (const auto& subcpy : pattern) {
+			if (subcpy.from + subcpy.size > size) {
+				fits = false;
+				break;
+			}
+		}
+		if (fits) {
+			return full;
+		}
+	}
+
+	auto key = make_tuple((unsigned short) getArgId(ptr), offset, size,
+	                      broadcastBase);
+	auto it = range2memcpy_.find(key);
+	if (it != range2memcpy_.end()) {
+		it->second->setDst(hptr);
+		return it->second;
+	}
 
+	auto clipped = MemCpyDtoH::clipPattern(pattern, offset, size);
+	if (broadcastBase) {
+		MemCpyDtoH::fillGaps(clipped, offset, size, 0);
+	}
+	auto cpy = shared_ptr<MemCpyDtoH>(
+		new MemCpyDtoH(hptr, ptr,
+		               shared_ptr<const vector<MemSubCopy>>(
+		                   new vector<MemSubCopy>(move(clipped))),
+		               aliasH_)
+	);
+	range2memcpy_[key] = cpy;
 	return cpy;
 }
 
@@ -800,6 +1273,11 @@ size_t KernelLaunch::getExecs() const {
 	return executions_;
 }
 
+//! Returns a compact unique id of the launches in KernelLaunch::all, else noId
+unsigned KernelLaunch::getId() const {
+	return id_;
+}
+
 //! Returns the KernelArg object for the argument id \param nr.
 
 //! The function will throw if \param nr exceeds the limits
@@ -887,26 +1365,490 @@ const vector<shared_ptr<const ArgAccess>>& KernelLaunch::getWriteArgAccesses() c
 	return writeAccs_;
 }
 
-/*! \brief Initializes a kernel launch without partition creation.
-    \sa getOrInsert uses this function
+/*! \brief Completes a bare initialized kernel launch object, which is
+           going to be inserted, except for its partitions.
+
+    Also sizes the arg access caches, which are not needed by bare launches
+    used only for a lookup.
 */
-shared_ptr<KernelLaunch>
-KernelLaunch::initBare(MEfunction func, const Array3& grid, 
-                       const Array3& block, size_t shMem, void** rawArgs,
-                       shared_ptr<const bsp_KernelInfo> info) {
-	return shared_ptr<KernelLaunch>(new KernelLaunch(func, grid, block, shMem,
-	                                                 rawArgs, info));
+void KernelLaunch::initPartitioning(shared_ptr<AliasHandle> aliasH) {
+	this->aliasH_ = aliasH;
+	readAccs_.assign(args_.size(), nullptr);
+	writeAccs_.assign(args_.size(), nullptr);
+	parting_ = info_->getPartitioning();
+	devFirst_ = 0;
+	devCount_ = aliasH->getNumDev();
+}
+
+//! True if the partitions are chosen by the planner \sa PartitionPlanner
+bool KernelLaunch::isPlanned() {
+	return PartitionPlanner::isEnabled() || PartitionPlanner::isDeviceCountSelection();
 }
 
 /*! \brief Calculate the partitions for a bare initialized kernel launch object.
-    \sa initBare
+
+    \param plan of the planner, if it was made already, otherwise empty
+    Only the chosen partitions are committed to the partition arena
+    \sa Partition::commit. Needs MEKONG_launchMutex.
 */
-void KernelLaunch::setPartitions(shared_ptr<AliasHandle> aliasH) {
-	this->aliasH_ = aliasH;
-	parts_ = Partition::createPartitions(orgGrid_,
-	                                     orgBlock_,
-	                                     aliasH,
-	                                     info_->getPartitioning());
+void KernelLaunch::setPartitions(
+	const pair<shared_ptr<const Partitioning>, vector<shared_ptr<const Partition>>>& plan) {
+	if (isPlanned()) {
+		choosePartitioning(plan);
+		return;
+	}
+	parts_ = Partition::commit(Partition::createPartitions(orgGrid_,
+	                                                       orgBlock_,
+	                                                       aliasH_,
+	                                                       parting_));
+}
+
+//! A launch with equal arg accesses on the same devices, nullptr if there is none
+const KernelLaunch* KernelLaunch::findEqualLaunch() const {
+	for (const auto& other : all) {
+		if (hasEqualArgAccess(*other) && hasEqualDeviceRange(*other)) {
+			return other.get();
+		}
+	}
+	return nullptr;
+}
+
+/*! \brief Sets the partitions with the lowest predicted iteration time
+           \sa PartitionPlanner
+
+    Launches with equal arg accesses get equal partitions, thus a launch
+    takes the decision of such a launch, e.g. the second launch of a
+    stencil, which swaps its buffers. Launches, which moved to another
+    device range, keep their plan \sa setDeviceRange. Needs
+    MEKONG_launchMutex.
+    \param plan of the planner, if it was made already, otherwise empty
+*/
+void KernelLaunch::choosePartitioning(
+	const pair<shared_ptr<const Partitioning>, vector<shared_ptr<const Partition>>>& plan) {
+	if (const KernelLaunch* other = findEqualLaunch()) {
+		parting_ = other->parting_;
+		parts_ = other->parts_;
+		devFirst_ = other->devFirst_;
+		devCount_ = other->devCount_;
+		replanPending_ = other->replanPending_;
+		return;
+	}
+	if (plan.second.empty()) {
+		choosePartitioning(planPartitions(PartitionPlanner::getCostModel()));
+		return;
+	}
+	parting_ = plan.first;
+	parts_ = Partition::commit(plan.second);
+	// the balancer changes the partitions itself
+	replanPending_ = PartitionPlanner::isDeviceCountSelection() && !balancing_;
+}
+
+/*! \brief Evaluates the candidate schemes and device counts with the cost
+           model.
+
+    The database's scheme and more devices win ties. Does not need
+    MEKONG_launchMutex.
+    \param model a copy of the cost model, which may be calibrated meanwhile
+    \return the best scheme and its partitions
+*/
+pair<shared_ptr<const Partitioning>, vector<shared_ptr<const Partition>>>
+KernelLaunch::planPartitions(const PartitionPlanner::CostModel& model) const {
+	vector<shared_ptr<const Partitioning>> schemes = { info_->getPartitioning() };
+	if (PartitionPlanner::isEnabled()) {
+		schemes = PartitionPlanner::getCandidates(orgGrid_, info_->getPartitioning());
+	}
+	vector<unsigned short> counts = { devCount_ };
+	if (PartitionPlanner::isDeviceCountSelection()) {
+		counts = PartitionPlanner::getDeviceCounts(devCount_);
+	}
+
+	pair<shared_ptr<const Partitioning>, vector<shared_ptr<const Partition>>> best;
+	double bestTime = 0;
+	for (unsigned short numDev : counts) {
+		vector<double> weights = getDevWeights(numDev);
+		for (const auto& candidate : schemes) {
+			vector<shared_ptr<const Partition>> parts;
+			try {
+				parts = Partition::createPartitions(orgGrid_, orgBlock_, devFirst_,
+				                                    numDev, candidate, weights);
+			}
+			catch (const invalid_argument&) {
+				continue; // the grid is too small for this scheme
+			}
+			double time = PartitionPlanner::predictTime(parts, estimateExchange(parts),
+			                                            model);
+			if (best.second.empty() || time < bestTime) {
+				best = make_pair(candidate, move(parts));
+				bestTime = time;
+			}
+		}
+	}
+	if (best.second.empty()) { // let the database's scheme report the error
+		best = make_pair(info_->getPartitioning(),
+		                 Partition::createPartitions(orgGrid_, orgBlock_, devFirst_,
+		                                             devCount_, info_->getPartitioning(),
+		                                             getDevWeights(devCount_)));
+	}
+	return best;
+}
+
+/*! \brief Plans the partitions again with the calibrated cost model.
+
+    Called once, after the partition times of a planned launch refined the
+    cost model. The caller has to migrate the data and to drop the
+    dependency resolutions like for repartition(), if the partitions
+    changed, and to let the launches with equal arg accesses adopt them.
+    \return true if the partitions changed
+    \sa adoptPlan, PartitionPlanner::calibrate
+*/
+bool KernelLaunch::replan() {
+	lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+	replanPending_ = false;
+	auto plan = planPartitions(PartitionPlanner::getCostModel());
+	if (isEqualSplit(plan.second, parts_)) {
+		return false;
+	}
+	parting_ = plan.first;
+	parts_ = Partition::commit(plan.second);
+	resetPartitionData();
+	return true;
+}
+
+//! Takes the partitions of a launch with equal arg accesses \sa replan
+void KernelLaunch::adoptPlan(const KernelLaunch& other) {
+	lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+	replanPending_ = false;
+	if (parts_ == other.parts_) {
+		return;
+	}
+	parting_ = other.parting_;
+	parts_ = other.parts_;
+	resetPartitionData();
+}
+
+//! All launches with equal arg accesses on the same devices, including this one
+vector<shared_ptr<KernelLaunch>> KernelLaunch::getEqualLaunches() const {
+	lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+	vector<shared_ptr<KernelLaunch>> res;
+	for (const auto& other : all) {
+		if (hasEqualArgAccess(*other) && hasEqualDeviceRange(*other)) {
+			res.push_back(other);
+		}
+	}
+	return res;
+}
+
+/*! \brief Returns the launch, which executes the next iteration of this
+           launch with temporal blocking.
+
+    Stencils, which swap their input and output buffers between two
+    launches, exchange their halos after every iteration. With temporal
+    blocking the two launches run a cycle of `depth` phases: phase i widens
+    the partitions by depth - 1 - i blocks, thus a device computes the
+    halos of the following phases redundantly and reads only data, which
+    it wrote itself. Only the first phase of a cycle receives the halos of
+    all phases at once \sa DepResolution::memCpyIntersections. The
+    dependency resolutions within a cycle are empty and skip their
+    synchronization \sa DepResolution::isLocal.
+
+    The blocking is exact, if the halo of one iteration fits into one
+    block. The dependency resolutions copy what a phase actually reads,
+    thus wider halos and phases in any order stay correct, they only
+    exchange more data. The phases are launches of their own: they have
+    their own ids, arg accesses and dependency resolutions, but they are
+    not in `all`. A phase never takes the arg accesses of the base launch,
+    as their partitions differ \sa hasEqualPartitions. Launches with load balancing, a pending replan or the
+    block-cyclic mode are not blocked.
+    Only for launches of getOrInsert.
+    \return this launch, if it is not blocked
+    \sa setTemporalBlocking
+*/
+shared_ptr<KernelLaunch> KernelLaunch::getBlockingPhase() {
+	lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+	auto self = MEKONG_launchArena->share(id_);
+	if (blockingDepth_ < 2 || balancer_ || replanPending_ ||
+	    Partition::getCycleLength() > 0 || getNumDevUsed() < 2) {
+		return self;
+	}
+	if (!cycle_ && !joinBlockingCycle()) {
+		return self;
+	}
+	if (cycle_->depth < 2) {
+		return self;
+	}
+	if (phases_.empty()) {
+		// the phases launch one partition per device
+		auto base = Partition::coalesce(parts_);
+		for (unsigned phase = 0; phase < cycle_->depth; ++phase) {
+			KernelLaunch kl(*this, Partition::commit(
+				Partition::extend(base, orgGrid_, cycle_->depth - 1 - phase)));
+			unsigned id = MEKONG_launchArena->create(move(kl));
+			phases_.push_back(MEKONG_launchArena->share(id));
+			phases_.back()->id_ = id;
+		}
+	}
+	return phases_[cycle_->step++ % phases_.size()];
+}
+
+//! Phases per blocking cycle, 1 if this launch is not blocked
+unsigned KernelLaunch::getBlockingDepth() const {
+	return cycle_ ? cycle_->depth : 1;
+}
+
+//! True if `other` reads what this launch writes and vice versa
+bool KernelLaunch::isSwapPartner(const KernelLaunch& other) const {
+	auto feeds = [] (const KernelLaunch& from, const KernelLaunch& to) {
+		vector<MEdeviceptr> reads = to.getReads();
+		for (auto ptr : from.getWrites()) {
+			if (find(reads.begin(), reads.end(), ptr) != reads.end()) {
+				return true;
+			}
+		}
+		return false;
+	};
+	return this != &other && hasEqualArgAccess(other) &&
+	       feeds(*this, other) && feeds(other, *this);
+}
+
+/*! \brief Shares the blocking cycle with the swap partner of this launch.
+
+    The first launch of a pair picks the depth, the partner takes it. The
+    search is repeated only if new launches were created. Needs
+    MEKONG_launchMutex.
+    \return false if there is no partner yet
+*/
+bool KernelLaunch::joinBlockingCycle() {
+	if (blockingChecked_ == all.size()) {
+		return false;
+	}
+	blockingChecked_ = all.size();
+	for (const auto& other : all) {
+		if (!isSwapPartner(*other) || !isEqualSplit(other->parts_, parts_)) {
+			continue;
+		}
+		if (!other->cycle_) {
+			other->cycle_ = make_shared<BlockingCycle>();
+			other->cycle_->depth = pickBlockingDepth(Partition::coalesce(parts_));
+		}
+		cycle_ = other->cycle_;
+		return true;
+	}
+	return false;
+}
+
+/*! \brief Picks the blocking depth with the least predicted time per
+           iteration.
+
+    Deeper cycles synchronize less often, but receive wider halos and
+    compute more redundant blocks. The first phase of a cycle reads the
+    widest halo and the last one of the partner wrote only the own
+    partitions.
+    \param base one partition per device
+    \sa PartitionPlanner::predictBlockingTime
+*/
+unsigned KernelLaunch::pickBlockingDepth(const vector<shared_ptr<const Partition>>& base) const {
+	unsigned best = 1;
+	double bestTime = 0;
+	for (unsigned depth = 1; depth <= blockingDepth_; ++depth) {
+		vector<vector<shared_ptr<const Partition>>> phases;
+		for (unsigned phase = 0; phase < depth; ++phase) {
+			phases.push_back(Partition::extend(base, orgGrid_, depth - 1 - phase));
+		}
+		double time = PartitionPlanner::predictBlockingTime(
+			phases, estimateExchange(phases.front(), phases.back()),
+			PartitionPlanner::getCostModel());
+		if (depth == 1 || time < bestTime) {
+			best = depth;
+			bestTime = time;
+		}
+	}
+	return best;
+}
+
+//! True until the measured times of this launch refined its partitions
+bool KernelLaunch::isReplanPending() const {
+	return replanPending_;
+}
+
+//! Number of devices, which execute a partition of this launch
+unsigned short KernelLaunch::getNumDevUsed() const {
+	int res = 0;
+	for (const auto& part : parts_) {
+		res = max(res, part->getDevice() + 1 - devFirst_);
+	}
+	return res;
+}
+
+/*! \brief Moves this launch to the devices `first` up to `first + count - 1`
+           and plans its partitions again.
+
+    The caller has to migrate the data and to drop the dependency
+    resolutions like for repartition().
+    \return true if the device range changed
+    \sa DeviceGroups
+*/
+bool KernelLaunch::setDeviceRange(unsigned short first, unsigned short count) {
+	lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+	if (first == devFirst_ && count == devCount_) {
+		return false;
+	}
+	if (count == 0 || first + count > aliasH_->getNumDev()) {
+		throw invalid_argument("SPACE Mekong, CLASS KernelLaunch, FUNC "
+		                       "setDeviceRange(): the range exceeds the devices");
+	}
+	devFirst_ = first;
+	devCount_ = count;
+	if (PartitionPlanner::isEnabled() || PartitionPlanner::isDeviceCountSelection()) {
+		auto plan = planPartitions(PartitionPlanner::getCostModel());
+		parting_ = plan.first;
+		parts_ = Partition::commit(plan.second);
+	}
+	else {
+		parts_ = Partition::commit(
+			Partition::createPartitions(orgGrid_, orgBlock_, devFirst_, devCount_,
+			                            parting_, getDevWeights(devCount_)));
+	}
+	resetPartitionData();
+	return true;
+}
+
+//! The first device of the device range of this launch \sa setDeviceRange
+unsigned short KernelLaunch::getFirstDev() const {
+	return devFirst_;
+}
+
+//! Weights of the first `numDev` devices of the device range
+vector<double> KernelLaunch::getDevWeights(unsigned short numDev) const {
+	const vector<double>& weights = aliasH_->getDevWeights();
+	if (weights.empty()) {
+		return {};
+	}
+	return vector<double>(weights.begin() + devFirst_,
+	                      weights.begin() + devFirst_ + numDev);
+}
+
+/*! \brief Estimates the data every device receives per iteration with the
+           partitions `parts`.
+
+    The elements, which a device writes into a buffer, are owned by it.
+    Everything else it reads from that buffer has to come from another
+    device, e.g. the halos of a stencil, whose launches swap their input
+    and output buffers. Every interval of the linearized remainder is one
+    copy. Buffers, which no launch writes, are broadcast and never
+    exchanged.
+    \sa PartitionPlanner
+*/
+vector<PartitionPlanner::Exchange>
+KernelLaunch::estimateExchange(const vector<shared_ptr<const Partition>>& parts) const {
+	return estimateExchange(parts, parts);
+}
+
+/*! \brief Estimates the data every device receives, if it reads with the
+           partitions `parts` the data written with the partitions `owners`.
+
+    E.g. the first phase of a blocking cycle reads a wide halo, the last
+    phase wrote only the own partitions \sa getBlockingPhase
+*/
+vector<PartitionPlanner::Exchange>
+KernelLaunch::estimateExchange(const vector<shared_ptr<const Partition>>& parts,
+                               const vector<shared_ptr<const Partition>>& owners) const {
+	// The write args of this kernel, which write the buffer of a read arg.
+	// Launches with equal arg accesses write with the same maps, but maybe
+	// at another arg, e.g. the partner of a stencil, which swaps its
+	// buffers. A buffer written only by other kernels is received completely.
+	vector<vector<unsigned short>> writers(args_.size());
+	vector<bool> exchanged(args_.size(), false);
+	{
+		lock_guard<recursive_mutex> lock(MEKONG_launchMutex);
+		vector<const KernelLaunch*> equal = { this };
+		for (const auto& other : all) {
+			if (other.get() != this && hasEqualArgAccess(*other)) {
+				equal.push_back(other.get());
+			}
+		}
+		for (unsigned short readNr = 0; readNr < args_.size(); ++readNr) {
+			auto type = args_[readNr]->getType();
+			if (type->getPtrlvl() != 1 || !type->isRead()) {
+				continue;
+			}
+			MEdeviceptr ptr = args_[readNr]->asDevPtr();
+			for (unsigned short writeNr = 0; writeNr < args_.size(); ++writeNr) {
+				auto writeType = args_[writeNr]->getType();
+				if (writeType->getPtrlvl() != 1 || !writeType->isModified()) {
+					continue;
+				}
+				for (const auto* kl : equal) {
+					if (kl->args_[writeNr]->asDevPtr() == ptr) {
+						writers[readNr].push_back(writeNr);
+						break;
+					}
+				}
+			}
+			exchanged[readNr] = !writers[readNr].empty();
+			for (auto it = all.begin(); it != all.end() && !exchanged[readNr]; ++it) {
+				vector<MEdeviceptr> writes = (*it)->getWrites();
+				exchanged[readNr] = find(writes.begin(), writes.end(), ptr) != writes.end();
+			}
+		}
+	}
+
+	isl_ctx* ctx = IslContext::get().getCtx();
+	vector<PartitionPlanner::Exchange> res(aliasH_->getNumDev());
+	for (unsigned short gpuId = 0; gpuId < res.size(); ++gpuId) {
+		// the elements every write arg owns on this device, calculated once
+		vector<isl_set*> owned(args_.size(), nullptr);
+		vector<bool> ownedDone(args_.size(), false);
+		auto getOwned = [&] (unsigned short writeNr) {
+			if (!ownedDone[writeNr]) {
+				isl_union_map* accFuncMap = getInfo()->getAccFunc(writeNr)->
+					getWriteIslMap(ctx, &args_, &orgGrid_, &orgBlock_);
+				isl_set* written = accessedSet(accFuncMap, owners, gpuId);
+				isl_union_map_free(accFuncMap);
+				// the tuple ids name the args, thus drop them to compare the
+				// elements of one buffer accessed by different args
+				owned[writeNr] = written ? isl_set_reset_tuple_id(written) : nullptr;
+				ownedDone[writeNr] = true;
+			}
+			return owned[writeNr];
+		};
+
+		for (unsigned short argNr = 0; argNr < args_.size(); ++argNr) {
+			if (!exchanged[argNr]) {
+				continue;
+			}
+			auto type = args_[argNr]->getType();
+			isl_union_map* accFuncMap = getInfo()->getAccFunc(argNr)->
+				getReadIslMap(ctx, &args_, &orgGrid_, &orgBlock_);
+			isl_set* read = accessedSet(accFuncMap, parts, gpuId);
+			isl_union_map_free(accFuncMap);
+			if (!read) {
+				continue;
+			}
+			read = isl_set_reset_tuple_id(read);
+			bool subtracted = false;
+			for (unsigned short writeNr : writers[argNr]) {
+				isl_set* written = getOwned(writeNr);
+				if (written && isl_set_dim(written, isl_dim_set) == isl_set_dim(read, isl_dim_set)) {
+					read = isl_set_subtract(read, isl_set_copy(written));
+					subtracted = true;
+				}
+			}
+			if (subtracted) {
+				read = isl_set_make_disjoint(read);
+				read = isl_set_coalesce(read);
+			}
+			for (const auto& interval : linearize(read, argNr)) {
+				res[gpuId].bytes += (get<1>(interval) - get<0>(interval)) * type->getElSize();
+				++res[gpuId].copies;
+			}
+		}
+		for (auto* set : owned) {
+			if (set) {
+				isl_set_free(set);
+			}
+		}
+	}
+	return res;
 }
 
 //! Slim constructor without partition creation.
@@ -924,7 +1866,23 @@ KernelLaunch::KernelLaunch(MEfunction func, const Array3& grid,
 			 func_(func),
 			 shMem_(shMem),
 			 info_(info), 
-			 args_(KernelArg::createArgs(info->getArgTypes(), rawArgs)),
+			 args_(KernelArg::createArgs(info->getArgTypes(), rawArgs)) {}
+
+//! Copies the configuration of `base`, but launches the partitions `parts`
+//! \sa getBlockingPhase
+KernelLaunch::KernelLaunch(const KernelLaunch& base,
+                           const vector<shared_ptr<const Partition>>& parts) :
+			 orgGrid_(base.orgGrid_),
+			 orgBlock_(base.orgBlock_),
+			 shMem_(base.shMem_),
+			 func_(base.func_),
+			 info_(base.info_),
+			 args_(base.args_),
+			 aliasH_(base.aliasH_),
+			 parting_(base.parting_),
+			 parts_(parts),
+			 devFirst_(base.devFirst_),
+			 devCount_(base.devCount_),
 			 readAccs_(args_.size(), nullptr),
 			 writeAccs_(args_.size(), nullptr) {}
 
@@ -1013,7 +1971,7 @@ __isl_give isl_union_map* KernelLaunch::partIntoUnionMap(shared_ptr<const Partit
 
 	// UNION THE RESULTS IN AN isl_union_map OBJECT
 	isl_union_map* umap_bounded = isl_union_map_from_map(mapVec[0]);
-	for (int i = 1; i < mapVec.size(); ++i) {
+	for (size_t i = 1; i < mapVec.size(); ++i) {
 		umap_bounded = isl_union_map_union(umap_bounded, isl_union_map_from_map(mapVec[i]));
 	}
 
@@ -1068,12 +2026,8 @@ isl_stat KernelLaunch::addPoint(__isl_take isl_point* point, void* points) {
 	vector<size_t> coords;
 	isl_space* space = isl_point_get_space(point);
 	unsigned numDim = isl_space_dim(space, isl_dim_out);
-	if (numDim > 2) {
-		throw runtime_error("SPACE Mekong, CLASS AccFunc, FUNC addPoint():\n"
-		                    "Polly array with dim > 2 are not supported");
-	}
 
-	for (int dim = 0; dim < numDim; ++dim) {
+	for (unsigned dim = 0; dim < numDim; ++dim) {
 		isl_val* val = isl_point_get_coordinate_val(point, isl_dim_out, dim);
 		coords.push_back(isl_val_get_num_si(val));
 		isl_val_free(val);
@@ -1084,7 +2038,52 @@ isl_stat KernelLaunch::addPoint(__isl_take isl_point* point, void* points) {
 	return isl_stat_ok;
 }
 
-//! Extract the intervals contained in a two dimensional isl basic set
+/*! \brief Appends the intervals of a basic set, whose dimensions before
+           `dim` are fixed already.
+
+    \param base linear index of the fixed dimensions
+*/
+static void bsetToIntervals(__isl_keep isl_basic_set* bset, unsigned dim,
+                            size_t base, const vector<size_t>& strides,
+                            vector<tuple<size_t, size_t>>* intervals) {
+	// the outer dimensions are fixed, thus the lexicographic minimum and
+	// maximum are the bounds of dimension dim
+	isl_set* minset = isl_basic_set_lexmin(isl_basic_set_copy(bset));
+	isl_set* maxset = isl_basic_set_lexmax(isl_basic_set_copy(bset));
+	isl_point* minpt = isl_set_sample_point(minset);
+	isl_point* maxpt = isl_set_sample_point(maxset);
+
+	isl_val* minv = isl_point_get_coordinate_val(minpt, isl_dim_out, dim);
+	isl_val* maxv = isl_point_get_coordinate_val(maxpt, isl_dim_out, dim);
+
+	long min = isl_val_get_num_si(minv);
+	long max = isl_val_get_num_si(maxv) + 1; // + 1, as maximum is exclusive
+
+	isl_point_free(minpt);
+	isl_point_free(maxpt);
+	isl_val_free(minv);
+	isl_val_free(maxv);
+
+	// the innermost dimension is contiguous in memory
+	if (dim + 1 == strides.size()) {
+		intervals->push_back(make_tuple(base + min, base + max));
+		return;
+	}
+
+	for (long v = min; v < max; ++v) {
+		isl_val* islVal = isl_val_int_from_si(isl_basic_set_get_ctx(bset), v);
+		isl_basic_set* fbset = isl_basic_set_fix_val(isl_basic_set_copy(bset),
+		                                             isl_dim_out, dim, islVal);
+		// a convex set can still have integer holes between its bounds
+		if (isl_basic_set_is_empty(fbset) == isl_bool_false) {
+			bsetToIntervals(fbset, dim + 1, base + v * strides[dim], strides,
+			                intervals);
+		}
+		isl_basic_set_free(fbset);
+	}
+}
+
+//! Extract the intervals contained in a n dimensional isl basic set
 
 //! E.g. assume we have the following 2D array with an x-axis
 //! size of dimSize = 17. In this array lives an isl basic set
@@ -1101,55 +2100,15 @@ isl_stat KernelLaunch::addPoint(__isl_take isl_point* point, void* points) {
 //!    * * * * * * * * * * * * * * * * * 
 //!    * * * * * * * * * * * * * * * * * 
 //!
+//! A 3D set is cut into such 2D slices along its outermost dimension,
+//! and so on. The intervals are sorted, if the basic set is.
 //!
-isl_stat KernelLaunch::bset_2D_to_1D_intervals(__isl_take isl_basic_set* bset, void* dimSize_intervals) {
-
-	size_t dimSize = get<0>(*((tuple<size_t, vector<tuple<size_t, size_t>>*>*) dimSize_intervals));
-	auto* intervals = get<1>(*((tuple<size_t, vector<tuple<size_t, size_t>>*>*) dimSize_intervals));
-
-	auto bsetFix_Y_Val = [] (size_t val, __isl_keep isl_basic_set* bs) {
-		isl_val* islVal = isl_val_int_from_ui(isl_basic_set_get_ctx(bs), val);
-		return isl_basic_set_fix_val(isl_basic_set_copy(bs), isl_dim_out, 0, islVal);
-	};
-
-	isl_set* minset = isl_basic_set_lexmin(isl_basic_set_copy(bset));
-	isl_set* maxset = isl_basic_set_lexmax(isl_basic_set_copy(bset));
-	isl_point* minpt = isl_set_sample_point(minset);
-	isl_point* maxpt = isl_set_sample_point(maxset);
+isl_stat KernelLaunch::bset_nD_to_1D_intervals(__isl_take isl_basic_set* bset, void* strides_intervals) {
 
-	isl_val* minv_y = isl_point_get_coordinate_val(minpt, isl_dim_out, 0);
-	isl_val* maxv_y = isl_point_get_coordinate_val(maxpt, isl_dim_out, 0);
+	auto* strides = get<0>(*((tuple<vector<size_t>*, vector<tuple<size_t, size_t>>*>*) strides_intervals));
+	auto* intervals = get<1>(*((tuple<vector<size_t>*, vector<tuple<size_t, size_t>>*>*) strides_intervals));
 
-	long min_y = isl_val_get_num_si(minv_y);
-	long max_y = isl_val_get_num_si(maxv_y) + 1; // + 1, as maximum is exclusive
-
-	isl_point_free(minpt);
-	isl_point_free(maxpt);
-	isl_val_free(minv_y);
-	isl_val_free(maxv_y);
-
-	for (size_t y = min_y; y < max_y; ++y) {
-		isl_basic_set* fbset = bsetFix_Y_Val(y, bset);
-		minset = isl_basic_set_lexmin(isl_basic_set_copy(fbset));
-		maxset = isl_basic_set_lexmax(isl_basic_set_copy(fbset));
-		minpt = isl_set_sample_point(minset);
-		maxpt = isl_set_sample_point(maxset);
-
-		isl_val* minv_x = isl_point_get_coordinate_val(minpt, isl_dim_out, 1);
-		isl_val* maxv_x = isl_point_get_coordinate_val(maxpt, isl_dim_out, 1);
-
-		long min_x = isl_val_get_num_si(minv_x);
-		long max_x = isl_val_get_num_si(maxv_x) + 1; // + 1, as maximum is exclusive
-
-		intervals->push_back(make_tuple(min_x + y * dimSize, max_x + y * dimSize));
-
-		isl_point_free(minpt);
-		isl_point_free(maxpt);
-		isl_val_free(minv_x);
-		isl_val_free(maxv_x);
-		isl_basic_set_free(fbset);
-	}
-	
+	bsetToIntervals(bset, 0, 0, *strides, intervals);
 	isl_basic_set_free(bset);
 
 	return isl_stat_ok;
@@ -9,6 +9,8 @@
 #include "mekong-cuda.h"
 #include "partitioning.h"
 #include "partition.h"
+#include "load_balancer.h"
+#include "partition_planner.h"
 
 #include <memory>
 #include <map>
@@ -35,6 +37,8 @@ using Duration = chrono::duration<double>;
 class KernelLaunch {
 	public:
 		typedef Partition::Array3 Array3;
+		//! id of launches, which are not created by getOrInsert
+		static const unsigned noId = ~0u;
 		// save all instances of this class as we want to
 		// calculate the arg accesses only once
 		struct equal_to;
@@ -52,15 +56,23 @@ class KernelLaunch {
 		             void** rawArgs, shared_ptr<const bsp_KernelInfo> info,
 		             shared_ptr<AliasHandle> aliasH);
 
+		static shared_ptr<KernelLaunch> getById(unsigned id);
+		static void setLoadBalancing(bool enable, double threshold,
+		                             unsigned patience);
+		static void setTemporalBlocking(unsigned maxDepth);
+
 		// IS- FUNCTIONS
 		bool isArg(MEdeviceptr ptr) const;
-		bool isArg(shared_ptr<const KernelArg> arg) const;
+		bool isArg(const shared_ptr<const KernelArg>& arg) const;
 		bool hasEqualArgAccess(const KernelLaunch& other) const;
+		bool hasEqualDeviceRange(const KernelLaunch& other) const;
+		bool hasEqualPartitions(const KernelLaunch& other) const;
+		bool hasConcurrentPartitions() const;
 		
 		// GET- FUNCTIONS
 		shared_ptr<const KernelArg>                getArg(MEdeviceptr ptr) const;
 		int                                        getArgId(MEdeviceptr ptr) const;
-		int                                        getArgId(shared_ptr<const KernelArg> arg) const;
+		int                                        getArgId(const shared_ptr<const KernelArg>& arg) const;
 		vector<MEdeviceptr>                        getWrites() const;
 		vector<MEdeviceptr>                        getReads() const;
 		vector<MEdeviceptr>                        getPtrs() const;
@@ -71,6 +83,7 @@ class KernelLaunch {
 		unsigned short                             getGPU(unsigned idx, unsigned idy, unsigned idz) const;
 		unsigned short                             getGPU(const Array3& id) const;
 		size_t                                     getExecs() const;
+		unsigned                                   getId() const;
 		const vector<shared_ptr<const KernelArg>>& getArgs()  const;
 		shared_ptr<const bsp_KernelInfo>           getInfo()  const;
 		const Array3&                              getGrid()  const;
@@ -89,8 +102,32 @@ class KernelLaunch {
 		shared_ptr<const ArgAccess>                getReadArgAccess(unsigned short argNr);
 		shared_ptr<const ArgAccess>                getWriteArgAccess(unsigned short argNr);
 		shared_ptr<MemCpyDtoH>                     getWrittenData(MEdeviceptr ptr, void* hptr);
+		shared_ptr<MemCpyDtoH>                     getWrittenData(MEdeviceptr ptr, void* hptr,
+		                                                          size_t offset, size_t size,
+		                                                          bool broadcastBase);
+		void                                       precomputeWrittenData();
+		vector<PartitionPlanner::Exchange>
+		estimateExchange(const vector<shared_ptr<const Partition>>& parts) const;
+		vector<PartitionPlanner::Exchange>
+		estimateExchange(const vector<shared_ptr<const Partition>>& parts,
+		                 const vector<shared_ptr<const Partition>>& owners) const;
+
+		shared_ptr<LoadBalancer>                   getBalancer() const;
+		vector<double>                             getPartitionTimes();
 
 		void depsResolved();
+		void repartition(const vector<double>& weights);
+		bool replan();
+		void adoptPlan(const KernelLaunch& other);
+		bool isReplanPending() const;
+		unsigned short getNumDevUsed() const;
+		bool setDeviceRange(unsigned short first, unsigned short count);
+		unsigned short getFirstDev() const;
+		vector<shared_ptr<KernelLaunch>> getEqualLaunches() const;
+		shared_ptr<KernelLaunch> getBlockingPhase();
+		unsigned getBlockingDepth() const;
+		void checkLimits(const vector<MEdevLimits>& devLimits,
+		                 const vector<AliasHandle::FuncLimits>& funcLimits);
 
 		//! to save equal kernel launches in a std::set we need this functor
 		struct equal_to {
@@ -106,16 +143,28 @@ class KernelLaunch {
 		MEresult exec();
 
 	private:
-		static shared_ptr<KernelLaunch>
-		initBare(MEfunction func, const Array3& grid,
-		         const Array3& block, size_t shMem, void** rawArgs,
-		         shared_ptr<const bsp_KernelInfo> info);
-
 		KernelLaunch(MEfunction func, const Array3& grid, const Array3& block,
 		             size_t shMem, void** rawArgs,
 		             shared_ptr<const bsp_KernelInfo> info);
-
-		void setPartitions(shared_ptr<AliasHandle> aliasH);
+		KernelLaunch(const KernelLaunch& base,
+		             const vector<shared_ptr<const Partition>>& parts);
+
+		void initPartitioning(shared_ptr<AliasHandle> aliasH);
+		static bool isPlanned();
+		void setPartitions(const pair<shared_ptr<const Partitioning>,
+		                              vector<shared_ptr<const Partition>>>& plan);
+		const KernelLaunch* findEqualLaunch() const;
+		void choosePartitioning(const pair<shared_ptr<const Partitioning>,
+		                                   vector<shared_ptr<const Partition>>>& plan);
+		pair<shared_ptr<const Partitioning>, vector<shared_ptr<const Partition>>>
+		planPartitions(const PartitionPlanner::CostModel& model) const;
+		void resetPartitionData();
+		void orderPartitions();
+		vector<double> getDevWeights(unsigned short numDev) const;
+		void joinBalanceGroup();
+		bool isSwapPartner(const KernelLaunch& other) const;
+		bool joinBlockingCycle();
+		unsigned pickBlockingDepth(const vector<shared_ptr<const Partition>>& base) const;
 
 		static isl_stat partIntoMap(__isl_take isl_map* map,
 		                            void* partition_and_mapVec);
@@ -127,11 +176,19 @@ class KernelLaunch {
 		                                void* boundingPointsRaw);
 
 		static isl_stat addPoint(__isl_take isl_point*, void* points);
-		static isl_stat bset_2D_to_1D_intervals(__isl_take isl_basic_set* bset,
-		                                        void* dimSize_intervals);
+		static isl_stat bset_nD_to_1D_intervals(__isl_take isl_basic_set* bset,
+		                                        void* strides_intervals);
+
+		static __isl_give isl_set*
+		accessedSet(__isl_keep isl_union_map* accFuncMap,
+		            const vector<shared_ptr<const Partition>>& parts,
+		            unsigned short gpuId);
+		vector<tuple<size_t, size_t>> linearize(__isl_take isl_set* set,
+		                                        unsigned short argNr) const;
 
 		shared_ptr<const ArgAccess> getArgAccess(unsigned short argNr,
 		                                         bool getReadArgAccess);
+		shared_ptr<MemCpyDtoH> getWrittenPattern(unsigned short argId);
 
 		const Array3 orgGrid_;
 		const Array3 orgBlock_;
@@ -140,9 +197,17 @@ class KernelLaunch {
 		const shared_ptr<const bsp_KernelInfo> info_;
 		const vector<shared_ptr<const KernelArg>> args_;
 		shared_ptr<AliasHandle> aliasH_;
+		//! the scheme of parts_, the database's or a planned one
+		shared_ptr<const Partitioning> parting_;
 		vector<shared_ptr<const Partition>> parts_;
+		//! the devices of parts_ are in [devFirst_, devFirst_ + devCount_)
+		unsigned short devFirst_ = 0;
+		unsigned short devCount_ = 0;
 
+		//! index in the launch arena, set by getOrInsert
+		unsigned id_ = noId;
 		bool depResolved_ = false;
+		bool limitsChecked_ = false;
 		size_t executions_ = 0;
 
 		double time_ = 0;
@@ -154,7 +219,37 @@ class KernelLaunch {
 		vector<shared_ptr<const ArgAccess>> readAccs_;
 		vector<shared_ptr<const ArgAccess>> writeAccs_;
 
+		//! shared by all launches with equal arg accesses, if balancing is on
+		shared_ptr<LoadBalancer> balancer_;
+		vector<MEevent> partStart_; ///< timing events of every partition
+		vector<MEevent> partStop_;
+		bool timesPending_ = false; ///< the events of an execution were not read
+		vector<size_t> launchOrder_; ///< partition ids, boundary partitions first
+		vector<unsigned> partSlots_; ///< stream slot of every partition
+		static const unsigned noSlot = ~0u; ///< launched on the default stream
+		//! the partitions are planned again after the first measured times
+		bool replanPending_ = false;
+
+		static bool balancing_;
+		static double balanceThreshold_;
+		static unsigned balancePatience_;
+
+		//! shared by the two launches of a swap pair \sa getBlockingPhase
+		struct BlockingCycle {
+			unsigned depth = 1; ///< phases per cycle, 1 turns the blocking off
+			size_t step = 0;    ///< executions of both launches
+		};
+		shared_ptr<BlockingCycle> cycle_;
+		//! launches with widened partitions, phase i computes a halo of
+		//! depth - 1 - i blocks; created on demand
+		vector<shared_ptr<KernelLaunch>> phases_;
+		size_t blockingChecked_ = 0; ///< size of `all` at the last partner search
+		static unsigned blockingDepth_; ///< maximal depth, < 2 turns it off
+
 		map<unsigned short, shared_ptr<MemCpyDtoH>> argId2memcpy_;
+		// (arg id, offset, size, broadcast base) -> range restricted memcpy
+		map<tuple<unsigned short, size_t, size_t, bool>,
+		    shared_ptr<MemCpyDtoH>> range2memcpy_;
 };
 
 bool operator==(const KernelLaunch& a, const KernelLaunch& b); 
@@ -0,0 +1,461 @@
+/*! \file lazy_memcpy.cc
+    \brief Device to host memory copies, which complete on the first access
+           of the host buffer.
+    \sa lazy_memcpy.h
+*/
+#include "mekong-cuda.h"
+#include "alias_handle.h"
+#include "memory_copy.h"
+#include "copy_plan.h"
+#include "lazy_memcpy.h"
+
+#include <memory>
+#include <vector>
+#include <map>
+#include <list>
+#include <cstdint>
+#include <csignal>
+#include <cstring> // memcpy
+#include <stdexcept>
+#include <chrono>
+#include <algorithm>
+
+#include <sys/mman.h> // mprotect
+#include <unistd.h>   // sysconf
+
+namespace Mekong {
+
+using namespace std;
+
+using Clock = chrono::high_resolution_clock;
+using Duration = chrono::duration<double>;
+
+list<unique_ptr<LazyDtoH>> LazyDtoH::pending_;
+multimap<size_t, void*> LazyDtoH::stagingPool_;
+double LazyDtoH::waitTime_ = 0;
+size_t LazyDtoH::minSize_ = 0;
+MEresult LazyDtoH::handlerRes_;
+volatile sig_atomic_t LazyDtoH::protectFailed_ = 0;
+
+static struct sigaction MEKONG_oldSegvAction;
+
+static uintptr_t pageSize() {
+	static const uintptr_t size = sysconf(_SC_PAGESIZE);
+	return size;
+}
+
+static uintptr_t pageDown(uintptr_t addr) {
+	return addr & ~(pageSize() - 1);
+}
+
+static uintptr_t pageUp(uintptr_t addr) {
+	return pageDown(addr + pageSize() - 1);
+}
+
+//! Async signal safe, returns false if the protection could not be changed
+static bool protect(uintptr_t first, uintptr_t last, int prot) {
+	if (first >= last) {
+		return true;
+	}
+	return mprotect((void*) first, last - first, prot) == 0;
+}
+
+LazyDtoH::LazyDtoH(shared_ptr<const MemCpyDtoH::MemPattern> pattern,
+                   shared_ptr<const CopyPlan> plan,
+                   unsigned char* dst, MEdeviceptr src, size_t size,
+                   shared_ptr<AliasHandle> aliasH) :
+	pattern_(pattern),
+	plan_(plan),
+	aliasH_(aliasH),
+	dst_(dst),
+	src_(src),
+	size_(size),
+	firstPage_(pageUp((uintptr_t) dst)),
+	lastPage_(pageDown((uintptr_t) dst + size)),
+	events_(aliasH->getNumDev(), nullptr),
+	done_(pattern->size(), false),
+	faultGpus_(aliasH->getNumDev(), false) {
+	// the sub copies outside of the whole pages were copied eagerly
+	for (size_t i = 0; i < pattern->size(); ++i) {
+		uintptr_t first = (uintptr_t) dst + (*pattern)[i].to;
+		done_[i] = first + (*pattern)[i].size <= firstPage_ || lastPage_ <= first;
+	}
+}
+
+LazyDtoH::~LazyDtoH() {
+	for (auto event : events_) {
+		if (event != nullptr) {
+			meEventDestroy(event);
+		}
+	}
+	if (staging_ != nullptr) {
+		putStaging(staging_, stagingSize_);
+	}
+}
+
+/*! \brief Starts the copy of `cpy` asynchronously and returns immediately.
+
+    `size` is the size of the host buffer, which starts at the destination
+    pointer of `cpy`. Pending copies into the same host memory are completed
+    first, as they would overwrite the new data otherwise. Small buffers
+    are copied eagerly \sa isLazy.
+*/
+MEresult LazyDtoH::submit(shared_ptr<MemCpyDtoH> cpy, size_t size,
+                          shared_ptr<AliasHandle> aliasH) {
+	MEresult res = reap();
+	unsigned char* dst = (unsigned char*) cpy->getDst();
+	res &= completeHost(dst, size);
+	if (size == 0 || cpy->getPattern()->empty()) {
+		return res;
+	}
+	if (!isLazy(dst, size)) {
+		res &= cpy->exec();
+		return res;
+	}
+	installHandler();
+	// the partial pages at both ends are not ours, they are copied before
+	// the lazy copies are enqueued, thus they do not wait for them
+	uintptr_t firstPage = pageUp((uintptr_t) dst);
+	uintptr_t lastPage = pageDown((uintptr_t) dst + size);
+	res &= copyEagerly(*cpy, 0, firstPage - (uintptr_t) dst, aliasH);
+	res &= copyEagerly(*cpy, lastPage - (uintptr_t) dst, size, aliasH);
+	unique_ptr<LazyDtoH> lazy(new LazyDtoH(cpy->getPattern(), cpy->getPlan(),
+	                                       dst, cpy->getSrc(), size, aliasH));
+	res &= lazy->issue();
+	if (!res.isSuccess()) {
+		return res;
+	}
+	if (!lazy->isDone()) {
+		lazy->protectPending();
+		pending_.push_back(move(lazy));
+	}
+	res &= reap();
+	return res;
+}
+
+//! Copies the host Bytes [first, last) of `cpy` synchronously
+MEresult LazyDtoH::copyEagerly(const MemCpyDtoH& cpy, size_t first, size_t last,
+                               shared_ptr<AliasHandle> aliasH) {
+	shared_ptr<MemCpyDtoH::MemPattern> pattern(new MemCpyDtoH::MemPattern);
+	for (const auto& subcpy : *cpy.getPattern()) {
+		size_t from = max(first, subcpy.to);
+		size_t to = min(last, subcpy.to + subcpy.size);
+		if (from < to) {
+			MemSubCopy clipped = subcpy;
+			clipped.from += from - subcpy.to;
+			clipped.to = from;
+			clipped.size = to - from;
+			pattern->push_back(clipped);
+		}
+	}
+	if (pattern->empty()) {
+		return MEresult();
+	}
+	MemCpyDtoH eager(cpy.getDst(), cpy.getSrc(), pattern, aliasH);
+	return eager.exec();
+}
+
+//! Issues the sub copies into the staging buffer and records one event per gpu
+MEresult LazyDtoH::issue() {
+	MEresult res;
+	staging_ = (unsigned char*) getStaging(size_, &stagingSize_);
+	// the plan keeps the host offsets, thus it can copy into the staging buffer
+	res &= plan_->exec(CopyBuffer::onHost(staging_), CopyBuffer::onDevice(src_),
+	                   *aliasH_, false);
+	for (const auto& op : plan_->getOps()) {
+		if (events_[op.src] == nullptr) {
+			res &= meCtxPushCurrent(aliasH_->getCtx().at(op.src));
+			res &= meEventCreate(&events_[op.src]);
+			res &= meCtxPopCurrent(nullptr);
+		}
+	}
+	// the events mark the end of all copies of a gpu
+	for (size_t gpu = 0; gpu < events_.size(); ++gpu) {
+		if (events_[gpu] != nullptr) {
+			res &= meCtxPushCurrent(aliasH_->getCtx().at(gpu));
+			res &= meEventRecord(events_[gpu], 0);
+			res &= meCtxPopCurrent(nullptr);
+		}
+	}
+	return res;
+}
+
+/*! \brief Waits for the given gpus and moves their data to the host buffer.
+
+    Afterwards only the pages, which still contain data of other gpus, are
+    protected. Called by the signal handler, thus it does not allocate and
+    does not throw.
+*/
+MEresult LazyDtoH::completeGPUs(const vector<bool>& gpus) {
+	MEresult res;
+	auto timestamp = Clock::now();
+	for (size_t gpu = 0; gpu < gpus.size(); ++gpu) {
+		// the events are destroyed with the copy, not by the signal handler
+		if (gpus[gpu] && events_[gpu] != nullptr) {
+			res &= meEventSynchronize(events_[gpu]);
+		}
+	}
+	if (!protect(firstPage_, lastPage_, PROT_READ | PROT_WRITE)) {
+		protectFailed_ = 1;
+	}
+	// only the whole pages are ours, the rest was copied eagerly and the
+	// host code may have changed it since
+	for (size_t i = 0; i < pattern_->size(); ++i) {
+		const auto& subcpy = (*pattern_)[i];
+		if (!done_[i] && gpus[subcpy.src]) {
+			uintptr_t first = max((uintptr_t) dst_ + subcpy.to, firstPage_);
+			uintptr_t last = min((uintptr_t) dst_ + subcpy.to + subcpy.size, lastPage_);
+			size_t offset = first - (uintptr_t) dst_;
+			memcpy(dst_ + offset, staging_ + offset, last - first);
+			done_[i] = true;
+		}
+	}
+	// pending copies into neighbouring buffers may share pages with us
+	for (auto& lazy : pending_) {
+		lazy->protectPending();
+	}
+	protectPending();
+	Duration waitTime = Clock::now() - timestamp;
+	waitTime_ += waitTime.count();
+	return res;
+}
+
+//! Completes the sub copies, which write to the page starting at `page`
+MEresult LazyDtoH::completePage(uintptr_t page) {
+	return completeRange(page, page + pageSize());
+}
+
+//! Completes the sub copies, which write to the addresses [first, last)
+MEresult LazyDtoH::completeRange(uintptr_t first, uintptr_t last) {
+	if (first >= last) {
+		return MEresult();
+	}
+	fill(faultGpus_.begin(), faultGpus_.end(), false);
+	bool any = false;
+	for (size_t i = 0; i < pattern_->size(); ++i) {
+		const auto& subcpy = (*pattern_)[i];
+		uintptr_t from = (uintptr_t) dst_ + subcpy.to;
+		uintptr_t to = from + subcpy.size;
+		if (!done_[i] && from < last && first < to) {
+			faultGpus_[subcpy.src] = true;
+			any = true;
+		}
+	}
+	return any ? completeGPUs(faultGpus_) : MEresult();
+}
+
+//! Completes all sub copies
+MEresult LazyDtoH::complete() {
+	return completeGPUs(vector<bool>(events_.size(), true));
+}
+
+//! Protects every whole page of the host buffer, which is touched by a not
+//! completed sub copy
+void LazyDtoH::protectPending() const {
+	for (size_t i = 0; i < pattern_->size(); ++i) {
+		if (done_[i]) {
+			continue;
+		}
+		const auto& subcpy = (*pattern_)[i];
+		uintptr_t first = (uintptr_t) dst_ + subcpy.to;
+		uintptr_t last = pageUp(first + subcpy.size);
+		if (!protect(max(pageDown(first), firstPage_), min(last, lastPage_), PROT_NONE)) {
+			protectFailed_ = 1;
+		}
+	}
+}
+
+bool LazyDtoH::isDone() const {
+	return find(done_.begin(), done_.end(), false) == done_.end();
+}
+
+bool LazyDtoH::containsPage(uintptr_t page) const {
+	return firstPage_ <= page && page < lastPage_;
+}
+
+//! True if the host buffer overlaps the addresses [first, last)
+bool LazyDtoH::overlaps(uintptr_t first, uintptr_t last) const {
+	return first < (uintptr_t) dst_ + size_ && (uintptr_t) dst_ < last;
+}
+
+//! Completes all pending copies, whose host buffers overlap the host range
+MEresult LazyDtoH::completeHost(const void* ptr, size_t size) {
+	MEresult res = reap();
+	uintptr_t first = (uintptr_t) ptr;
+	for (auto it = pending_.begin(); it != pending_.end();) {
+		if ((*it)->overlaps(first, first + size)) {
+			res &= (*it)->complete();
+			it = pending_.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	return res;
+}
+
+/*! \brief Completes all pending copies reading from the device buffer `ptr`.
+
+    Must be called before the buffer is freed. Kernel launches and memory
+    copies writing to the buffer are enqueued behind the pending copies in
+    the same stream, thus they do not need to call this function.
+*/
+MEresult LazyDtoH::completeDevice(MEdeviceptr ptr) {
+	MEresult res = reap();
+	for (auto it = pending_.begin(); it != pending_.end();) {
+		if ((*it)->src_ == ptr) {
+			res &= (*it)->complete();
+			it = pending_.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	return res;
+}
+
+/*! \brief Completes all pending copies and frees the staging buffers,
+           e.g. before the contexts are destroyed.
+*/
+MEresult LazyDtoH::completeAll() {
+	MEresult res = reap();
+	for (auto& lazy : pending_) {
+		res &= lazy->complete();
+	}
+	pending_.clear();
+	releaseStaging();
+	res &= reap();
+	return res;
+}
+
+/*! \brief Drops the copies, which the signal handler completed, and
+           reports its errors.
+
+    \throw runtime_error if the protection of a host buffer could not be
+           changed
+*/
+MEresult LazyDtoH::reap() {
+	MEresult res = handlerRes_;
+	handlerRes_ = MEresult();
+	for (auto it = pending_.begin(); it != pending_.end();) {
+		if ((*it)->isDone()) {
+			it = pending_.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	if (protectFailed_) {
+		protectFailed_ = 0;
+		throw runtime_error("SPACE Mekong, CLASS LazyDtoH, FUNC reap(): "
+		                    "could not change the protection of the host "
+		                    "buffer");
+	}
+	return res;
+}
+
+size_t LazyDtoH::getNumPending() {
+	return pending_.size();
+}
+
+//! Returns the time the host code waited for lazy copies in seconds
+double LazyDtoH::getWaitTime() {
+	return waitTime_;
+}
+
+//! Host buffers smaller than `minSize` Bytes are copied eagerly
+void LazyDtoH::setMinSize(size_t minSize) {
+	minSize_ = minSize;
+}
+
+//! True if a copy into the host buffer is deferred \sa submit
+bool LazyDtoH::isLazy(const void* ptr, size_t size) {
+	uintptr_t first = (uintptr_t) ptr;
+	return size >= minSize_ && pageUp(first) < pageDown(first + size);
+}
+
+/*! \brief Handles the access of the host code to a protected page.
+
+    Signals caused by other addresses are passed to the handler, which was
+    installed before. The completed copies stay in `pending_` until the
+    next reap().
+*/
+void LazyDtoH::onSegFault(int sig, siginfo_t* info, void* context) {
+	uintptr_t page = pageDown((uintptr_t) info->si_addr);
+	for (auto& lazy : pending_) {
+		if (!lazy->isDone() && lazy->containsPage(page)) {
+			handlerRes_ &= lazy->completePage(page);
+			return; // the faulting instruction will be repeated
+		}
+	}
+	// not our business
+	if (MEKONG_oldSegvAction.sa_flags & SA_SIGINFO) {
+		if (MEKONG_oldSegvAction.sa_sigaction != nullptr) {
+			MEKONG_oldSegvAction.sa_sigaction(sig, info, context);
+			return;
+		}
+	}
+	else if (MEKONG_oldSegvAction.sa_handler != SIG_DFL &&
+	         MEKONG_oldSegvAction.sa_handler != SIG_IGN) {
+		MEKONG_oldSegvAction.sa_handler(sig);
+		return;
+	}
+	// the repeated instruction will fault again and terminate the program
+	signal(sig, SIG_DFL);
+}
+
+void LazyDtoH::installHandler() {
+	static bool installed = false;
+	if (installed) {
+		return;
+	}
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_sigaction = onSegFault;
+	action.sa_flags = SA_SIGINFO;
+	sigemptyset(&action.sa_mask);
+	if (sigaction(SIGSEGV, &action, &MEKONG_oldSegvAction) != 0) {
+		throw runtime_error("SPACE Mekong, CLASS LazyDtoH, "
+		                    "FUNC installHandler(): could not install the "
+		                    "signal handler");
+	}
+	installed = true;
+}
+
+/*! \brief Returns a page locked buffer with at least `size` Bytes.
+
+    Allocating page locked memory is expensive, thus we keep the buffers of
+    completed copies for later copies.
+    \param capacity will be the real size of the returned buffer
+*/
+void* LazyDtoH::getStaging(size_t size, size_t* capacity) {
+	auto it = stagingPool_.lower_bound(size);
+	if (it != stagingPool_.end()) {
+		void* staging = it->second;
+		*capacity = it->first;
+		stagingPool_.erase(it);
+		return staging;
+	}
+	*capacity = size;
+	void* staging = nullptr;
+	MEresult res = meMemAllocHost(&staging, size);
+	if (!res.isSuccess()) {
+		throw runtime_error("SPACE Mekong, CLASS LazyDtoH, FUNC getStaging(): "
+		                    "could not allocate page locked memory");
+	}
+	return staging;
+}
+
+void LazyDtoH::putStaging(void* staging, size_t size) {
+	stagingPool_.insert(make_pair(size, staging));
+}
+
+//! Frees the page locked buffers of the pool
+void LazyDtoH::releaseStaging() {
+	for (auto& entry : stagingPool_) {
+		meMemFreeHost(entry.second);
+	}
+	stagingPool_.clear();
+}
+
+}; // namespace end
@@ -0,0 +1,110 @@
+/*! \file lazy_memcpy.h
+    \brief Device to host memory copies, which complete on the first access
+           of the host buffer.
+
+    A lazy copy issues the sub copies of a MemCpyDtoH asynchronously into a
+    page locked staging buffer and protects the pages of the host buffer. The
+    first access of the host code to a protected page raises a SIGSEGV. Our
+    signal handler waits for the GPUs, whose data lies on that page, moves
+    their data from the staging buffer to the host buffer and removes the
+    protection. Thus the host code continues while the GPUs still compute and
+    copy.
+
+    Only the whole pages inside the host buffer are protected, the partial
+    pages at its start and end may hold other data of the host code (e.g.
+    the malloc bookkeeping or the stack), thus they are copied eagerly.
+    Buffers smaller than a minimum size are copied eagerly as a whole.
+    System calls, which access a protected host buffer (e.g. read(2) or
+    write(2)) fail with EFAULT instead of raising a signal. Turn off
+    USER_OPTION_LAZY_DTOH for such applications.
+
+    The signal handler neither allocates nor throws: it only waits for the
+    GPUs, copies from the staging buffer and changes the protection. The
+    finished copies are dropped and errors are reported by the next call of
+    this class.
+*/
+
+#ifndef MEKONG_LAZY_MEMCPY_H
+#define MEKONG_LAZY_MEMCPY_H
+
+#include <memory>
+#include <vector>
+#include <map>
+#include <list>
+#include <cstdint>
+#include <csignal>
+
+#include "mekong-cuda.h"
+#include "alias_handle.h"
+#include "memory_copy.h"
+#include "copy_plan.h"
+
+namespace Mekong {
+
+using namespace std;
+
+//! One device to host memory copy, which was not completed yet
+class LazyDtoH {
+	public:
+		static MEresult submit(shared_ptr<MemCpyDtoH> cpy, size_t size,
+		                       shared_ptr<AliasHandle> aliasH);
+		static MEresult completeHost(const void* ptr, size_t size);
+		static MEresult completeDevice(MEdeviceptr ptr);
+		static MEresult completeAll();
+		static size_t getNumPending();
+		static double getWaitTime();
+		static void setMinSize(size_t minSize);
+		static bool isLazy(const void* ptr, size_t size);
+
+		~LazyDtoH();
+
+	private:
+		LazyDtoH(shared_ptr<const MemCpyDtoH::MemPattern> pattern,
+		         shared_ptr<const CopyPlan> plan,
+		         unsigned char* dst, MEdeviceptr src, size_t size,
+		         shared_ptr<AliasHandle> aliasH);
+
+		static void onSegFault(int sig, siginfo_t* info, void* context);
+		static void installHandler();
+		static void* getStaging(size_t size, size_t* capacity);
+		static void putStaging(void* staging, size_t size);
+		static void releaseStaging();
+		static MEresult copyEagerly(const MemCpyDtoH& cpy, size_t first, size_t last,
+		                            shared_ptr<AliasHandle> aliasH);
+		static MEresult reap();
+
+		MEresult issue();
+		MEresult completePage(uintptr_t page);
+		MEresult completeRange(uintptr_t first, uintptr_t last);
+		MEresult completeGPUs(const vector<bool>& gpus);
+		MEresult complete();
+		bool isDone() const;
+		bool containsPage(uintptr_t page) const;
+		bool overlaps(uintptr_t first, uintptr_t last) const;
+		void protectPending() const;
+
+		shared_ptr<const MemCpyDtoH::MemPattern> pattern_; ///< bookkeeping of the completion
+		shared_ptr<const CopyPlan> plan_;                   ///< issues the copies
+		shared_ptr<AliasHandle> aliasH_;
+		unsigned char* dst_;
+		MEdeviceptr src_;
+		size_t size_;
+		unsigned char* staging_ = nullptr;
+		size_t stagingSize_ = 0;
+		uintptr_t firstPage_; ///< first whole page inside the host buffer
+		uintptr_t lastPage_;  ///< one behind the last whole page inside it
+		vector<MEevent> events_; ///< one per gpu, nullptr if not involved
+		vector<bool> done_;      ///< one per sub copy
+		vector<bool> faultGpus_; ///< scratch of the signal handler, one per gpu
+
+		static list<unique_ptr<LazyDtoH>> pending_;
+		static multimap<size_t, void*> stagingPool_;
+		static double waitTime_;
+		static size_t minSize_;
+		static MEresult handlerRes_; ///< result of the copies completed by the handler
+		static volatile sig_atomic_t protectFailed_;
+};
+
+}; // namespace end
+
+#endif
@@ -0,0 +1,144 @@
+#include "load_balancer.h"
+#include "partition.h"
+
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm> // std::max_element, std::find
+
+namespace Mekong {
+
+using namespace std;
+
+//! weight of a new measurement in the smoothed times
+static const double MEKONG_smoothing = 0.5;
+
+/*! \param threshold relative imbalance (max / mean - 1) of the partition
+           times, which triggers a rebalance, e.g. 0.1
+    \param patience number of measurements in a row above the threshold
+*/
+LoadBalancer::LoadBalancer(double threshold, unsigned patience)
+		: threshold_(threshold),
+		  patience_(max(patience, 1u)) {}
+
+/*! \brief Adds the partition times of one execution.
+
+    \param times seconds of every partition
+    \param blocks number of blocks of every partition
+    \return true if the group should be re-partitioned with getWeights()
+*/
+bool LoadBalancer::addMeasurement(const vector<double>& times,
+                                  const vector<double>& blocks) {
+	if (times.size() != blocks.size() || times.empty()) {
+		throw invalid_argument("SPACE Mekong, CLASS LoadBalancer, FUNC "
+		                       "addMeasurement(): need one time per partition");
+	}
+	if (warmup_ > 0) {
+		--warmup_;
+		return false;
+	}
+	if (times_.size() != times.size()) {
+		times_ = times;
+	}
+	else {
+		for (size_t i = 0; i < times.size(); ++i) {
+			times_[i] = MEKONG_smoothing * times[i] + (1 - MEKONG_smoothing) * times_[i];
+		}
+	}
+
+	if (getImbalance() <= threshold_) {
+		strikes_ = 0;
+		return false;
+	}
+	if (++strikes_ < patience_) {
+		return false;
+	}
+	strikes_ = 0;
+
+	// throughput of every device; a partition without a measurable time
+	// gets the best throughput
+	vector<double> rates(times_.size(), 0);
+	double bestRate = 0;
+	for (size_t i = 0; i < times_.size(); ++i) {
+		if (times_[i] > 0) {
+			rates[i] = blocks[i] / times_[i];
+			bestRate = max(bestRate, rates[i]);
+		}
+	}
+	if (bestRate == 0) {
+		return false;
+	}
+	for (auto& rate : rates) {
+		if (rate == 0) {
+			rate = bestRate;
+		}
+	}
+
+	// predict the time of the slowest partition with the new split
+	double total = 0;
+	for (double b : blocks) {
+		total += b;
+	}
+	vector<unsigned> split = Partition::splitWeighted(total, rates.size(), rates);
+	double predicted = 0;
+	for (size_t i = 0; i < split.size(); ++i) {
+		predicted = max(predicted, split[i] / rates[i]);
+	}
+	double current = *max_element(times_.begin(), times_.end());
+	if (predicted > current * (1 - threshold_ / 2)) {
+		return false;
+	}
+
+	weights_ = move(rates);
+	times_.clear();
+	warmup_ = patience_;
+	++rebalances_;
+	return true;
+}
+
+//! Weights for Partition::createPartitions, empty before the first rebalance
+const vector<double>& LoadBalancer::getWeights() const {
+	return weights_;
+}
+
+//! Adds a kernel launch, which shares the partitions of the group
+void LoadBalancer::addMember(unsigned id) {
+	if (find(members_.begin(), members_.end(), id) == members_.end()) {
+		members_.push_back(id);
+	}
+}
+
+//! Ids of all kernel launches of the group \sa KernelLaunch::getById
+const vector<unsigned>& LoadBalancer::getMembers() const {
+	return members_;
+}
+
+//! Relative imbalance of the smoothed partition times, max / mean - 1
+double LoadBalancer::getImbalance() const {
+	if (times_.empty()) {
+		return 0;
+	}
+	double sum = 0;
+	for (double t : times_) {
+		sum += t;
+	}
+	double mean = sum / times_.size();
+	return mean > 0 ? *max_element(times_.begin(), times_.end()) / mean - 1 : 0;
+}
+
+//! Number of proposed re-partitionings
+size_t LoadBalancer::getRebalances() const {
+	return rebalances_;
+}
+
+ostream& operator<<(ostream& out, const LoadBalancer& balancer) {
+	out << "LoadBalancer(" << balancer.getMembers().size() << " launches, "
+	    << balancer.getRebalances() << " rebalances, weights:";
+	for (double w : balancer.getWeights()) {
+		out << " " << w;
+	}
+	out << ")";
+	return out;
+}
+
+}; // namespace end
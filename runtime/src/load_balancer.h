@@ -0,0 +1,59 @@
+/*! \file load_balancer.h
+    \brief Decides from measured partition times, when and how to re-partition.
+*/
+
+#ifndef MEKONG_LOAD_BALANCER_H
+#define MEKONG_LOAD_BALANCER_H
+
+#include <vector>
+#include <ostream>
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Balances a group of kernel launches, which share their partitions.
+
+    Launches with equal arg accesses (e.g. the two launches of a stencil,
+    which swap their input and output buffer) have equal partitions, thus
+    they are balanced together. Every execution of a member reports the
+    time of each partition. The balancer smooths the times and computes the
+    throughput of every device in blocks per second. If the slowest
+    partition takes longer than the mean by more than the threshold for
+    `patience` measurements in a row, it proposes weights proportional to
+    the throughput. Shifting blocks between neighbouring devices is only
+    worth its data migration, if the predicted time of the slowest
+    partition drops by at least half the threshold. After a re-partitioning
+    the balancer waits for `patience` fresh measurements, which avoids
+    thrashing between two splits.
+    \sa Partition::createPartitions
+*/
+class LoadBalancer {
+	public:
+		LoadBalancer(double threshold, unsigned patience);
+
+		bool addMeasurement(const vector<double>& times,
+		                    const vector<double>& blocks);
+
+		const vector<double>& getWeights() const;
+		void addMember(unsigned id);
+		const vector<unsigned>& getMembers() const;
+		double getImbalance() const;
+		size_t getRebalances() const;
+
+	private:
+		double threshold_;   ///< relative imbalance, which triggers a rebalance
+		unsigned patience_;  ///< measurements above threshold before acting
+		unsigned strikes_ = 0;
+		unsigned warmup_ = 1; ///< measurements to skip, e.g. the first execution
+		size_t rebalances_ = 0;
+		vector<double> times_;   ///< smoothed time of every partition
+		vector<double> weights_; ///< the weights of the current partitions
+		vector<unsigned> members_; ///< ids of the kernel launches of the group
+};
+
+ostream& operator<<(ostream& out, const LoadBalancer& balancer);
+
+}; // namespace end
+
+#endif
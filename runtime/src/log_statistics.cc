@@ -312,6 +312,34 @@ double Statistics::getLaunchCreationTime() const {
 	return kernelLaunchCreationTime_;
 }
 
+/*! \brief Returns the amount of Bytes, which were not uploaded because
+           the host data did not change since the last upload.
+    \sa USER_OPTION_ELIDE_REDUNDANT_HTOD in the user configuration
+*/
+size_t Statistics::getElidedHtoDSize() const {
+	return elidedHtoDSize_;
+}
+
+//! Returns the number of skipped host to device copies.
+size_t Statistics::getNumElidedHtoD() const {
+	return numElidedHtoD_;
+}
+
+/*! \brief Returns the amount of Bytes copied by lazy device to host copies.
+
+    Lazy copies are not part of the other memory copy statistics, as their
+    time is spent in the background.
+    \sa LazyDtoH
+*/
+size_t Statistics::getLazyDtoHSize() const {
+	return lazyDtoHSize_;
+}
+
+//! Returns the number of lazy device to host copies.
+size_t Statistics::getNumLazyDtoH() const {
+	return numLazyDtoH_;
+}
+
 void Statistics::setNumDev(unsigned numDev) {
 	numDev_ = numDev;
 }
@@ -344,4 +372,16 @@ void Statistics::addCpyDtoD(shared_ptr<const MemCpyDtoD> mc) {
 	dev2dev_.insert(mc);
 }
 
+void Statistics::addLazyDtoH(shared_ptr<const MemCpyDtoH> mc) {
+	for (const auto& subcpy : *mc->getPattern()) {
+		lazyDtoHSize_ += subcpy.size;
+	}
+	++numLazyDtoH_;
+}
+
+void Statistics::addElidedHtoD(size_t bytes) {
+	elidedHtoDSize_ += bytes;
+	++numElidedHtoD_;
+}
+
 }; // namespace end
@@ -50,6 +50,10 @@ class Statistics {
 		size_t getDepResCpySize() const;
 		size_t getNumMemCpy() const;
 		size_t getNumMemCpy(MemCpyKind kind) const;
+		size_t getElidedHtoDSize() const;
+		size_t getNumElidedHtoD() const;
+		size_t getLazyDtoHSize() const;
+		size_t getNumLazyDtoH() const;
 		unsigned getNumArgAccessCalls() const;
 		unsigned getNumArgAccessCalcs() const;
 		unsigned getNumDepResExecs() const;
@@ -72,12 +76,18 @@ class Statistics {
 		void addCpyDtoH(shared_ptr<const MemCpyDtoH> mc);
 		void addCpyHtoD(shared_ptr<const MemCpyHtoD> mc);
 		void addCpyDtoD(shared_ptr<const MemCpyDtoD> mc);
+		void addElidedHtoD(size_t bytes);
+		void addLazyDtoH(shared_ptr<const MemCpyDtoH> mc);
 
 	private:
 
 		unsigned numDev_ = 0;
 		double depResCreationTime_ = 0;
 		double kernelLaunchCreationTime_ = 0;
+		size_t elidedHtoDSize_ = 0;
+		size_t numElidedHtoD_ = 0;
+		size_t lazyDtoHSize_ = 0;
+		size_t numLazyDtoH_ = 0;
 		unordered_set<shared_ptr<DepResolution>> resolutions_;
 		unordered_set<shared_ptr<KernelLaunch>> launches_;
 		unordered_set<shared_ptr<const MemCpyDtoH>> dev2host_;
@@ -12,6 +12,11 @@ MEresult::MEresult(MErawresult res) : res_(res) {}
 
 MEresult::MEresult(const MEresult& other) { res_ = other.res_; }
 
+MEresult& MEresult::operator=(const MEresult& other) {
+	res_ = other.res_;
+	return *this;
+}
+
 bool MEresult::isSuccess() const {
 	return res_ == CUDA_SUCCESS;
 }
@@ -71,6 +76,10 @@ MEresult meModuleLoad(MEmodule* module, const char* fname) {
 	return cuModuleLoad(module, fname);
 }
 
+MEresult meModuleLoadData(MEmodule* module, const void* image) {
+	return cuModuleLoadData(module, image);
+}
+
 MEresult meModuleGetFunction(MEfunction* hfunc, MEmodule hmod, const char* name) {
 	return cuModuleGetFunction(hfunc, hmod, name);
 }
@@ -103,10 +112,68 @@ MEresult meMemcpyDtoDAsync(MEdeviceptr dst, MEdeviceptr src, size_t size, MEstre
 	return cuMemcpyDtoDAsync(dst, src, size, hStream);
 }
 
+//! Copies `height` rows of `width` Bytes. A host pointer unequal nullptr
+//! selects host memory, otherwise the device pointer is used.
+MEresult meMemcpy2DAsync(void* dstHost, MEdeviceptr dstDev, size_t dstPitch,
+                         const void* srcHost, MEdeviceptr srcDev, size_t srcPitch,
+                         size_t width, size_t height, MEstream hStream) {
+	CUDA_MEMCPY2D cpy = {};
+	cpy.srcMemoryType = srcHost ? CU_MEMORYTYPE_HOST : CU_MEMORYTYPE_DEVICE;
+	cpy.srcHost = srcHost;
+	cpy.srcDevice = srcDev;
+	cpy.srcPitch = srcPitch;
+	cpy.dstMemoryType = dstHost ? CU_MEMORYTYPE_HOST : CU_MEMORYTYPE_DEVICE;
+	cpy.dstHost = dstHost;
+	cpy.dstDevice = dstDev;
+	cpy.dstPitch = dstPitch;
+	cpy.WidthInBytes = width;
+	cpy.Height = height;
+	return cuMemcpy2DAsync(&cpy, hStream);
+}
+
 MEresult meMemFree(MEdeviceptr dptr) {
 	return cuMemFree(dptr);
 }
 
+//! Allocates page locked host memory, which is usable from every context
+MEresult meMemAllocHost(void** ptr, size_t size) {
+	return cuMemHostAlloc(ptr, size, CU_MEMHOSTALLOC_PORTABLE);
+}
+
+MEresult meMemFreeHost(void* ptr) {
+	return cuMemFreeHost(ptr);
+}
+
+MEresult meEventCreate(MEevent* event, bool timing) {
+	return cuEventCreate(event, timing ? CU_EVENT_DEFAULT
+	                                   : CU_EVENT_DISABLE_TIMING);
+}
+
+MEresult meEventRecord(MEevent event, MEstream hStream) {
+	return cuEventRecord(event, hStream);
+}
+
+MEresult meEventSynchronize(MEevent event) {
+	return cuEventSynchronize(event);
+}
+
+MEresult meEventDestroy(MEevent event) {
+	return cuEventDestroy(event);
+}
+
+MEresult meEventElapsedTime(float* ms, MEevent start, MEevent end) {
+	return cuEventElapsedTime(ms, start, end);
+}
+
+//! Creates a blocking stream, it synchronizes with the default stream
+MEresult meStreamCreate(MEstream* stream) {
+	return cuStreamCreate(stream, CU_STREAM_DEFAULT);
+}
+
+MEresult meStreamWaitEvent(MEstream hStream, MEevent event) {
+	return cuStreamWaitEvent(hStream, event, 0);
+}
+
 
 MEresult meLaunchKernel(MEfunction f,
 						unsigned gridDimX,
@@ -168,4 +235,89 @@ size_t meShMemPerBlockLimit(MEdevice dev) {
 	return prop.sharedMemPerBlock;
 }
 
+//! All limits of `dev` with only one query of the device properties
+MEdevLimits meGetDevLimits(MEdevice dev) {
+	CUdevprop prop;
+	MEresult res;
+	res &= cuDeviceGetProperties(&prop, dev);
+	if (!res.isSuccess()) {
+		throw runtime_error("Error when checking device limits. You can turn this check off.");
+	}
+	MEdevLimits limits;
+	for (int dim = 0; dim < 3; ++dim) {
+		limits.grid[dim] = prop.maxGridSize[dim];
+		limits.block[dim] = prop.maxThreadsDim[dim];
+	}
+	limits.threadsPerBlock = prop.maxThreadsPerBlock;
+	limits.shMemPerBlock = prop.sharedMemPerBlock;
+	return limits;
+}
+
+/*! \brief Estimated peak throughput of `dev` in cores times kHz.
+
+    Derived from the compute capability, the number of multiprocessors and
+    the clock rate. Only the ratio between two devices is meaningful.
+*/
+double meGetDevThroughput(MEdevice dev) {
+	int major, minor, sms, clock;
+	MEresult res;
+	res &= cuDeviceGetAttribute(&major, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR, dev);
+	res &= cuDeviceGetAttribute(&minor, CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MINOR, dev);
+	res &= cuDeviceGetAttribute(&sms, CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT, dev);
+	res &= cuDeviceGetAttribute(&clock, CU_DEVICE_ATTRIBUTE_CLOCK_RATE, dev);
+	if (!res.isSuccess()) {
+		throw runtime_error("Error when querying the device throughput.");
+	}
+	// cores per multiprocessor
+	int cores;
+	switch (major) {
+		case 2: cores = minor == 0 ? 32 : 48; break;
+		case 3: cores = 192; break;
+		case 5: cores = 128; break;
+		case 6: cores = minor == 0 ? 64 : 128; break;
+		case 7: cores = 64; break;
+		case 8: cores = minor == 0 ? 64 : 128; break;
+		default: cores = 128; break;
+	}
+	return (double) sms * cores * clock;
+}
+
+/*! \brief PCI bus id of `dev` in the format domain:bus:device.function,
+           e.g. "0000:3b:00.0".
+
+    Devices behind the same PCIe switch or CPU socket have neighbouring
+    bus ids, thus sorting by the id groups them.
+*/
+string meDeviceGetPCIBusId(MEdevice dev) {
+	char id[32] = { 0 };
+	MEresult res;
+	res &= cuDeviceGetPCIBusId(id, sizeof(id), dev);
+	if (!res.isSuccess()) {
+		throw runtime_error("Error when querying the PCI bus id.");
+	}
+	return string(id);
+}
+
+//! Threads per block of `func`, which can be less than the device limit
+size_t meFuncThreadsPerBlockLimit(MEfunction func) {
+	int val;
+	MEresult res;
+	res &= cuFuncGetAttribute(&val, CU_FUNC_ATTRIBUTE_MAX_THREADS_PER_BLOCK, func);
+	if (!res.isSuccess()) {
+		throw runtime_error("Error when checking function limits. You can turn this check off.");
+	}
+	return val;
+}
+
+//! Statically allocated shared memory of `func` in Bytes
+size_t meFuncStaticShMem(MEfunction func) {
+	int val;
+	MEresult res;
+	res &= cuFuncGetAttribute(&val, CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES, func);
+	if (!res.isSuccess()) {
+		throw runtime_error("Error when checking function limits. You can turn this check off.");
+	}
+	return val;
+}
+
 } // namespace end
@@ -8,6 +8,7 @@
 #define MEKONG_CUDA_H
 
 #include <array>
+#include <string>
 #include "cuda.h"
 
 namespace Mekong {
@@ -21,6 +22,7 @@ typedef CUcontext MEcontext;
 typedef CUfunction MEfunction;
 typedef CUdeviceptr MEdeviceptr;
 typedef CUstream MEstream;
+typedef CUevent MEevent;
 
 //! This class simplifies error propagation. You can call
 //! any cuda function which returns a CUresult. Moreover
@@ -37,6 +39,7 @@ class MEresult {
 		MEresult();
 		MEresult(MErawresult res);
 		MEresult(const MEresult& other);
+		MEresult& operator=(const MEresult& other);
 
 		bool isSuccess() const;
 		MErawresult getRaw() const;
@@ -49,6 +52,14 @@ class MEresult {
 
 };
 
+//! Limits of a device, which restrict the kernel configuration
+struct MEdevLimits {
+	array<unsigned, 3> grid;  ///< blocks per grid dimension
+	array<unsigned, 3> block; ///< threads per block dimension
+	size_t threadsPerBlock;
+	size_t shMemPerBlock;     ///< shared memory per block in Bytes
+};
+
 MEresult operator&&(const MEresult& a, const MEresult& b);
 MEresult meInit(unsigned flags);
 MEresult meDeviceGetCount(int* count);
@@ -60,6 +71,7 @@ MEresult meCtxPushCurrent(MEcontext ctx);
 MEresult meCtxDestroy(MEcontext ctx);
 MEresult meCtxPopCurrent(MEcontext* ctx);
 MEresult meModuleLoad(MEmodule* module, const char* fname);
+MEresult meModuleLoadData(MEmodule* module, const void* image);
 MEresult meModuleGetFunction(MEfunction* hfunc, MEmodule hmod, const char* name);
 MEresult meMemAlloc(MEdeviceptr* dptr, size_t size);
 MEresult meMemcpyHtoD(MEdeviceptr dst, const void* src, size_t size);
@@ -68,7 +80,19 @@ MEresult meMemcpyDtoD(MEdeviceptr dst, MEdeviceptr src, size_t size);
 MEresult meMemcpyHtoDAsync(MEdeviceptr dst, const void* src, size_t size, MEstream hStream);
 MEresult meMemcpyDtoHAsync(void* dst, MEdeviceptr src, size_t size, MEstream hStream);
 MEresult meMemcpyDtoDAsync(MEdeviceptr dst, MEdeviceptr src, size_t size, MEstream hStream);
+MEresult meMemcpy2DAsync(void* dstHost, MEdeviceptr dstDev, size_t dstPitch,
+                         const void* srcHost, MEdeviceptr srcDev, size_t srcPitch,
+                         size_t width, size_t height, MEstream hStream);
 MEresult meMemFree(MEdeviceptr dptr);
+MEresult meMemAllocHost(void** ptr, size_t size);
+MEresult meMemFreeHost(void* ptr);
+MEresult meEventCreate(MEevent* event, bool timing = false);
+MEresult meEventRecord(MEevent event, MEstream hStream);
+MEresult meEventSynchronize(MEevent event);
+MEresult meEventDestroy(MEevent event);
+MEresult meEventElapsedTime(float* ms, MEevent start, MEevent end);
+MEresult meStreamCreate(MEstream* stream);
+MEresult meStreamWaitEvent(MEstream hStream, MEevent event);
 MEresult meLaunchKernel(MEfunction f,
 						unsigned gridDimX,
 						unsigned gridDimY,
@@ -84,6 +108,11 @@ array<unsigned, 3> meGetGridLimits(MEdevice dev);
 array<unsigned, 3> meGetBlockLimits(MEdevice dev);
 size_t meGetThreadsPerBlockLimit(MEdevice dev);
 size_t meShMemPerBlockLimit(MEdevice dev);
+MEdevLimits meGetDevLimits(MEdevice dev);
+double meGetDevThroughput(MEdevice dev);
+string meDeviceGetPCIBusId(MEdevice dev);
+size_t meFuncThreadsPerBlockLimit(MEfunction func);
+size_t meFuncStaticShMem(MEfunction func);
 
 } // namespace end
 
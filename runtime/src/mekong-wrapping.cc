@@ -4,11 +4,13 @@
     This file is the high level Ansatz to understand Mekong's runtime
     functionality. Here you can see the definitions of the functions, which
     will be used to substitute the original cuda driver functions. We use four
-    global variables to store the state of the running program. The analysis of
-    the kernels (bsp_database.h) and the user configuration file (user_config.h)
-    is statically linked while the runtime library is compiled. Thus you have to
-    recompile the runtime if you change the analysis of the kernels or the
-    runtime configuration file.
+    global variables to store the state of the running program. The user
+    configuration file (user_config.h) is statically linked while the runtime
+    library is compiled. The analysis of the kernels is either loaded from a
+    binary database at startup (USER_OPTION_ANALYSIS_DB or the environment
+    variable MEKONG_ANALYSIS_DB) or statically linked (bsp_database.h). In the
+    latter case you have to recompile the runtime if you change the analysis
+    of the kernels.
 
 */
 
@@ -18,9 +20,16 @@
 #include "virtual_buffer.h"
 #include "log_statistics.h"
 #include "kernel_launch.h"
+#include "device_groups.h"
+#include "topology.h"
 #include "user_config.h" // generated of $PROJECT_DIR/CONFIG.txt
 #include "dependency_resolution.h"
 #include "mekong-cuda.h"
+#include "content_hash.h"
+#include "lazy_memcpy.h"
+#include "worker_pool.h"
+#include "copy_plan.h"
+#include "analysis_db.h"
 #include "bsp_database.h" // generated of $PROJECT_DIR/bsp_analysis/dbs/kernel_info.dbb
 #include "communicator.h" // dominiks memcpy lib
 
@@ -36,6 +45,11 @@
 #include <memory>
 #include <stdexcept>
 #include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm> // std::find
+#include <cstdint>
+#include <cstdlib> // std::getenv, std::atexit
 
 
 using Clock = std::chrono::high_resolution_clock;
@@ -71,8 +85,10 @@ static Mekong::Log<char> MEKONG_log;
 #define LOG(text)
 #endif
 
-// Save the dependency resolution objects
-static std::unordered_set<std::shared_ptr<Mekong::DepResolution>>
+// Save the dependency resolution objects. The key combines the ids of the
+// master and the slave launch, which are unique.
+// \sa Mekong::KernelLaunch::getId
+static std::unordered_map<uint64_t, std::shared_ptr<Mekong::DepResolution>>
 MEKONG_depResolutions;
 
 // give one dev pointer to the alias handler and it will give you back the
@@ -82,9 +98,117 @@ static std::shared_ptr<Mekong::AliasHandle> MEKONG_aliasH(new Mekong::AliasHandl
 // here we store which kernel wrote last to a certain memory location
 static std::shared_ptr<Mekong::Buffer> MEKONG_buffer(new Mekong::Buffer);
 
-// contains the information of the static kernel analysis
+//! device groups of independent launches, set by wrapCtxCreate if enabled
+static std::unique_ptr<Mekong::DeviceGroups> MEKONG_deviceGroups;
+
+// Host to device copies, which were already executed once. The key is the
+// tuple (device pointer, host pointer, size). If the user uploads the same
+// host buffer into the same device buffer (e.g. inside an iterative loop), we
+// reuse the memcpy object and its pattern. The host buffer may have been
+// freed and reallocated at the same address in between, thus an entry is
+// only reused if the content hash of the host data still matches. The cache
+// holds at most USER_OPTION_HTOD_CACHE_SIZE entries.
+struct HtoDCacheEntry {
+	std::shared_ptr<Mekong::MemCpyHtoD> cpy;
+	uint64_t hash;    //!< content hash of the host data at the last upload
+	uint64_t lastUse; //!< value of MEKONG_htodCpysClock at the last upload
+};
+static std::map<std::tuple<Mekong::MEdeviceptr, const void*, size_t>,
+                HtoDCacheEntry> MEKONG_htodCpys;
+static uint64_t MEKONG_htodCpysClock = 0;
+
+// Size and content hash of the last upload into a device buffer. Only
+// used if USER_OPTION_ELIDE_REDUNDANT_HTOD is set.
+static std::map<Mekong::MEdeviceptr, std::pair<size_t, uint64_t>>
+MEKONG_uploadHashes;
+
+// Binary database of the static kernel analysis. The environment variable
+// MEKONG_ANALYSIS_DB overrides USER_OPTION_ANALYSIS_DB. If neither names a
+// file, the analysis compiled into the runtime (bsp_database.h) is used.
+static std::unique_ptr<Mekong::AnalysisDB> MEKONG_openAnalysisDB() {
+	const char* filename = std::getenv("MEKONG_ANALYSIS_DB");
+	if (filename == nullptr || *filename == '\0') {
+		filename = USER_OPTION_ANALYSIS_DB;
+	}
+	if (*filename == '\0') {
+		return nullptr;
+	}
+	return std::unique_ptr<Mekong::AnalysisDB>(new Mekong::AnalysisDB(filename));
+}
+static std::unique_ptr<Mekong::AnalysisDB> MEKONG_analysisDB(MEKONG_openAnalysisDB());
+
+// contains the information of the compiled in kernel analysis, which is
+// parsed on the first request of a kernel
 static std::vector<std::shared_ptr<const Mekong::bsp_KernelInfo>>
-MEKONG_kinfos(Mekong::bsp_KernelInfo::createKInfos(Mekong::bspAnalysisStr));
+MEKONG_kinfos;
+
+//! Returns the analysis of kernel `name` or nullptr if there is none
+static std::shared_ptr<const Mekong::bsp_KernelInfo>
+MEKONG_getKernelInfo(const std::string& name) {
+	if (MEKONG_analysisDB) {
+		return MEKONG_analysisDB->getKernelInfo(name);
+	}
+	if (MEKONG_kinfos.empty()) {
+		MEKONG_kinfos = Mekong::bsp_KernelInfo::createKInfos(Mekong::bspAnalysisStr);
+	}
+	for (auto kinfo : MEKONG_kinfos) {
+		if (kinfo->getName() == name) {
+			return kinfo;
+		}
+	}
+	return nullptr;
+}
+
+// Calculates the device to host memcpy patterns of new kernel launches while
+// the kernels are running. One thread is enough, as the arg access
+// calculation is serialized and already uses one thread per gpu. The tasks
+// use globals of other translation units, whose destruction order relative
+// to this pool is unspecified, thus the pool is joined at exit before any
+// global is destroyed \sa MEKONG_shutdown.
+static Mekong::WorkerPool MEKONG_workers(1);
+
+//! Joins the background threads, registered with atexit by wrapInit
+static void MEKONG_shutdown() {
+	MEKONG_workers.join();
+}
+
+// Relative speed of the devices, which the grid is split by. The
+// environment variable MEKONG_DEVICE_WEIGHTS overrides
+// USER_OPTION_DEVICE_WEIGHTS. "static" estimates the weights from the device
+// properties, a comma separated list (e.g. measured run times) gives one
+// weight per device and an empty string splits evenly.
+static std::vector<double>
+MEKONG_getDevWeights(const std::vector<Mekong::MEdevice>& devs) {
+	const char* spec = std::getenv("MEKONG_DEVICE_WEIGHTS");
+	if (spec == nullptr || *spec == '\0') {
+		spec = USER_OPTION_DEVICE_WEIGHTS;
+	}
+	std::vector<double> weights;
+	if (std::string(spec) == "static") {
+		for (auto d : devs) {
+			weights.push_back(Mekong::meGetDevThroughput(d));
+		}
+		return weights;
+	}
+	const char* curr = spec;
+	while (*curr != '\0') {
+		char* end;
+		weights.push_back(std::strtod(curr, &end));
+		if (end == curr || (*end != ',' && *end != '\0')) {
+			throw std::invalid_argument("SPACE Mekong, FUNC MEKONG_getDevWeights(): "
+			                            "can not parse device weights \""
+			                            + std::string(spec) + "\"");
+		}
+		curr = *end == ',' ? end + 1 : end;
+	}
+	if (!weights.empty() && weights.size() != devs.size()) {
+		throw std::invalid_argument("SPACE Mekong, FUNC MEKONG_getDevWeights(): "
+		                            "expected " + std::to_string(devs.size())
+		                            + " device weights, but got \""
+		                            + std::string(spec) + "\"");
+	}
+	return weights;
+}
 
 /************************
  * FUNCTION DEFINITIONS *
@@ -96,6 +220,26 @@ Mekong::MErawresult wrapInit(unsigned flags) {
 
 	Mekong::MEresult res;
 	res &= Mekong::meInit(flags);
+	// Handlers registered after the construction of the globals run
+	// before their destruction.
+	static bool shutdownRegistered = false;
+	if (!shutdownRegistered) {
+		std::atexit(MEKONG_shutdown);
+		shutdownRegistered = true;
+	}
+	Mekong::CopyPlan::setChunkSize(USER_OPTION_COPY_CHUNK_SIZE);
+	Mekong::DepResolution::setHaloPacking(USER_OPTION_PACK_HALOS);
+	Mekong::LazyDtoH::setMinSize(USER_OPTION_LAZY_DTOH_MIN_SIZE);
+	Mekong::Partition::setCycleLength(USER_OPTION_CYCLE_LENGTH);
+	Mekong::Partition::setOverDecomposition(USER_OPTION_OVER_DECOMPOSITION);
+	Mekong::PartitionPlanner::setEnabled(USER_OPTION_PICK_PARTITIONING);
+	Mekong::PartitionPlanner::setDeviceCountSelection(USER_OPTION_PICK_DEVICE_COUNT);
+	// the balancer expects one partition per device
+	Mekong::KernelLaunch::setLoadBalancing(USER_OPTION_LOAD_BALANCING &&
+	                                       USER_OPTION_CYCLE_LENGTH == 0,
+	                                       USER_OPTION_BALANCE_THRESHOLD,
+	                                       USER_OPTION_BALANCE_PATIENCE);
+	Mekong::KernelLaunch::setTemporalBlocking(USER_OPTION_TEMPORAL_BLOCKING);
 
 	LOG("[MEKONG] [-] FUNC wrapInit()\n")
 	return res.getRaw();
@@ -199,6 +343,95 @@ Mekong::MErawresult wrapDeviceComputeCapability(int* major, int* minor,
 	return res.getRaw();
 }
 
+/*! \brief Measures the bandwidth of every link between two devices with a
+           copy of `bytes` Bytes.
+
+    Every device copies to every other device, the first copy of a pair
+    sets up the link and is not timed. Takes a few milliseconds per pair.
+    \sa Mekong::Topology
+*/
+static Mekong::MEresult
+MEKONG_probeTopology(const std::vector<Mekong::MEcontext>& ctxs, size_t bytes,
+                     Mekong::Topology& topo) {
+	Mekong::MEresult res;
+	std::vector<Mekong::MEdeviceptr> bufs(ctxs.size(), 0);
+	for (size_t gpu = 0; gpu < ctxs.size(); ++gpu) {
+		res &= Mekong::meCtxPushCurrent(ctxs[gpu]);
+		res &= Mekong::meMemAlloc(&bufs[gpu], bytes);
+		res &= Mekong::meCtxPopCurrent(0);
+	}
+	for (size_t src = 0; src < ctxs.size() && res.isSuccess(); ++src) {
+		res &= Mekong::meCtxPushCurrent(ctxs[src]);
+		Mekong::MEevent start = nullptr, stop = nullptr;
+		res &= Mekong::meEventCreate(&start, true);
+		res &= Mekong::meEventCreate(&stop, true);
+		for (size_t dst = 0; dst < ctxs.size() && res.isSuccess(); ++dst) {
+			if (dst == src) {
+				continue;
+			}
+			res &= Mekong::meMemcpyDtoDAsync(bufs[dst], bufs[src], bytes, 0);
+			res &= Mekong::meEventRecord(start, 0);
+			res &= Mekong::meMemcpyDtoDAsync(bufs[dst], bufs[src], bytes, 0);
+			res &= Mekong::meEventRecord(stop, 0);
+			res &= Mekong::meEventSynchronize(stop);
+			float ms = 0;
+			res &= Mekong::meEventElapsedTime(&ms, start, stop);
+			if (res.isSuccess() && ms > 0) {
+				topo.setBandwidth(src, dst, bytes / (ms / 1e3));
+			}
+		}
+		Mekong::meEventDestroy(start);
+		Mekong::meEventDestroy(stop);
+		res &= Mekong::meCtxPopCurrent(0);
+	}
+	for (size_t gpu = 0; gpu < ctxs.size(); ++gpu) {
+		Mekong::meCtxPushCurrent(ctxs[gpu]);
+		if (bufs[gpu] != 0) {
+			Mekong::meMemFree(bufs[gpu]);
+		}
+		Mekong::meCtxPopCurrent(0);
+	}
+	return res;
+}
+
+/*! \brief Reorders the devices and their contexts, such that neighbouring
+           device indices, thus neighbouring partitions, share fast links.
+
+    Called once, before any buffer or module exists, thus the new order
+    holds for every launch.
+    \sa Mekong::Topology::place
+*/
+static void MEKONG_placeDevices(std::vector<Mekong::MEdevice>& devs,
+                                std::vector<Mekong::MEcontext>& ctxs) {
+	std::vector<std::string> busIds;
+	for (auto d : devs) {
+		busIds.push_back(Mekong::meDeviceGetPCIBusId(d));
+	}
+	Mekong::Topology topo(busIds);
+	if (USER_OPTION_TOPOLOGY_PROBE_BYTES > 0) {
+		Mekong::Topology probed(busIds);
+		if (MEKONG_probeTopology(ctxs, USER_OPTION_TOPOLOGY_PROBE_BYTES, probed).isSuccess()) {
+			topo = probed;
+		}
+		else {
+			LOG("  bandwidth probe failed, sorting the devices by bus id\n")
+		}
+	}
+	std::vector<unsigned short> order =
+		topo.place(Mekong::Topology::chainTraffic(devs.size()));
+	std::vector<Mekong::MEdevice> placedDevs;
+	std::vector<Mekong::MEcontext> placedCtxs;
+	for (auto gpu : order) {
+		placedDevs.push_back(devs[gpu]);
+		placedCtxs.push_back(ctxs[gpu]);
+		LOG("  device index " + std::to_string(placedDevs.size() - 1) + " -> "
+		    + busIds[gpu] + '\n')
+	}
+	LOG("  ") LOG(topo) LOG('\n')
+	devs = std::move(placedDevs);
+	ctxs = std::move(placedCtxs);
+}
+
 /*! \brief Creates one context per registered GPU.
 
     Creates one context for each device registered on key `dev`.
@@ -219,8 +452,40 @@ Mekong::MErawresult wrapCtxCreate(Mekong::MEcontext* ctx, unsigned flags,
 		++gpu;
 	}
 	LOG("[MEKONG] created " + std::to_string(ctxs.size()) + " contexts\n")
+	if (USER_OPTION_TOPOLOGY_AWARE && res.isSuccess()) {
+		MEKONG_placeDevices((*MEKONG_aliasH)[dev], ctxs);
+	}
 	*ctx = ctxs[0];
 	(*MEKONG_aliasH)[*ctx] = std::move(ctxs);
+
+	// query the device limits once instead of on every launch
+	if (USER_OPTION_CHECK_DEVICE_LIMITS) {
+		std::vector<Mekong::MEdevLimits> limits;
+		for (auto d : (*MEKONG_aliasH)[dev]) {
+			limits.push_back(Mekong::meGetDevLimits(d));
+		}
+		MEKONG_aliasH->setDevLimits(std::move(limits));
+	}
+	MEKONG_aliasH->setDevWeights(MEKONG_getDevWeights((*MEKONG_aliasH)[dev]));
+
+	if (USER_OPTION_DEVICE_GROUPS) {
+		MEKONG_deviceGroups.reset(new Mekong::DeviceGroups(MEKONG_aliasH->getNumDev()));
+	}
+
+	// the planner predicts compute times with the slowest device
+	if (USER_OPTION_PICK_PARTITIONING || USER_OPTION_PICK_DEVICE_COUNT) {
+		double rate = 0;
+		for (auto d : (*MEKONG_aliasH)[dev]) {
+			double r = Mekong::meGetDevThroughput(d);
+			rate = (rate == 0 || r < rate) ? r : rate;
+		}
+		if (rate > 0) {
+			Mekong::PartitionPlanner::CostModel model =
+				Mekong::PartitionPlanner::getCostModel();
+			model.threadRate = rate;
+			Mekong::PartitionPlanner::setCostModel(model);
+		}
+	}
 	LOG("[MEKONG] [-] FUNC wrapCtxCreate()\n")
 	return res.getRaw();
 }
@@ -258,9 +523,12 @@ Mekong::MErawresult wrapModuleLoad(Mekong::MEmodule* module, const char* name) {
 /*! \brief Gets a function for each registered module.
 
     The functions will be saved in a global variable and linked to
-    the value of `mod`.
+    the value of `mod`. The function record also stores the kernel
+    analysis and, if USER_OPTION_CHECK_DEVICE_LIMITS is set, the function
+    limits on every device.
     \param func will be the function loaded in the first registered module.
     \sa wrapModuleLoad loads all modules
+    \sa Mekong::AliasHandle::FuncRecord
 */
 Mekong::MErawresult wrapModuleGetFunction(Mekong::MEfunction* func,
                                           Mekong::MEmodule mod,
@@ -286,10 +554,23 @@ Mekong::MErawresult wrapModuleGetFunction(Mekong::MEfunction* func,
 	}
 
 	*func = funcs[0];
-	(*MEKONG_aliasH)[*func] = std::move(funcs);
 
-	// link function pointer to the function name
-	MEKONG_aliasH->atName(*func) = std::string(fname);
+	// Resolve everything a launch needs now, thus wrapLaunchKernel finds
+	// it with one lookup of the function handle.
+	auto& record = MEKONG_aliasH->getFuncRecord(*func);
+	record.name = std::string(fname);
+	record.info = MEKONG_getKernelInfo(fname);
+	if (record.info == nullptr) {
+		LOG("[MEKONG] there is no kernel analysis for ") LOG(fname) LOG('\n')
+	}
+	record.limits.clear();
+	if (USER_OPTION_CHECK_DEVICE_LIMITS && res.isSuccess()) {
+		for (auto f : funcs) {
+			record.limits.push_back({ Mekong::meFuncThreadsPerBlockLimit(f),
+			                          Mekong::meFuncStaticShMem(f) });
+		}
+	}
+	record.funcs = std::move(funcs);
 	LOG("[MEKONG] [-] FUNC wrapModuleGetFunction()\n")
 	return res.getRaw();
 }
@@ -331,23 +612,105 @@ Mekong::MErawresult wrapMemAlloc(Mekong::MEdeviceptr* ptr, size_t size) {
 
 /*! \brief Broadcasts the data to all buffers linked to `dstDevPtr`.
 
+    Memcpy objects are cached with the key (`dstDevPtr`, `srcHostPtr`,
+    `size`). Thus a repeated upload of the same host buffer into the same
+    device buffer reuses the object created by the first upload, as long as
+    the content hash of the host data did not change. At most
+    USER_OPTION_HTOD_CACHE_SIZE objects are cached. If the
+    distribution state of the device buffer did not change since the last
+    upload (no kernel wrote to it in between), we also skip the bookkeeping
+    in the virtual buffer and pay only for the raw copy.
+
+    If USER_OPTION_ELIDE_REDUNDANT_HTOD is set, we hash the host data of
+    uploads with at least USER_OPTION_ELIDE_HTOD_MIN_SIZE Bytes. The copy is
+    skipped completely if the hash equals the one of the last upload into the
+    same device buffer and no kernel wrote to the buffer in between.
     \sa wrapMemAlloc allocates memory on every device.
-    \todo if we recognize that the user calls the MemcpyHtoD
-          inside an iterative loop we should reuse the created
-          memcpy object. Thus we need another wrapping function
-          which searches for a created memcpy object.
+    \sa wrapMemFree invalidates the cached memcpy objects of a buffer.
 */
 Mekong::MErawresult wrapMemcpyHtoD(Mekong::MEdeviceptr dstDevPtr,
                                    void* srcHostPtr,
                                    size_t size) {
+	LOG("[MEKONG] [+] FUNC wrapMemcpyHtoD():\n")
 	Mekong::MEresult res;
-	// UP TO NOW WE COPY TO EVERY GPU
-	auto broadcast = Mekong::MemCpyHtoD::createBroadcast(dstDevPtr, srcHostPtr,
-	                                                     size, MEKONG_aliasH);
+
+	// the host data may still be on its way from the devices
+	if (USER_OPTION_LAZY_DTOH) {
+		res &= Mekong::LazyDtoH::completeHost(srcHostPtr, size);
+	}
+
+	uint64_t contentHash = 0;
+	bool hashed = false;
+	if (USER_OPTION_ELIDE_REDUNDANT_HTOD) {
+		if (size >= (size_t) USER_OPTION_ELIDE_HTOD_MIN_SIZE) {
+			contentHash = Mekong::hashContent(srcHostPtr, size);
+			hashed = true;
+			auto hash = std::make_pair(size, contentHash);
+			auto last = MEKONG_uploadHashes.find(dstDevPtr);
+			if (last != MEKONG_uploadHashes.end() && last->second == hash
+			    && MEKONG_buffer->isUntouchedBroadcast(dstDevPtr)) {
+				if (USER_OPTION_COLLECT_STATISTICS) {
+					MEKONG_statistics.addElidedHtoD(size);
+				}
+				LOG("  * host data did not change; skipped upload\n")
+				LOG("[MEKONG] [-] FUNC wrapMemcpyHtoD()\n")
+				return res.getRaw();
+			}
+			MEKONG_uploadHashes[dstDevPtr] = hash;
+		}
+		else {
+			// an unhashed upload may change the content of the buffer
+			MEKONG_uploadHashes.erase(dstDevPtr);
+		}
+	}
+
+	std::shared_ptr<Mekong::MemCpyHtoD> broadcast;
+	auto key = std::make_tuple(dstDevPtr, (const void*) srcHostPtr, size);
+	if (!hashed) {
+		contentHash = Mekong::hashContent(srcHostPtr, size);
+	}
+	auto cached = MEKONG_htodCpys.find(key);
+	if (cached != MEKONG_htodCpys.end() && cached->second.hash == contentHash) {
+		broadcast = cached->second.cpy;
+		cached->second.lastUse = ++MEKONG_htodCpysClock;
+		LOG("  * reusing memcpy object of a previous upload\n")
+	}
+	else {
+		// UP TO NOW WE COPY TO EVERY GPU
+		broadcast = Mekong::MemCpyHtoD::createBroadcast(dstDevPtr, srcHostPtr,
+		                                                size, MEKONG_aliasH);
+		if (cached == MEKONG_htodCpys.end()
+		    && MEKONG_htodCpys.size() >= (size_t) USER_OPTION_HTOD_CACHE_SIZE) {
+			// evict the least recently used object
+			auto oldest = MEKONG_htodCpys.begin();
+			for (auto it = MEKONG_htodCpys.begin();
+			     it != MEKONG_htodCpys.end(); ++it) {
+				if (it->second.lastUse < oldest->second.lastUse) {
+					oldest = it;
+				}
+			}
+			if (oldest != MEKONG_htodCpys.end()) {
+				MEKONG_htodCpys.erase(oldest);
+			}
+		}
+		if (USER_OPTION_HTOD_CACHE_SIZE > 0) {
+			MEKONG_htodCpys[key] = {broadcast, contentHash, ++MEKONG_htodCpysClock};
+		}
+		// the statistics count the executions of the object itself,
+		// thus we register it only once
+		if (USER_OPTION_COLLECT_STATISTICS) {
+			MEKONG_statistics.addCpyHtoD(broadcast);
+		}
+		LOG("  * created new memcpy object\n")
+	}
 	res &= broadcast->exec();
 
-	if (USER_OPTION_COLLECT_STATISTICS) {
-		MEKONG_statistics.addCpyHtoD(broadcast);
+	// Nothing changed since the last upload into this buffer; the virtual
+	// buffer already describes the broadcast correctly.
+	if (MEKONG_buffer->isUntouchedBroadcast(dstDevPtr)) {
+		LOG("  * distribution state of buffer did not change\n")
+		LOG("[MEKONG] [-] FUNC wrapMemcpyHtoD()\n")
+		return res.getRaw();
 	}
 
 	// If we copy on a device ptr we should invalidate the results made
@@ -358,9 +721,214 @@ Mekong::MErawresult wrapMemcpyHtoD(Mekong::MEdeviceptr dstDevPtr,
 	// kernel, but the user called a device to host memory copy on that buffer,
 	// the runtime would not know how to get the data from the different GPUs.
 	MEKONG_buffer->setBroadcast(dstDevPtr);
+	LOG("[MEKONG] [-] FUNC wrapMemcpyHtoD()\n")
 	return res.getRaw();
 }
 
+/*! \brief Gives the launches `members` new partitions and moves their data.
+
+    The data, which the old partitions of a member wrote last, is moved to
+    the devices of the new partitions. The dependency resolutions of all
+    members are dropped and created again on their next use.
+    \param change sets the new partitions of one member, returns false if
+           they did not change
+*/
+static Mekong::MEresult
+MEKONG_migrate(const std::vector<std::shared_ptr<Mekong::KernelLaunch>>& members,
+               const std::function<bool(Mekong::KernelLaunch&)>& change) {
+	Mekong::MEresult res;
+
+	// buffers, whose data was placed by the old partitions of a member
+	struct Moved {
+		Mekong::MEdeviceptr ptr;
+		std::shared_ptr<Mekong::KernelLaunch> writer;
+		int argId;
+		std::shared_ptr<const Mekong::ArgAccess> oldAcc;
+	};
+	std::vector<Moved> moved;
+	// the devices of the old and the new partitions of all members
+	std::vector<bool> involved(MEKONG_aliasH->getCtx().size(), false);
+	auto markDevices = [&involved](const Mekong::KernelLaunch& member) {
+		for (const auto& part : member.getPartitions()) {
+			involved.at(part->getDevice()) = true;
+		}
+	};
+	for (const auto& member : members) {
+		markDevices(*member);
+		for (auto ptr : member->getWrites()) {
+			if (MEKONG_buffer->isWritten(ptr) && (*MEKONG_buffer)[ptr] == member) {
+				int argId = member->getArgId(ptr);
+				moved.push_back({ ptr, member, argId,
+				                  member->getWriteArgAccess(argId) });
+			}
+		}
+	}
+
+	bool changed = false;
+	for (const auto& member : members) {
+		changed |= change(*member);
+		markDevices(*member);
+	}
+	if (!changed) {
+		return res;
+	}
+
+	// The migration reads the data of running kernels. Only the devices of
+	// the members are synchronized, independent launches on other device
+	// groups keep on computing \sa Mekong::DeviceGroups
+	const auto& ctxs = MEKONG_aliasH->getCtx();
+	for (size_t gpu = 0; gpu < ctxs.size(); ++gpu) {
+		if (!involved[gpu]) {
+			continue;
+		}
+		res &= Mekong::meCtxPushCurrent(ctxs[gpu]);
+		res &= Mekong::meCtxSynchronize();
+		res &= Mekong::meCtxPopCurrent(0);
+	}
+	for (const auto& m : moved) {
+		auto migration = Mekong::DepResolution::createMigration(
+			m.ptr, *m.oldAcc, *m.writer->getWriteArgAccess(m.argId),
+			m.writer->getArgFromId(m.argId)->getType(), MEKONG_aliasH);
+		res &= migration->exec();
+	}
+
+	// the resolutions were calculated from the old partitions
+	for (auto it = MEKONG_depResolutions.begin(); it != MEKONG_depResolutions.end();) {
+		unsigned masterId = it->first >> 32;
+		unsigned slaveId = it->first & 0xffffffff;
+		bool involved = false;
+		for (const auto& member : members) {
+			involved |= member->getId() == masterId || member->getId() == slaveId;
+		}
+		if (involved) {
+			it = MEKONG_depResolutions.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+	LOG("  * migrated " + std::to_string(moved.size()) + " buffers\n")
+	return res;
+}
+
+/*! \brief Re-partitions the balance group of `kl`, if the measured
+           partition times of its last execution ask for it.
+
+    All launches of the group get the new partitions \sa MEKONG_migrate.
+    \param times seconds of every partition of the last execution of `kl`
+    \sa Mekong::LoadBalancer
+    \sa Mekong::KernelLaunch::repartition
+*/
+static Mekong::MEresult
+MEKONG_rebalance(const std::shared_ptr<Mekong::KernelLaunch>& kl,
+                 const std::vector<double>& times) {
+	Mekong::MEresult res;
+	auto balancer = kl->getBalancer();
+	if (!balancer || times.empty()) {
+		return res;
+	}
+	// the balancer weighs devices, an over-decomposed launch has several
+	// partitions per device
+	const auto& parts = kl->getPartitions();
+	std::vector<double> devTimes(kl->getNumDevUsed(), 0);
+	std::vector<double> blocks(kl->getNumDevUsed(), 0);
+	for (size_t partId = 0; partId < parts.size() && partId < times.size(); ++partId) {
+		const auto& grid = parts[partId]->getGrid();
+		size_t dev = parts[partId]->getDevice() - kl->getFirstDev();
+		devTimes.at(dev) += times[partId];
+		blocks.at(dev) += (double) grid[0] * grid[1] * grid[2];
+	}
+	if (!balancer->addMeasurement(devTimes, blocks)) {
+		return res;
+	}
+	LOG("  * imbalance " + std::to_string(balancer->getImbalance())
+	    + ", re-partitioning " + std::to_string(balancer->getMembers().size())
+	    + " launches\n")
+
+	std::vector<std::shared_ptr<Mekong::KernelLaunch>> members;
+	for (unsigned id : balancer->getMembers()) {
+		members.push_back(Mekong::KernelLaunch::getById(id));
+	}
+	const std::vector<double>& weights = balancer->getWeights();
+	res &= MEKONG_migrate(members, [&](Mekong::KernelLaunch& member) {
+		member.repartition(weights);
+		return true;
+	});
+	return res;
+}
+
+/*! \brief Plans the partitions of `kl` again with the measured partition
+           times of its second execution.
+
+    The first execution is skipped, it includes e.g. the loading of the
+    module. The times calibrate the cost model of the planner, then `kl`
+    and all launches with equal arg accesses get the partitions of the new
+    plan \sa MEKONG_migrate. Every launch is planned again only once.
+    \param times seconds of every partition of the last execution of `kl`
+    \sa Mekong::PartitionPlanner::calibrate
+    \sa Mekong::KernelLaunch::replan
+*/
+static Mekong::MEresult
+MEKONG_replan(const std::shared_ptr<Mekong::KernelLaunch>& kl,
+              const std::vector<double>& times) {
+	Mekong::MEresult res;
+	if (!kl->isReplanPending() || times.empty() || kl->getExecs() < 2) {
+		return res;
+	}
+	double rate = Mekong::PartitionPlanner::calibrate(kl->getPartitions(), times);
+	LOG("  * measured " + std::to_string(rate) + " threads/s, planning again\n")
+
+	// the others adopt the new plan of kl
+	std::vector<std::shared_ptr<Mekong::KernelLaunch>> members = { kl };
+	for (const auto& other : kl->getEqualLaunches()) {
+		if (other != kl) {
+			members.push_back(other);
+		}
+	}
+	res &= MEKONG_migrate(members, [&](Mekong::KernelLaunch& member) {
+		if (&member == kl.get()) {
+			return kl->replan();
+		}
+		bool changed = member.getPartitions() != kl->getPartitions();
+		member.adoptPlan(*kl);
+		return changed;
+	});
+	LOG("  * using " + std::to_string(kl->getNumDevUsed()) + " devices\n")
+	return res;
+}
+
+/*! \brief Adds the new launch `kl` to the device groups and moves the
+           launches, whose group changed, to their devices.
+
+    Usually the launches of a new group appear in the first iteration, thus
+    only few launches have data to migrate \sa MEKONG_migrate.
+    \sa Mekong::DeviceGroups
+*/
+static Mekong::MEresult
+MEKONG_group(const std::shared_ptr<Mekong::KernelLaunch>& kl) {
+	Mekong::MEresult res;
+	const auto& grid = kl->getGrid();
+	const auto& block = kl->getBlock();
+	double threads = (double) grid[0] * grid[1] * grid[2] * block[0] * block[1] * block[2];
+	std::vector<unsigned> changed = MEKONG_deviceGroups->addLaunch(
+		kl->getId(), kl->getReads(), kl->getWrites(), threads);
+	if (changed.empty()) {
+		return res;
+	}
+	LOG("  * ") LOG(*MEKONG_deviceGroups)
+	LOG(", moving " + std::to_string(changed.size()) + " launches\n")
+
+	std::vector<std::shared_ptr<Mekong::KernelLaunch>> members;
+	for (unsigned id : changed) {
+		members.push_back(Mekong::KernelLaunch::getById(id));
+	}
+	res &= MEKONG_migrate(members, [](Mekong::KernelLaunch& member) {
+		auto range = MEKONG_deviceGroups->getRange(member.getId());
+		return member.setDeviceRange(range.first, range.count);
+	});
+	return res;
+}
+
 /*! \brief Creates partitions, checks for dependencies and launches the kernels.
 
     In this wrapping function the bulk of the runtime's functionality is
@@ -401,14 +969,9 @@ Mekong::MErawresult wrapLaunchKernel(Mekong::MEfunction func,
 	LOG("[MEKONG] [+] FUNC wrapLaunchKernel():\n")
 	Mekong::MEresult res;
 
-	// SEARCH FOR THE APPROPRIATE KERNEL INFO OBJECT
-	std::shared_ptr<const Mekong::bsp_KernelInfo> currKernInfo;
-	for (auto kinfo : MEKONG_kinfos) {
-		if (kinfo->getName() == MEKONG_aliasH->atName(func)) {
-			currKernInfo = kinfo;
-			break;
-		}
-	}
+	// THE KERNEL INFO OBJECT WAS RESOLVED BY wrapModuleGetFunction
+	const auto& funcRecord = MEKONG_aliasH->getFuncRecord(func);
+	const auto& currKernInfo = funcRecord.info;
 	if (currKernInfo == nullptr) {
 		throwError("I could not find any valid kernel analysis");
 	}
@@ -426,6 +989,9 @@ Mekong::MErawresult wrapLaunchKernel(Mekong::MEfunction func,
 	if (std::get<1>(kl_and_bool)) { // element was inserted successfully
 		LOG("  * Inserted new launch into set (set size = "
 		    + std::to_string(Mekong::KernelLaunch::all.size()) + ")\n")
+		if (MEKONG_deviceGroups) {
+			res &= MEKONG_group(kl);
+		}
 	}
 	else { // element was not inserted
 		LOG("  * Launch already exists; I will take old one; "
@@ -445,58 +1011,34 @@ Mekong::MErawresult wrapLaunchKernel(Mekong::MEfunction func,
 	}
 	
 
+	// BALANCE THE LOAD BETWEEN THE DEVICES
+	// The partitions might change, thus before the limits are checked and
+	// before the dependencies are resolved.
+	// The times of the last execution are read only once.
+	if ((USER_OPTION_LOAD_BALANCING && USER_OPTION_CYCLE_LENGTH == 0) ||
+	    kl->isReplanPending()) {
+		std::vector<double> times = kl->getPartitionTimes();
+		res &= MEKONG_rebalance(kl, times);
+		res &= MEKONG_replan(kl, times);
+	}
+
 	// CHECK DEVICE LIMITS IF MARKED IN USER CONFIGURATION
-	// TODO this can also be optimized if we ask for the
-	// device properties only once and save them.
+	// Only the first launch of an equal configuration does the check, the
+	// device limits were queried by wrapCtxCreate.
 	if (USER_OPTION_CHECK_DEVICE_LIMITS) {
 		LOG("  * checking device limits...\n")
-		for (auto& dev : MEKONG_aliasH->getDevs()) {
-			auto gridMax = Mekong::meGetGridLimits(dev);
-			auto blockMax = Mekong::meGetBlockLimits(dev);
-			size_t maxThreads = Mekong::meGetThreadsPerBlockLimit(dev);
-			size_t maxShMem = Mekong::meShMemPerBlockLimit(dev);
-			for (const auto& prt : kl->getPartitions()) {
-				if (prt->getGrid()[0] > gridMax[0] ||
-				    prt->getGrid()[1] > gridMax[1] ||
-				    prt->getGrid()[2] > gridMax[2]) {
-					throw std::invalid_argument(
-						"[MEKONG] FUNC wrapLaunchKernel(): "
-						"Your kernel configuration "
-						"exceeds the device limits: "
-						"grid size is too big."
-					);
-				}
-				if (prt->getBlock()[0] > blockMax[0] ||
-				    prt->getBlock()[1] > blockMax[1] ||
-				    prt->getBlock()[2] > blockMax[2]) {
-					throw std::invalid_argument(
-						"[MEKONG] FUNC wrapLaunchKernel(): "
-						"Your kernel configuration "
-						"exceeds the device limits: "
-						"block size is too big."
-					);
-				}
-				if (prt->getBlock()[0] *
-				    prt->getBlock()[1] *
-				    prt->getBlock()[2] > maxThreads) {
-					throw std::invalid_argument(
-						"[MEKONG] FUNC wrapLaunchKernel(): "
-						"Your kernel configuration "
-						"exceeds the device limits: "
-						"maximum number of threads per "
-						"block is too big."
-					);
-				}
-				if (shmem > maxShMem) {
-					throw std::invalid_argument(
-						"[MEKONG] FUNC wrapLaunchKernel(): "
-						"Your kernel configuration"
-						"exceeds the device limits: "
-						"not enough shared memory."
-					);
-				}
-			}
-		}
+		kl->checkLimits(MEKONG_aliasH->getDevLimits(), funcRecord.limits);
+	}
+
+	// TEMPORAL BLOCKING
+	// A launch of a swap pair executes one of its phases, whose widened
+	// partitions compute the halos of the next iterations.
+	// \sa Mekong::KernelLaunch::getBlockingPhase
+	if (USER_OPTION_TEMPORAL_BLOCKING > 1) {
+		auto phase = kl->getBlockingPhase();
+		LOG("  * blocking depth " + std::to_string(kl->getBlockingDepth())
+		    + ", executing launch " + std::to_string(phase->getId()) + "\n")
+		kl = std::move(phase);
 	}
 
 	if (USER_OPTION_COLLECT_STATISTICS) {
@@ -516,40 +1058,39 @@ Mekong::MErawresult wrapLaunchKernel(Mekong::MEfunction func,
 	// 4. Execute the dependency resolve objects
 
 	// 1.
-	std::unordered_set<std::shared_ptr<Mekong::KernelLaunch>> masters;
-	std::vector<std::shared_ptr<Mekong::DepResolution>> resolves;
+	// A launch has only a few arguments, thus a vector is cheaper than a set
+	std::vector<std::shared_ptr<Mekong::KernelLaunch>> masters;
+	std::vector<Mekong::DepResolution*> resolves;
 	for (auto ptr : kl->getReads()) {
 		if (MEKONG_buffer->isWritten(ptr)) {
-			masters.insert((*MEKONG_buffer)[ptr]);
+			auto master = (*MEKONG_buffer)[ptr];
+			if (std::find(masters.begin(), masters.end(), master) == masters.end()) {
+				masters.push_back(std::move(master));
+			}
 		}
 	}
 	LOG("  * found " + std::to_string(masters.size())
 	    + " dependencies for this launch\n")
-	bool foundResolve;
 	size_t createdRes = 0;
 	size_t foundRes = 0;
-	for (auto master : masters) {
-		foundResolve = false;
-		for (auto oldResolve : MEKONG_depResolutions) {
-			// 2.
-			if (oldResolve->isResolutionOf(master, kl)) {
-				resolves.push_back(oldResolve);
-				foundResolve = true;
-				++foundRes;
-				break;
-			}
+	for (const auto& master : masters) {
+		// 2.
+		uint64_t key = ((uint64_t) master->getId() << 32) | kl->getId();
+		auto it = MEKONG_depResolutions.find(key);
+		if (it != MEKONG_depResolutions.end()) {
+			resolves.push_back(it->second.get());
+			++foundRes;
+			continue;
 		}
 		// 3.
-		if (!foundResolve) { 
-			std::shared_ptr<Mekong::DepResolution> resolution(
-				new Mekong::DepResolution(master, kl, MEKONG_aliasH)
-			);
-			++createdRes;
-			MEKONG_depResolutions.insert(resolution);
-			resolves.push_back(resolution);
-			if (USER_OPTION_COLLECT_STATISTICS) {
-				MEKONG_statistics.addResolution(resolution);
-			}
+		std::shared_ptr<Mekong::DepResolution> resolution(
+			new Mekong::DepResolution(master, kl, MEKONG_aliasH)
+		);
+		++createdRes;
+		MEKONG_depResolutions.emplace(key, resolution);
+		resolves.push_back(resolution.get());
+		if (USER_OPTION_COLLECT_STATISTICS) {
+			MEKONG_statistics.addResolution(resolution);
 		}
 	}
 	LOG("  * created " + std::to_string(createdRes) + " and found "
@@ -564,7 +1105,7 @@ Mekong::MErawresult wrapLaunchKernel(Mekong::MEfunction func,
 	}
 
 	// 4.
-	for (auto resolve : resolves) {
+	for (auto resolve : resolves) { // raw pointers, owned by MEKONG_depResolutions
 		res &= resolve->exec();
 	}
 
@@ -605,6 +1146,15 @@ Mekong::MErawresult wrapLaunchKernel(Mekong::MEfunction func,
 		MEKONG_buffer->setWritten(writePtr, kl);
 	}
 
+	// PREPARE THE DEVICE TO HOST COPIES OF THE WRITTEN DATA
+	// Only the first execution of a launch has to do this, later
+	// executions find the cached patterns.
+	if (USER_OPTION_PRECOMPUTE_DTOH && kl->getExecs() == 1 &&
+	    !kl->getWrites().empty()) {
+		LOG("  * precomputing written data in the background\n")
+		MEKONG_workers.submit([kl] { kl->precomputeWrittenData(); });
+	}
+
 	LOG("[MEKONG] [-] FUNC wrapLaunchKernel()\n")
 
 	if (USER_OPTION_COLLECT_STATISTICS) {
@@ -644,8 +1194,13 @@ Mekong::MErawresult wrapCtxSynchronize() {
     calculate the written elements and to know which GPU holds them. Lastly, we
     copy the elements to the host buffer.  In fact this means that not written
     elements won't be copied to the host buffer (e.g. the border elements of a
-    stencil).  A special case is an complete unwritten buffer, which we copy
-    back to the host completely.
+    stencil), unless the buffer was broadcast before the kernel wrote to it.
+    In that case the unwritten elements are equal on every device and we copy
+    them from the first GPU. A special case is a complete unwritten buffer,
+    which we copy back to the host completely.
+
+    Only the device Bytes [offset, offset + `size`) are copied. The offset is
+    non zero if `srcDevPtr` points into the middle of an allocation.
 
     \todo Support partially written buffers (e.g. a mesh refinement code on a
           stencil). To achieve this we have to keep track which GPU holds the
@@ -659,15 +1214,33 @@ Mekong::MErawresult wrapMemcpyDtoH(void* dstHostPtr,
 	Mekong::MEresult res;
 	std::shared_ptr<Mekong::MemCpyDtoH> cpy; 
 
+	// With USER_OPTION_LAZY_DTOH the copy is only started here and
+	// completes on the first access of the host code to the host buffer.
+	auto execCpy = [&] () -> Mekong::MEresult {
+		if (USER_OPTION_LAZY_DTOH) {
+			LOG("  * started lazy copy\n")
+			return Mekong::LazyDtoH::submit(cpy, size, MEKONG_aliasH);
+		}
+		return cpy->exec();
+	};
+
+	// the user may copy from the middle of an allocation
+	Mekong::MEdeviceptr basePtr = MEKONG_aliasH->getBasePtr(srcDevPtr);
+	size_t offset = srcDevPtr - basePtr;
+	if (offset != 0) {
+		LOG("  * copy starts at Byte " + std::to_string(offset)
+		    + " of the buffer\n")
+	}
+
 	// if pointer was not written by any kernel
-	if (!MEKONG_buffer->isWritten(srcDevPtr)) {
+	if (!MEKONG_buffer->isWritten(basePtr)) {
 		// and the wrapMemcpyHtoD copied it as a broadcast to all devices
-		if (MEKONG_buffer->isBroadcast(srcDevPtr)) { 
+		if (MEKONG_buffer->isBroadcast(basePtr)) { 
 			cpy = std::shared_ptr<Mekong::MemCpyDtoH>(
-				      new Mekong::MemCpyDtoH(dstHostPtr, srcDevPtr, size,
-				                             MEKONG_aliasH)
+				      new Mekong::MemCpyDtoH(dstHostPtr, basePtr, size,
+				                             MEKONG_aliasH, offset)
 				  );
-			res = cpy->exec(); // simply copy from first device to host
+			res = execCpy(); // simply copy from first device to host
 			if (res.isSuccess()) {
 				LOG("[MEKONG] copied untouched broadcast data back to host "
 				    "memory\n")
@@ -688,8 +1261,9 @@ Mekong::MErawresult wrapMemcpyDtoH(void* dstHostPtr,
 		}
 	}
 	else { // if the pointer has been written
-		auto kl = (*MEKONG_buffer)[srcDevPtr];
-		cpy = kl->getWrittenData(srcDevPtr, dstHostPtr);
+		auto kl = (*MEKONG_buffer)[basePtr];
+		cpy = kl->getWrittenData(basePtr, dstHostPtr, offset, size,
+		                         MEKONG_buffer->isBroadcast(basePtr));
 		auto pattern = cpy->getPattern();
 		LOG("[MEKONG] Going to exec memcpy: ") LOG(*cpy) LOG('\n')
 		if (USER_OPTION_LOG_ON) {
@@ -700,7 +1274,7 @@ Mekong::MErawresult wrapMemcpyDtoH(void* dstHostPtr,
 				LOG("[MEKONG] WARNING: No memcpys executed\n")
 			}
 		}
-		res = cpy->exec();
+		res = execCpy();
 		if (USER_OPTION_LOG_ON) {
 			if (res.isSuccess()) {
 				LOG("[MEKONG] copied kernel data back to host memory\n")
@@ -712,7 +1286,12 @@ Mekong::MErawresult wrapMemcpyDtoH(void* dstHostPtr,
 	}
 	LOG("[MEKONG] [-] FUNC wrapMemcpyDtoH()\n")
 	if (USER_OPTION_COLLECT_STATISTICS) {
-		MEKONG_statistics.addCpyDtoH(cpy);
+		if (USER_OPTION_LAZY_DTOH && Mekong::LazyDtoH::isLazy(dstHostPtr, size)) {
+			MEKONG_statistics.addLazyDtoH(cpy);
+		}
+		else {
+			MEKONG_statistics.addCpyDtoH(cpy);
+		}
 	}
 	return res.getRaw();
 }
@@ -723,6 +1302,9 @@ Mekong::MErawresult wrapMemcpyDtoH(void* dstHostPtr,
 Mekong::MErawresult wrapMemFree(Mekong::MEdeviceptr ptr) {
 	LOG("[MEKONG] [+] FUNC wrapMemFree():\n")
 	Mekong::MEresult res;
+	if (USER_OPTION_LAZY_DTOH) {
+		res &= Mekong::LazyDtoH::completeDevice(ptr);
+	}
 	unsigned short gpu = 0;
 	for (auto& devptr : (*MEKONG_aliasH)[ptr]) {
 		res &= Mekong::meCtxPushCurrent(MEKONG_aliasH->getCtx()[gpu]);
@@ -740,6 +1322,18 @@ Mekong::MErawresult wrapMemFree(Mekong::MEdeviceptr ptr) {
 	}
 	MEKONG_aliasH->erase(ptr);
 
+	// the pointer value may be returned by a later allocation, thus we have
+	// to forget the cached upload objects and the state of the buffer
+	auto first = MEKONG_htodCpys.lower_bound(
+		std::make_tuple(ptr, (const void*) nullptr, (size_t) 0));
+	auto last = first;
+	while (last != MEKONG_htodCpys.end() && std::get<0>(last->first) == ptr) {
+		++last;
+	}
+	MEKONG_htodCpys.erase(first, last);
+	MEKONG_uploadHashes.erase(ptr);
+	MEKONG_buffer->clear(ptr);
+
 	LOG("[MEKONG] [-] FUNC wrapMemFree()\n")
 	return res.getRaw();
 }
@@ -750,6 +1344,9 @@ Mekong::MErawresult wrapMemFree(Mekong::MEdeviceptr ptr) {
 Mekong::MErawresult wrapCtxDestroy(Mekong::MEcontext ctx) {
 	LOG("[MEKONG] [+] FUNC wrapCtxDestroy():\n") 
 	Mekong::MEresult res;
+	if (USER_OPTION_LAZY_DTOH) {
+		res &= Mekong::LazyDtoH::completeAll();
+	}
 	for (auto& context : (*MEKONG_aliasH)[ctx]) {
 		res &= Mekong::meCtxDestroy(context);
 	}
@@ -788,12 +1385,17 @@ void MEKONG_report() {
 		return;
 	}
 
+	// the statistics include the background arg access calculations
+	MEKONG_workers.wait();
+
 	using std::cout;
 	using std::endl;
 	cout << std::setprecision(6);
 
 	std::map<std::string, std::string> kernel2partitioning;
-	for (auto kinfo : MEKONG_kinfos) {
+	auto kinfos = MEKONG_analysisDB ? MEKONG_analysisDB->getLoadedKernelInfos()
+	                                : MEKONG_kinfos;
+	for (auto kinfo : kinfos) {
 		kernel2partitioning[kinfo->getName()] =
 			kinfo->getPartitioning()->getSplitStr();
 	}
@@ -859,6 +1461,27 @@ void MEKONG_report() {
 	cout << (double) MEKONG_statistics.getMemCpySize(Mekong::DtoH) / 1e6;
 	cout << " MB" << endl;
 
+	if (USER_OPTION_LAZY_DTOH) {
+		cout << "  - num lazy DtoH memcpys = ";
+		cout << MEKONG_statistics.getNumLazyDtoH() << endl;
+
+		cout << "  - lazy DtoH memcpy size = ";
+		cout << (double) MEKONG_statistics.getLazyDtoHSize() / 1e6;
+		cout << " MB" << endl;
+
+		cout << "  - time waited for lazy DtoH memcpys = ";
+		cout << Mekong::LazyDtoH::getWaitTime() << " s" << endl;
+	}
+
+	if (USER_OPTION_ELIDE_REDUNDANT_HTOD) {
+		cout << "  - num elided HtoD memcpys = ";
+		cout << MEKONG_statistics.getNumElidedHtoD() << endl;
+
+		cout << "  - elided HtoD memcpy size = ";
+		cout << (double) MEKONG_statistics.getElidedHtoDSize() / 1e6;
+		cout << " MB" << endl;
+	}
+
 	cout << "  - total Bandwidth = ";
 	cout << MEKONG_statistics.getMemBW() << " GB/s" << endl;
 
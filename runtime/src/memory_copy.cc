@@ -1,15 +1,12 @@
 /*! \file memory_copy.cc
     \brief Source file to handle memory copy operations in Mekong's context.
 
-    \todo This file and all classes should be rewritten in a more simple style.
-          Up to now we have one base class which contains a lot functionality
-          and 3 (HtoD, DtoH, DtoD) child classes, which are merely wrapper
-          classes. They should be replaced by one simple written class.
-          Moreover the complex usage of the MemSubCopy is not a good style.
+    All kinds are executed by CopyPlan::exec. \sa copy_plan.h
 */
 #include "mekong-cuda.h"
 #include "alias_handle.h"
 #include "memory_copy.h"
+#include "copy_plan.h"
 
 #include <memory>
 #include <vector>
@@ -19,6 +16,7 @@
 #include <string>
 #include <stdexcept>
 #include <chrono>
+#include <algorithm>
 
 namespace Mekong {
 
@@ -36,9 +34,11 @@ MemCpyDtoH::MemCpyDtoH(void* dst, const MEdeviceptr src, shared_ptr<const MemPat
 		MemCpy<void*, const MEdeviceptr>(dst, src, DtoH, pmp, aliasH, sync) {}
 
 //! trivial constructor, which wraps a simple single gpu to single host memory copy operation
+
+//! The copy starts at Byte `offset` of the device buffer `src`.
 MemCpyDtoH::MemCpyDtoH(void* dst, const MEdeviceptr src, size_t size,
-		   shared_ptr<AliasHandle> aliasH) :
-		MemCpy<void*, const MEdeviceptr>(dst, src, DtoH, createTrivialMemPattern(size), aliasH, true) {}
+		   shared_ptr<AliasHandle> aliasH, size_t offset) :
+		MemCpy<void*, const MEdeviceptr>(dst, src, DtoH, createTrivialMemPattern(size, offset), aliasH, true) {}
 
 
 MemCpyHtoD::MemCpyHtoD(MEdeviceptr dst, const void* src,
@@ -60,190 +60,113 @@ bool operator==(const MemSubCopy& a, const MemSubCopy& b) {
 }
 
 MEresult MemCpyHtoD::exec() {
-	if (aliasH_->getCtx().size() != aliasH_->getNumDev()) {
-		throw runtime_error("CLASS MemCpyHtoD, FUNC exec(): not enough device contexts"
-		                    "for number of devices in alias handle object");
-	}
-	if ((*aliasH_)[dst_].size() != aliasH_->getNumDev()) {
-		throw runtime_error("CLASS MemCpyHtoD, FUNC exec(): not enough alias pointer for every device in"
-		                    "alias handle object. NumDev = " + to_string(aliasH_->getNumDev()) +
-		                    ", Num alias pointer = " + to_string((*aliasH_)[dst_].size()));
-	}
-	MEresult res;
-	auto time_exec_begin = Clock::now();
 #ifdef SOFIRE
 	if (!this->isBroadcast_) {
-		for (auto subcpy : *pmp_) {
-			if (subcpy.src != -1 || subcpy.dst < 0) {
-				throw invalid_argument("Namespace: Mekong, Class MemCpyHtoD, Func exec():\n"
-				                       "memcpy marked as Host to Device, but configuration of\n"
-				                       "sub copy objects is not consistent with this.");
-			}
-			res &= meCtxPushCurrent(aliasH_->getCtx().at(subcpy.dst));
-			res &= meMemcpyHtoDAsync((*aliasH_)[dst_].at(subcpy.dst) + subcpy.to,
-			       (unsigned char*) src_ + subcpy.from, subcpy.size, 0);
-			res &= meCtxPopCurrent(nullptr);
-			if (!res.isSuccess()) {
-				break;
-			}
-		}
-	}
-	else { // is broadcast, thus use dominiks library
-		comm.destroyCircle();
-		for (int gpu = 0; gpu < aliasH_->getNumDev(); ++gpu) {
-			auto dstPointer = (*aliasH_)[dst_].at(gpu);
-			comm.setDeviceMemory(gpu, (char*) dstPointer);
-		}
-		comm.setDeviceMemory(comm.getHostDevNum(), (char*) src_);
-		int src = comm.getHostDevNum();
-		vector<int> dests;
-		for (int gpu = 0; gpu < aliasH_->getNumDev(); ++gpu) {
-			dests.push_back(gpu);
-		}
-		comm.createCircle(dests, src);
-		// syncs automatically
-		comm.broadcast(dests, comm.getHostDevNum(), orgSize_);
-	}
-	// synchronize with each context
-	if (sync_ && !isBroadcast_) {
-		for (auto ctx : aliasH_->getCtx()) {
-			if (!res.isSuccess()) { 
-				break;
-			}
-			res &= meCtxPushCurrent(ctx);
-			res &= meCtxSynchronize();
-			res &= meCtxPopCurrent(nullptr);
-		}
-	}
-#else
-	for (auto subcpy : *pmp_) {
-		if (subcpy.src != -1 || subcpy.dst < 0) {
-			throw invalid_argument("Namespace: Mekong, Class MemCpyHtoD, Func exec():\n"
-			                       "memcpy marked as Host to Device, but configuration of\n"
-			                       "sub copy objects is not consistent with this.");
-		}
-		res &= meCtxPushCurrent(aliasH_->getCtx().at(subcpy.dst));
-		res &= meMemcpyHtoDAsync((*aliasH_)[dst_].at(subcpy.dst) + subcpy.to,
-			   (unsigned char*) src_ + subcpy.from, subcpy.size, 0);
-		res &= meCtxPopCurrent(nullptr);
-		if (!res.isSuccess()) {
-			break;
-		}
-	}
-	// synchronize with each context
-	if (sync_) {
-		for (auto ctx : aliasH_->getCtx()) {
-			if (!res.isSuccess()) { 
-				break;
-			}
-			res &= meCtxPushCurrent(ctx);
-			res &= meCtxSynchronize();
-			res &= meCtxPopCurrent(nullptr);
-		}
+		return execPlan(CopyBuffer::onDevice(dst_), CopyBuffer::onHost(src_));
 	}
-#endif
+	// is broadcast, thus use dominiks library
+	auto time_exec_begin = Clock::now();
+	comm.destroyCircle();
+	for (int gpu = 0; gpu < aliasH_->getNumDev(); ++gpu) {
+		auto dstPointer = (*aliasH_)[dst_].at(gpu);
+		comm.setDeviceMemory(gpu, (char*) dstPointer);
+	}
+	comm.setDeviceMemory(comm.getHostDevNum(), (char*) src_);
+	int src = comm.getHostDevNum();
+	vector<int> dests;
+	for (int gpu = 0; gpu < aliasH_->getNumDev(); ++gpu) {
+		dests.push_back(gpu);
+	}
+	comm.createCircle(dests, src);
+	// syncs automatically
+	comm.broadcast(dests, comm.getHostDevNum(), orgSize_);
 	Duration time_exec = Clock::now() - time_exec_begin;
 	time_ += time_exec.count();
 	++executions_;
-	return res;
+	return MEresult();
+#else
+	return execPlan(CopyBuffer::onDevice(dst_), CopyBuffer::onHost(src_));
+#endif
 }
 
 MEresult MemCpyDtoH::exec() {
-	if (aliasH_->getCtx().size() != aliasH_->getNumDev()) {
-		throw runtime_error("CLASS MemCpyDtoH, FUNC exec(): not enough device contexts"
-		                    "for number of devices in alias handle object");
-	}
-	if ((*aliasH_)[src_].size() != aliasH_->getNumDev()) {
-		throw runtime_error("CLASS MemCpyDtoH, FUNC exec(): not enough alias pointer for every device in"
-		                    "alias handle object. NumDev = " + to_string(aliasH_->getNumDev()) +
-		                    ", Num alias pointer = " + to_string((*aliasH_)[src_].size()));
-	}
-	MEresult res;
-	auto time_exec_begin = Clock::now();
-	for (auto subcpy : *pmp_) {
-		if (subcpy.src < 0 || subcpy.dst != -1) {
-			throw invalid_argument("Namespace: Mekong, Class MemCpyDtoH, Func exec():\n"
-								   "memcpy marked as Device to Host, but configuration of\n"
-								   "sub copy objects is not consistent with this.");
-		}
-		res &= meCtxPushCurrent(aliasH_->getCtx().at(subcpy.src));
-		auto aim = (*aliasH_)[src_].at(subcpy.src) + subcpy.from;
-		res &= meMemcpyDtoHAsync((unsigned char*) dst_ + subcpy.to , aim
-								 , subcpy.size, 0);
-		res &= meCtxPopCurrent(nullptr);
-		if (!res.isSuccess()) {
-			break;
-		}
-	}
-	// synchronize with each context
-	if (sync_) {
-		for (auto ctx : aliasH_->getCtx()) {
-			if (!res.isSuccess()) { 
-				break;
-			}
-			res &= meCtxPushCurrent(ctx);
-			res &= meCtxSynchronize();
-			res &= meCtxPopCurrent(nullptr);
-		}
-	}
-	Duration time_exec = Clock::now() - time_exec_begin;
-	time_ += time_exec.count();
-	++executions_;
-	return res;
+	return execPlan(CopyBuffer::onHost(dst_), CopyBuffer::onDevice(src_));
 }
 
-shared_ptr<const MemCpyDtoH::MemPattern> MemCpyDtoH::createTrivialMemPattern(size_t size) const {
+shared_ptr<const MemCpyDtoH::MemPattern>
+MemCpyDtoH::createTrivialMemPattern(size_t size, size_t offset) const {
 	MemSubCopy msb;
 	msb.src = 0;
 	msb.dst = -1;
-	msb.from = 0;
+	msb.from = offset;
 	msb.to = 0;
 	msb.size = size;
 	return shared_ptr<const MemPattern>(new vector<MemSubCopy>(1, msb));
 }
 
-MEresult MemCpyDtoD::exec() {
-	if (aliasH_->getCtx().size() != aliasH_->getNumDev()) {
-		throw runtime_error("CLASS MemCpyDtoD, FUNC exec(): not enough device contexts"
-		                    "for number of devices in alias handle object");
-	}
-	if ((*aliasH_)[src_].size() != aliasH_->getNumDev()) {
-		throw runtime_error("CLASS MemCpyDtoD, FUNC exec(): not enough alias pointer for every device in"
-		                    "alias handle object. NumDev = " + to_string(aliasH_->getNumDev()) +
-		                    ", Num alias pointer = " + to_string((*aliasH_)[src_].size()));
-	}
-	MEresult res;
-	auto time_exec_begin = Clock::now();
-	for (auto subcpy : *pmp_) {
-		if (subcpy.src < 0 || subcpy.dst < 0) {
-			throw invalid_argument("Namespace: Mekong, Class MemCpyDtoD, Func exec():\n"
-								   "memcpy marked as Device to Device, but configuration of\n"
-								   "sub copy objects is not consistent with this.");
-		}
-		res &= meCtxPushCurrent(aliasH_->getCtx().at(subcpy.dst));
-		res &= meMemcpyDtoDAsync((*aliasH_)[dst_].at(subcpy.dst) + subcpy.to,
-								 (*aliasH_)[src_].at(subcpy.src) + subcpy.from, subcpy.size, 0);
-		res &= meCtxPopCurrent(nullptr);
-		if (!res.isSuccess()) {
-			break;
+/*! \brief Restricts a device to host pattern to the device Bytes
+           [offset, offset + size).
+
+    The `from` positions of the returned sub copies stay positions on the
+    device buffer. The `to` positions are shifted by `offset`, as the host
+    buffer starts with the device Byte `offset`. Sub copies outside of the
+    range are dropped.
+*/
+MemCpyDtoH::MemPattern MemCpyDtoH::clipPattern(const MemPattern& pattern,
+                                               size_t offset, size_t size) {
+	MemPattern res;
+	size_t end = offset + size;
+	for (const auto& subcpy : pattern) {
+		size_t first = max(subcpy.from, offset);
+		size_t last = min(subcpy.from + subcpy.size, end);
+		if (first >= last) {
+			continue;
 		}
+		MemSubCopy clipped = subcpy;
+		clipped.from = first;
+		clipped.to = first - offset;
+		clipped.size = last - first;
+		res.push_back(clipped);
 	}
-	// synchronize with each context
-	if (sync_) {
-		for (auto ctx : aliasH_->getCtx()) {
-			if (!res.isSuccess()) { 
-				break;
-			}
-			res &= meCtxPushCurrent(ctx);
-			res &= meCtxSynchronize();
-			res &= meCtxPopCurrent(nullptr);
+	return res;
+}
+
+/*! \brief Adds sub copies from `gpu` for every Byte in [offset, offset + size)
+           not covered by the (clipped) pattern.
+
+    We need this for buffers, which were broadcast and afterwards only partly
+    written by a kernel (e.g. the border of a stencil). The elements not
+    written are equal on every device, thus we can take them from any GPU.
+    \sa clipPattern
+*/
+void MemCpyDtoH::fillGaps(MemPattern& pattern, size_t offset, size_t size,
+                          unsigned short gpu) {
+	MemPattern covered = pattern;
+	sort(covered.begin(), covered.end(),
+	     [] (const MemSubCopy& a, const MemSubCopy& b) { return a.to < b.to; });
+	size_t pos = 0; // first host Byte not covered yet
+	auto addGap = [&] (size_t first, size_t last) {
+		MemSubCopy gap;
+		gap.src = gpu;
+		gap.dst = -1;
+		gap.from = offset + first;
+		gap.to = first;
+		gap.size = last - first;
+		pattern.push_back(gap);
+	};
+	for (const auto& subcpy : covered) {
+		if (subcpy.to > pos) {
+			addGap(pos, subcpy.to);
 		}
+		pos = max(pos, subcpy.to + subcpy.size);
+	}
+	if (pos < size) {
+		addGap(pos, size);
 	}
+}
 
-	Duration time_exec = Clock::now() - time_exec_begin;
-	time_ += time_exec.count();
-	++executions_;
-	return res;
+MEresult MemCpyDtoD::exec() {
+	return execPlan(CopyBuffer::onDevice(dst_), CopyBuffer::onDevice(src_));
 }
 
 /*! \brief Makes a broadcast from from host to all devices.
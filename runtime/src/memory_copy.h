@@ -1,11 +1,10 @@
 /*! \file memory_copy.h
     \brief Header file to handle memory copy operations in Mekong's context.
 
-    \todo This file and all classes should be rewritten in a more simple style.
-          Up to now we have one base class which contains a lot functionality
-          and 3 (HtoD, DtoH, DtoD) child classes, which are merely wrapper
-          classes. They should be replaced by one simple written class.
-          Moreover the complex usage of the MemSubCopy is not a good style.
+    The patterns of all copy kinds are compiled to a CopyPlan, which is
+    optimized once and executed by one executor. The HtoD, DtoH and DtoD
+    classes only name the buffers.
+    \sa CopyPlan
 */
 
 #ifndef MEKONG_MEMCPY_H
@@ -22,6 +21,7 @@
 
 #include "mekong-cuda.h"
 #include "alias_handle.h"
+#include "copy_plan.h"
 #ifdef SOFIRE
 #include "communicator.h"
 #endif
@@ -74,11 +74,16 @@ class MemCpy {
 		DstPtrT getDst() const;
 		SrcPtrT getSrc() const;
 		shared_ptr<const MemPattern> getPattern() const;
+		shared_ptr<const CopyPlan> getPlan() const;
 		string getKindStr() const;
 
 		void setDst(const DstPtrT& dst);
+		void setTimingHook(const CopyPlan::TimingHook& hook);
+		void markExecuted(double time);
 
 	protected:
+		MEresult execPlan(const CopyBuffer& dst, const CopyBuffer& src);
+
 		size_t executions_ = 0;
 		double time_ = 0;
 		MemCpyKind kind_;
@@ -89,6 +94,8 @@ class MemCpy {
 		shared_ptr<AliasHandle> aliasH_;
 		bool sync_;
 		bool isBroadcast_ = false;
+		mutable shared_ptr<const CopyPlan> plan_; ///< compiled from pmp_ by getPlan()
+		CopyPlan::TimingHook hook_;
 };
 
 class MemCpyDtoD : public MemCpy<MEdeviceptr, const MEdeviceptr> {
@@ -110,11 +117,17 @@ class MemCpyDtoH : public MemCpy<void*, const MEdeviceptr> {
 		           shared_ptr<AliasHandle> aliasH, bool sync = true);
 
 		MemCpyDtoH(void* dst, const MEdeviceptr src, size_t size,
-		           shared_ptr<AliasHandle> aliasH);
+		           shared_ptr<AliasHandle> aliasH, size_t offset = 0);
+
+		static MemPattern clipPattern(const MemPattern& pattern,
+		                              size_t offset, size_t size);
+		static void fillGaps(MemPattern& pattern, size_t offset, size_t size,
+		                     unsigned short gpu);
 
 		MEresult exec() override; 
 	private:
-		shared_ptr<const MemPattern> createTrivialMemPattern(size_t size) const;
+		shared_ptr<const MemPattern> createTrivialMemPattern(size_t size,
+		                                                     size_t offset) const;
 };
 
 class MemCpyHtoD : public MemCpy<MEdeviceptr, const void*> {
@@ -261,6 +274,54 @@ shared_ptr<const vector<MemSubCopy>> MemCpy<DstPtrT, SrcPtrT>::getPattern() cons
 	return pmp_;
 }
 
+/*! \brief Returns the optimized plan of the pattern.
+
+    The pattern never changes, thus the plan is compiled on the first call
+    only.
+    \sa CopyPlan::optimize
+*/
+template<class DstPtrT, class SrcPtrT>
+shared_ptr<const CopyPlan> MemCpy<DstPtrT, SrcPtrT>::getPlan() const {
+	if (!plan_) {
+		shared_ptr<CopyPlan> plan(new CopyPlan);
+		for (const auto& subcpy : *pmp_) {
+			plan->add(subcpy.src, subcpy.dst, subcpy.from, subcpy.to, subcpy.size);
+		}
+		plan->optimize();
+		plan_ = plan;
+	}
+	return plan_;
+}
+
+//! The hook is called after every submitted copy operation of exec()
+template<class DstPtrT, class SrcPtrT>
+void MemCpy<DstPtrT, SrcPtrT>::setTimingHook(const CopyPlan::TimingHook& hook) {
+	hook_ = hook;
+}
+
+/*! \brief Counts an execution, which was done by someone else.
+
+    \param time host time in seconds, which is attributed to this copy
+    \sa HaloExchange copies the halos of several copies at once.
+*/
+template<class DstPtrT, class SrcPtrT>
+void MemCpy<DstPtrT, SrcPtrT>::markExecuted(double time) {
+	time_ += time;
+	++executions_;
+}
+
+//! Executes the plan and updates the statistics
+template<class DstPtrT, class SrcPtrT>
+MEresult MemCpy<DstPtrT, SrcPtrT>::execPlan(const CopyBuffer& dst,
+                                            const CopyBuffer& src) {
+	auto time_exec_begin = Clock::now();
+	MEresult res = getPlan()->exec(dst, src, *aliasH_, sync_, hook_);
+	Duration time_exec = Clock::now() - time_exec_begin;
+	time_ += time_exec.count();
+	++executions_;
+	return res;
+}
+
 /*! \brief Sets the destination pointer.
 
     The destination pointer must be the pointer which is used in the
@@ -0,0 +1,330 @@
+#include "param_expression.h"
+#include "argument.h"
+#include "argument_type.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+#include <cmath>
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Recursive descent parser, which emits the bytecode.
+
+    Grammar:
+
+	expr    ::= term (('+' | '-') term)*
+	term    ::= unary (('*' | '/') unary)*
+	unary   ::= ('-' | '+') unary | primary
+	primary ::= number | 'arg' number | 'size_' ('x' | 'y' | 'z')
+	          | '(' expr ')'
+
+    Throws an invalid_argument exception with the reason on syntax errors.
+*/
+class ParamExpr::Parser {
+	public:
+		Parser(ParamExpr& expr) : expr_(expr), pos_(expr.str_.c_str()) {}
+
+		void parse() {
+			parseExpr();
+			skipSpace();
+			if (*pos_ != '\0') {
+				fail("unexpected character");
+			}
+		}
+
+	private:
+		void parseExpr() {
+			parseTerm();
+			while (true) {
+				skipSpace();
+				if (*pos_ == '+' || *pos_ == '-') {
+					OpCode op = *pos_ == '+' ? Add : Sub;
+					++pos_;
+					parseTerm();
+					emit(op, 0);
+				}
+				else {
+					return;
+				}
+			}
+		}
+
+		void parseTerm() {
+			parseUnary();
+			while (true) {
+				skipSpace();
+				if (*pos_ == '*' || *pos_ == '/') {
+					OpCode op = *pos_ == '*' ? Mul : Div;
+					++pos_;
+					parseUnary();
+					emit(op, 0);
+				}
+				else {
+					return;
+				}
+			}
+		}
+
+		void parseUnary() {
+			skipSpace();
+			if (*pos_ == '-') {
+				++pos_;
+				parseUnary();
+				emit(Neg, 0);
+			}
+			else if (*pos_ == '+') {
+				++pos_;
+				parseUnary();
+			}
+			else {
+				parsePrimary();
+			}
+		}
+
+		void parsePrimary() {
+			skipSpace();
+			if (*pos_ == '(') {
+				++pos_;
+				parseExpr();
+				skipSpace();
+				if (*pos_ != ')') {
+					fail("missing ')'");
+				}
+				++pos_;
+			}
+			else if (isDigit(*pos_)) {
+				emit(PushConst, parseNumber());
+			}
+			else if (startsWith("arg")) {
+				pos_ += 3;
+				if (!isDigit(*pos_)) {
+					fail("expected an argument number after 'arg'");
+				}
+				emit(PushArg, parseNumber());
+				expr_.usesArgs_ = true;
+			}
+			else if (startsWith("size_")) {
+				pos_ += 5;
+				if (*pos_ < 'x' || *pos_ > 'z') {
+					fail("expected 'x', 'y' or 'z' after 'size_'");
+				}
+				emit(PushSize, *pos_ - 'x');
+				++pos_;
+				expr_.usesLaunchSize_ = true;
+			}
+			else {
+				fail("expected a number, arg<i>, size_[x|y|z] or '('");
+			}
+		}
+
+		int64_t parseNumber() {
+			int64_t res = 0;
+			while (isDigit(*pos_)) {
+				if (__builtin_mul_overflow(res, (int64_t) 10, &res) ||
+				    __builtin_add_overflow(res, (int64_t) (*pos_ - '0'), &res)) {
+					fail("number exceeds 64 bit");
+				}
+				++pos_;
+			}
+			return res;
+		}
+
+		//! Appends an instruction and tracks the depth of the value stack
+		void emit(OpCode op, int64_t val) {
+			if (op == PushConst || op == PushArg || op == PushSize) {
+				++depth_;
+			}
+			else if (op != Neg) {
+				--depth_;
+			}
+			if (depth_ > maxStack) {
+				fail("expression is nested too deeply");
+			}
+			expr_.code_.push_back({ op, val });
+		}
+
+		bool startsWith(const char* prefix) const {
+			for (int i = 0; prefix[i] != '\0'; ++i) {
+				if (pos_[i] != prefix[i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void skipSpace() {
+			while (*pos_ == ' ' || *pos_ == '\t') {
+				++pos_;
+			}
+		}
+
+		static bool isDigit(char c) {
+			return c >= '0' && c <= '9';
+		}
+
+		void fail(const string& msg) const {
+			throw invalid_argument(msg + " at position "
+			                       + to_string(pos_ - expr_.str_.c_str()));
+		}
+
+		ParamExpr& expr_;
+		const char* pos_;
+		int depth_ = 0;
+};
+
+//! Compiles `expr`. Syntax errors are reported by eval().
+ParamExpr::ParamExpr(const string& expr) : str_(expr) {
+	try {
+		Parser(*this).parse();
+	}
+	catch (const invalid_argument& e) {
+		error_ = e.what();
+		code_.clear();
+	}
+}
+
+/*! \brief Calculates the parameter value for one kernel launch.
+    \param args the kernel launch arguments. Only needed if the expression
+           contains arg<i>.
+    \param gridSize original grid size. Only needed if the expression
+           contains size_[x|y|z].
+    \param blockSize original block size
+*/
+int64_t ParamExpr::eval(const vector<shared_ptr<const KernelArg>>* args,
+                        const Array3* gridSize, const Array3* blockSize) const {
+	auto throwError = [this] (const string& msg) {
+		throw runtime_error("SPACE Mekong, CLASS ParamExpr, FUNC eval():\n"
+		                    + msg + " (expression '" + str_ + "')\n");
+	};
+	auto throwOverflow = [this] () {
+		throw overflow_error("SPACE Mekong, CLASS ParamExpr, FUNC eval():\n"
+		                     "a temporary result exceeds 64 bit (expression '"
+		                     + str_ + "')\n");
+	};
+
+	if (!error_.empty()) {
+		throw invalid_argument("SPACE Mekong, CLASS ParamExpr, FUNC eval():\n"
+		                       "Could not parse isl read/write parameter '"
+		                       + str_ + "': " + error_ + "\n");
+	}
+	if (usesArgs_ && !args) {
+		throwError("Parameter depends on kernel arguments, but I did not get it!");
+	}
+	if (usesLaunchSize_ && (!gridSize || !blockSize)) {
+		throwError("Parameter depends on kernel launch size, but I did not get it!");
+	}
+
+	int64_t stack[maxStack];
+	int top = -1; // index of the topmost value
+	for (const Instr& instr : code_) {
+		switch (instr.op) {
+			case PushConst:
+				stack[++top] = instr.val;
+				break;
+			case PushArg:
+				stack[++top] = loadArg(*args, instr.val);
+				break;
+			case PushSize:
+				// grid and block sizes are unsigned, thus the product fits
+				stack[++top] = (int64_t) (*gridSize)[instr.val]
+				             * (int64_t) (*blockSize)[instr.val];
+				break;
+			case Add:
+				if (__builtin_add_overflow(stack[top - 1], stack[top], &stack[top - 1])) {
+					throwOverflow();
+				}
+				--top;
+				break;
+			case Sub:
+				if (__builtin_sub_overflow(stack[top - 1], stack[top], &stack[top - 1])) {
+					throwOverflow();
+				}
+				--top;
+				break;
+			case Mul:
+				if (__builtin_mul_overflow(stack[top - 1], stack[top], &stack[top - 1])) {
+					throwOverflow();
+				}
+				--top;
+				break;
+			case Div:
+				if (stack[top] == 0) {
+					throwError("division by zero");
+				}
+				if (stack[top] == -1 && stack[top - 1] == numeric_limits<int64_t>::min()) {
+					throwOverflow();
+				}
+				stack[top - 1] /= stack[top];
+				--top;
+				break;
+			case Neg:
+				if (stack[top] == numeric_limits<int64_t>::min()) {
+					throwOverflow();
+				}
+				stack[top] = -stack[top];
+				break;
+		}
+	}
+	return stack[top];
+}
+
+//! Integers are sign extended, floating point values truncated towards zero
+int64_t ParamExpr::loadArg(const vector<shared_ptr<const KernelArg>>& args,
+                           int64_t argNr) const {
+	auto throwError = [this, argNr] (const string& msg) {
+		throw runtime_error("SPACE Mekong, CLASS ParamExpr, FUNC loadArg():\n"
+		                    "arg" + to_string(argNr) + " " + msg
+		                    + " (expression '" + str_ + "')\n");
+	};
+
+	if (argNr >= (int64_t) args.size()) {
+		throwError("exceeds the number of kernel arguments");
+	}
+	const KernelArg& arg = *args[argNr];
+	auto type = arg.getType();
+	if (!type->isFundType() || type->getPtrlvl() != 0) {
+		throwError("is no scalar kernel argument");
+	}
+	if (type->isInt()) {
+		// KernelArg::asInt does not extend the sign of narrow integers
+		int64_t val = arg.asInt();
+		unsigned bits = type->getSize() * 8;
+		if (bits > 0 && bits < 64 && (val >> (bits - 1)) & 1) {
+			val |= (int64_t) (~(uint64_t) 0 << bits);
+		}
+		return val;
+	}
+	double val = type->isFloat() ? arg.asFloat() : arg.asDouble();
+	// 2^63 is exactly representable, the largest int64_t is not
+	if (!(val >= -9223372036854775808.0 && val < 9223372036854775808.0)) {
+		throw overflow_error("SPACE Mekong, CLASS ParamExpr, FUNC loadArg():\n"
+		                     "arg" + to_string(argNr) + " does not fit into 64 bit\n");
+	}
+	return (int64_t) trunc(val);
+}
+
+//! Returns the source of the expression
+const string& ParamExpr::getStr() const {
+	return str_;
+}
+
+//! Returns false if the expression could not be parsed
+bool ParamExpr::isValid() const {
+	return error_.empty();
+}
+
+bool ParamExpr::usesArgs() const {
+	return usesArgs_;
+}
+
+bool ParamExpr::usesLaunchSize() const {
+	return usesLaunchSize_;
+}
+
+}; // namespace end
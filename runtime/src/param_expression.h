@@ -0,0 +1,79 @@
+/*! \file param_expression.h
+    \brief Compiled expressions of the isl map space parameters.
+*/
+
+#ifndef MEKONG_PARAM_EXPRESSION_H
+#define MEKONG_PARAM_EXPRESSION_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <array>
+#include <cstdint>
+
+namespace Mekong {
+
+class KernelArg;
+
+using namespace std;
+
+/*! \brief An isl space parameter expression compiled to a small bytecode.
+
+    The kernel analysis describes every space parameter of an access map
+    with an expression like 'arg3 + 10' or '(size_x - 1) * arg2'. It may
+    contain integer constants, the scalar kernel arguments arg<i>, the launch
+    sizes size_[x|y|z] (grid size * block size), the operators + - * / with
+    the usual precedence, unary minus and brackets.
+
+    The expression is parsed once and evaluated for every kernel launch.
+    Evaluation does not allocate memory, does not use any global state and
+    thus can be called from several threads at once. All calculations use
+    signed 64 bit integers and throw an overflow_error if a temporary result
+    does not fit.
+
+    Expressions, which can not be parsed, are accepted by the constructor,
+    but throw an invalid_argument exception on evaluation. Thus broken
+    parameters only hurt if they are really used.
+*/
+class ParamExpr {
+	public:
+		typedef array<unsigned, 3> Array3;
+
+		ParamExpr(const string& expr);
+
+		int64_t eval(const vector<shared_ptr<const KernelArg>>* args,
+		             const Array3* gridSize, const Array3* blockSize) const;
+
+		const string& getStr() const;
+		bool isValid() const;
+		bool usesArgs() const;
+		bool usesLaunchSize() const;
+
+	private:
+		enum OpCode : uint8_t { PushConst, PushArg, PushSize,
+		                        Add, Sub, Mul, Div, Neg };
+
+		//! `val` is the constant, the argument number or the dimension
+		struct Instr {
+			OpCode op;
+			int64_t val;
+		};
+
+		//! limits the nesting of the expressions
+		static const int maxStack = 32;
+
+		class Parser;
+
+		int64_t loadArg(const vector<shared_ptr<const KernelArg>>& args,
+		                int64_t argNr) const;
+
+		string str_;
+		string error_; ///< empty if the expression was compiled
+		vector<Instr> code_;
+		bool usesArgs_ = false;
+		bool usesLaunchSize_ = false;
+};
+
+}; // namespace end
+
+#endif
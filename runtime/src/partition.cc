@@ -1,12 +1,15 @@
 #include "partitioning.h"
 #include "alias_handle.h"
 #include "partition.h"
+#include "arena.h"
 
 #include <tuple>
 #include <ostream>
 #include <stdexcept>
 #include <vector>
-#include <algorithm> // std::min, std::max
+#include <algorithm> // std::min, std::max, std::stable_sort, std::max_element
+#include <utility>
+#include <string>
 #include <memory>
 
 #include "isl/val.h"
@@ -16,22 +19,442 @@ namespace Mekong {
 
 using namespace std;
 
-/*! \brief Creates all partitions with a certain partitioning scheme.
+/*! \brief Creates a new partition on the heap.
+
+    Most partitions are transient, e.g. the candidates of the planner or
+    the partitions of a lookup. Only the partitions, which a kernel launch
+    keeps, are placed in the arena \sa Partition::commit.
+*/
+static shared_ptr<const Partition> newPartition(const Partition::Array3& grid,
+                                                const Partition::Array3& block,
+                                                const Partition::Array3& offset,
+                                                int device) {
+	return make_shared<Partition>(grid, block, offset, device);
+}
+
+/*! \brief Splits the grid into a block decomposition of the devices.
+
+    The devices form a facs[0] x ... x facs[n-1] grid, the last split
+    dimension varies fastest in the device numbering. All devices of a slab
+    along dimension dims[k] share its extent, thus the weight of a slab is
+    the sum of the weights of its devices.
+    \param dims ids of the split grid dimensions (0 = x, 1 = y, 2 = z)
+    \param facs number of slabs along every split dimension
+*/
+static vector<shared_ptr<const Partition>>
+createBlockPartitions(const Partition::Array3& orgGrid,
+                      const Partition::Array3& orgBlock,
+                      const vector<int>& dims, const vector<unsigned>& facs,
+                      const vector<double>& weights) {
+	unsigned numDev = 1;
+	for (unsigned fac : facs) {
+		numDev *= fac;
+	}
+	// coordinate of device gpu along split dimension k
+	auto coord = [&] (unsigned gpu, size_t k) {
+		for (size_t l = facs.size() - 1; l > k; --l) {
+			gpu /= facs[l];
+		}
+		return gpu % facs[k];
+	};
+
+	vector<vector<unsigned>> sizes(dims.size());
+	vector<vector<unsigned>> offsets(dims.size());
+	for (size_t k = 0; k < dims.size(); ++k) {
+		vector<double> slabWeights;
+		if (!weights.empty()) {
+			slabWeights.assign(facs[k], 0);
+			for (unsigned gpu = 0; gpu < numDev; ++gpu) {
+				slabWeights[coord(gpu, k)] += weights[gpu];
+			}
+		}
+		sizes[k] = Partition::splitWeighted(orgGrid[dims[k]], facs[k], slabWeights);
+		offsets[k].assign(facs[k], 0);
+		for (unsigned slab = 1; slab < facs[k]; ++slab) {
+			offsets[k][slab] = offsets[k][slab - 1] + sizes[k][slab - 1];
+		}
+	}
+
+	vector<shared_ptr<const Partition>> res;
+	res.reserve(numDev);
+	for (unsigned gpu = 0; gpu < numDev; ++gpu) {
+		Partition::Array3 work = orgGrid;
+		Partition::Array3 offset = {0, 0, 0};
+		for (size_t k = 0; k < dims.size(); ++k) {
+			unsigned slab = coord(gpu, k);
+			work[dims[k]] = sizes[k][slab];
+			offset[dims[k]] = offsets[k][slab] * orgBlock[dims[k]];
+		}
+		res.push_back(newPartition(work, orgBlock, offset, gpu));
+	}
+	return res;
+}
+
+/*! \brief Splits the grid into rows along the small dimension, which hold a
+           different number of devices each.
+
+    A ragged process grid splits the grid for any number of devices, e.g. 7
+    devices as rows of 4 and 3 devices. The height of a row is proportional
+    to the sum of the weights of its devices, the devices of a row split its
+    width according to their weights. The devices are numbered row by row.
+    \param rowDevs number of devices of every row
+*/
+static vector<shared_ptr<const Partition>>
+createRaggedPartitions(const Partition::Array3& orgGrid,
+                       const Partition::Array3& orgBlock,
+                       int smallDim, int largeDim,
+                       const vector<unsigned>& rowDevs,
+                       const vector<double>& weights) {
+	vector<double> rowWeights(rowDevs.size(), 0);
+	unsigned gpu = 0;
+	for (size_t row = 0; row < rowDevs.size(); ++row) {
+		for (unsigned col = 0; col < rowDevs[row]; ++col, ++gpu) {
+			rowWeights[row] += weights.empty() ? 1.0 : weights[gpu];
+		}
+	}
+	vector<unsigned> rows = Partition::splitWeighted(orgGrid[smallDim],
+	                                                 rowDevs.size(), rowWeights);
 
-    \param aliasH to determine the number of available gpus and to get all the
-           kernel function pointers.
+	vector<shared_ptr<const Partition>> res;
+	res.reserve(gpu);
+	gpu = 0;
+	unsigned rowOffset = 0;
+	for (size_t row = 0; row < rowDevs.size(); ++row) {
+		vector<double> colWeights;
+		if (!weights.empty()) {
+			colWeights.assign(weights.begin() + gpu,
+			                  weights.begin() + gpu + rowDevs[row]);
+		}
+		vector<unsigned> cols = Partition::splitWeighted(orgGrid[largeDim],
+		                                                 rowDevs[row], colWeights);
+		unsigned colOffset = 0;
+		for (unsigned col = 0; col < rowDevs[row]; ++col, ++gpu) {
+			Partition::Array3 work = orgGrid;
+			Partition::Array3 offset = {0, 0, 0};
+			work[smallDim] = rows[row];
+			work[largeDim] = cols[col];
+			offset[smallDim] = rowOffset * orgBlock[smallDim];
+			offset[largeDim] = colOffset * orgBlock[largeDim];
+			res.push_back(newPartition(work, orgBlock, offset, gpu));
+			colOffset += cols[col];
+		}
+		rowOffset += rows[row];
+	}
+	return res;
+}
 
-    \todo Ensure that the returned vector is sorted by GPU id.
-          This can improve performance, as we do not always have to push
-          different contexts if we cycle through the partitions. This can have
-          an effect if we have multiple partitions for a GPU.
+/*! \brief Deals tiles of `cycle` blocks along every split dimension round
+           robin to the devices of a facs[0] x ... x facs[n-1] process grid.
+
+    Kernels, whose work is not uniform across the grid (e.g. a triangular
+    iteration space), give every device a share of the expensive and the
+    cheap regions. Every tile is a partition of its own, the partitions are
+    sorted by device. The cycle length shrinks, if a dimension has less
+    tiles than devices.
+    \sa Partition::setCycleLength
+*/
+static vector<shared_ptr<const Partition>>
+createCyclicPartitions(const Partition::Array3& orgGrid,
+                       const Partition::Array3& orgBlock,
+                       const vector<int>& dims, const vector<unsigned>& facs,
+                       unsigned cycle) {
+	unsigned numDev = 1;
+	vector<unsigned> cycles(dims.size());
+	vector<unsigned> numTiles(dims.size());
+	unsigned totalTiles = 1;
+	for (size_t k = 0; k < dims.size(); ++k) {
+		numDev *= facs[k];
+		cycles[k] = max(1u, min(cycle, orgGrid[dims[k]] / facs[k]));
+		numTiles[k] = (orgGrid[dims[k]] + cycles[k] - 1) / cycles[k];
+		totalTiles *= numTiles[k];
+	}
+
+	vector<vector<shared_ptr<const Partition>>> perDev(numDev);
+	for (unsigned tile = 0; tile < totalTiles; ++tile) {
+		// the last split dimension varies fastest, as in the device numbering
+		Partition::Array3 work = orgGrid;
+		Partition::Array3 offset = {0, 0, 0};
+		unsigned gpu = 0;
+		unsigned rest = tile;
+		unsigned stride = 1;
+		for (size_t k = dims.size(); k-- > 0;) {
+			unsigned t = rest % numTiles[k];
+			rest /= numTiles[k];
+			unsigned begin = t * cycles[k];
+			work[dims[k]] = min(cycles[k], orgGrid[dims[k]] - begin);
+			offset[dims[k]] = begin * orgBlock[dims[k]];
+			gpu += (t % facs[k]) * stride;
+			stride *= facs[k];
+		}
+		perDev[gpu].push_back(newPartition(work, orgBlock, offset, gpu));
+	}
+
+	vector<shared_ptr<const Partition>> res;
+	res.reserve(totalTiles);
+	for (auto& parts : perDev) {
+		res.insert(res.end(), parts.begin(), parts.end());
+	}
+	return res;
+}
+
+unsigned Partition::cycleLength_ = 0;
+
+/*! \brief Enables the block-cyclic distribution.
+
+    \param cycle number of blocks of a tile along every split dimension,
+           0 gives every device one contiguous partition.
+    \sa createPartitions
+*/
+void Partition::setCycleLength(unsigned cycle) {
+	cycleLength_ = cycle;
+}
+
+unsigned Partition::getCycleLength() {
+	return cycleLength_;
+}
+
+unsigned Partition::overDecomposition_ = 1;
+
+/*! \brief Gives every device `factor` partitions, which are launched on
+           their own streams.
+
+    Smaller partitions let the boundary partitions finish early and the
+    load balancer move less blocks at a time. Each partition costs a launch
+    latency, thus small factors like 2 to 4 are enough.
+    \param factor partitions per device, 0 and 1 give one partition
+    \sa KernelLaunch::exec
+*/
+void Partition::setOverDecomposition(unsigned factor) {
+	overDecomposition_ = max(factor, 1u);
+}
+
+unsigned Partition::getOverDecomposition() {
+	return overDecomposition_;
+}
+
+/*! \brief Merges adjacent partitions of the same device into larger boxes.
+
+    The access maps are applied once per box, thus the arg accesses of a
+    device with many partitions need less isl operations. The merged boxes
+    cover exactly the threads of the partitions, they are not launched.
+    \sa KernelLaunch::accessedSet
+*/
+vector<shared_ptr<const Partition>>
+Partition::coalesce(const vector<shared_ptr<const Partition>>& parts) {
+	vector<shared_ptr<const Partition>> res(parts);
+	bool merged = true;
+	while (merged) {
+		merged = false;
+		for (size_t i = 0; i < res.size() && !merged; ++i) {
+			for (size_t j = i + 1; j < res.size() && !merged; ++j) {
+				const Partition& a = *res[i];
+				const Partition& b = *res[j];
+				if (a.device_ != b.device_ || a.block_ != b.block_) {
+					continue;
+				}
+				// equal in two dimensions, adjacent in the third one
+				for (int d = 0; d < 3 && !merged; ++d) {
+					bool sameElsewhere = true;
+					for (int e = 0; e < 3; ++e) {
+						if (e != d && (a.offset_[e] != b.offset_[e] ||
+						               a.grid_[e] != b.grid_[e])) {
+							sameElsewhere = false;
+						}
+					}
+					const Partition& lo = a.offset_[d] < b.offset_[d] ? a : b;
+					const Partition& hi = a.offset_[d] < b.offset_[d] ? b : a;
+					if (!sameElsewhere ||
+					    lo.offset_[d] + lo.grid_[d] * lo.block_[d] != hi.offset_[d]) {
+						continue;
+					}
+					Array3 grid = lo.grid_;
+					grid[d] += hi.grid_[d];
+					res[i] = make_shared<Partition>(grid, lo.block_, lo.offset_, lo.device_);
+					res.erase(res.begin() + j);
+					merged = true;
+				}
+			}
+		}
+	}
+	return res;
+}
+
+/*! \brief Copies the partitions, which a kernel launch keeps, into the
+           process wide partition arena.
+
+    Partitions live as long as their kernel launches, which are never freed.
+    The arena is intentionally never deleted to avoid static destruction
+    order problems with the kernel launches.
+*/
+vector<shared_ptr<const Partition>>
+Partition::commit(const vector<shared_ptr<const Partition>>& parts) {
+	static Arena<Partition>* arena = new Arena<Partition>;
+	vector<shared_ptr<const Partition>> res;
+	res.reserve(parts.size());
+	for (const auto& part : parts) {
+		res.push_back(arena->share(arena->create(part->grid_, part->block_,
+		                                         part->offset_, part->device_)));
+	}
+	return res;
+}
+
+/*! \brief Widens every partition by `halo` blocks on both sides of its
+           split dimensions.
+
+    The dimensions, in which a partition spans the whole grid, stay as they
+    are, the widened partitions are clamped to the grid. Neighbouring
+    partitions overlap afterwards, thus their devices compute the overlap
+    redundantly \sa KernelLaunch::getBlockingPhase.
+    \param orgGrid the grid of the launch in blocks
+*/
+vector<shared_ptr<const Partition>>
+Partition::extend(const vector<shared_ptr<const Partition>>& parts,
+                  const Array3& orgGrid, unsigned halo) {
+	vector<shared_ptr<const Partition>> res;
+	res.reserve(parts.size());
+	for (const auto& part : parts) {
+		Array3 grid = part->grid_;
+		Array3 offset = part->offset_;
+		for (int d = 0; d < 3; ++d) {
+			if (grid[d] >= orgGrid[d]) {
+				continue;
+			}
+			unsigned first = offset[d] / part->block_[d];
+			unsigned last = first + grid[d];
+			first = first > halo ? first - halo : 0;
+			last = min(last + halo, orgGrid[d]);
+			grid[d] = last - first;
+			offset[d] = first * part->block_[d];
+		}
+		res.push_back(make_shared<Partition>(grid, part->block_, offset, part->device_));
+	}
+	return res;
+}
+
+/*! \brief Creates all partitions with a certain partitioning scheme.
+
+    The grid is split according to the device weights of the alias handle,
+    thus evenly if no weights are set.
+    \param aliasH to determine the number of available gpus and their weights.
+    \sa AliasHandle::setDevWeights
 */
 vector<shared_ptr<const Partition>>
 Partition::createPartitions(const Array3& orgGrid, const Array3& orgBlock,
                             shared_ptr<AliasHandle> aliasH,
                             shared_ptr<const Partitioning> parting) {
+	return createPartitions(orgGrid, orgBlock, aliasH, parting,
+	                        aliasH->getDevWeights());
+}
+
+/*! \brief Creates all partitions, each device gets a share of the grid
+           proportional to its weight.
+
+    Devices of different generations finish equally sized partitions at
+    different times. Giving a faster device more blocks lets all devices
+    finish together. The arg accesses and the dependency resolutions are
+    calculated from the partitions, thus they match the weighted split.
+    \param aliasH to determine the number of available gpus.
+    \param weights relative speed of every device. An empty vector splits
+           evenly. The block-cyclic mode deals equal tiles and ignores the
+           weights \sa setCycleLength
+    \return the partitions sorted by device, also with several partitions
+            per device \sa setOverDecomposition
+*/
+vector<shared_ptr<const Partition>>
+Partition::createPartitions(const Array3& orgGrid, const Array3& orgBlock,
+                            shared_ptr<AliasHandle> aliasH,
+                            shared_ptr<const Partitioning> parting,
+                            const vector<double>& weights) {
+	return createPartitions(orgGrid, orgBlock, aliasH->getNumDev(), parting,
+	                        weights);
+}
+
+/*! \brief Creates all partitions on the devices `firstDev` up to
+           `firstDev + numDev - 1`.
+
+    Independent launches run side by side on disjoint device groups
+    \sa DeviceGroups.
+    \param weights relative speed of the `numDev` devices
+*/
+vector<shared_ptr<const Partition>>
+Partition::createPartitions(const Array3& orgGrid, const Array3& orgBlock,
+                            unsigned short firstDev, unsigned short numDev,
+                            shared_ptr<const Partitioning> parting,
+                            const vector<double>& weights) {
+	vector<shared_ptr<const Partition>> res =
+		createPartitions(orgGrid, orgBlock, numDev, parting, weights);
+	if (firstDev > 0) {
+		for (auto& part : res) {
+			part = newPartition(part->getGrid(), part->getBlock(), part->getOffset(),
+			                    part->getDevice() + firstDev);
+		}
+	}
+	return res;
+}
+
+/*! \brief Creates all partitions on the first `numDev` devices.
+
+    Small grids run faster on less devices, because the fixed costs of
+    every device outweigh its share of the work. Subsets are always the
+    first devices, thus launches with different device counts share as
+    much data as possible.
+    \param weights relative speed of the first `numDev` devices
+    \sa PartitionPlanner
+*/
+vector<shared_ptr<const Partition>>
+Partition::createPartitions(const Array3& orgGrid, const Array3& orgBlock,
+                            unsigned short numDev,
+                            shared_ptr<const Partitioning> parting,
+                            const vector<double>& weights) {
+	if (!weights.empty() && weights.size() != numDev) {
+		throw invalid_argument("There must be one weight per device, but I got " +
+		                       to_string(weights.size()) + " weights for " +
+		                       to_string(numDev) + " devices.");
+	}
+
+	vector<shared_ptr<const Partition>> res =
+		splitGrid(orgGrid, orgBlock, numDev, parting, weights);
+	// the block-cyclic mode already gives every device many tiles
+	if (overDecomposition_ <= 1 || cycleLength_ > 0) {
+		return res;
+	}
+
+	// Over-decomposition: every partition is cut into `factor` slabs along
+	// its longest split dimension, thus the devices keep their share.
+	vector<shared_ptr<const Partition>> subParts;
+	for (const auto& part : res) {
+		int dim = -1;
+		for (int d = 0; d < 3; ++d) {
+			if (parting->isSplitAt((unsigned short) d) &&
+			    (dim < 0 || part->getGrid()[d] > part->getGrid()[dim])) {
+				dim = d;
+			}
+		}
+		unsigned factor = min(overDecomposition_, part->getGrid()[dim]);
+		vector<unsigned> slabs = splitWeighted(part->getGrid()[dim], factor, {});
+		Array3 offset = part->getOffset();
+		for (unsigned slab : slabs) {
+			Array3 grid = part->getGrid();
+			grid[dim] = slab;
+			subParts.push_back(newPartition(grid, orgBlock, offset, part->getDevice()));
+			offset[dim] += slab * orgBlock[dim];
+		}
+	}
+	return subParts;
+}
+
+/*! \brief Splits the grid into one partition per device or, in the
+           block-cyclic mode, into tiles.
+
+    \param weights one weight per device or empty
+    \throw invalid_argument if the grid is too small for the scheme
+*/
+vector<shared_ptr<const Partition>>
+Partition::splitGrid(const Array3& orgGrid, const Array3& orgBlock,
+                     unsigned short numDev, shared_ptr<const Partitioning> parting,
+                     const vector<double>& weights) {
 	vector<shared_ptr<const Partition>> res;
-	unsigned short numDev = aliasH->getNumDev();
+	res.reserve(numDev);
 
 	// Get the id of the dimensions which should be splitted
 	int splitDims[3];
@@ -100,81 +523,104 @@ Partition::createPartitions(const Array3& orgGrid, const Array3& orgBlock,
 		//     x   x | x   x | x   x | x   x | x   x | x   x | x   x | x   x
 		//     -------------------------------------------------------------
 		//     x   x | x   x | x   x | x   x | x   x | x   x | x   x | x   x
-
-		if (smallGridSize < 2) {
+		//
+		// Example IV (4x6 grid and 5 devices, a ragged process grid):
+		//
+		//     x   x | x   x | x   x
+		//           |       |
+		//     x   x | x   x | x   x
+		//     ---------------------
+		//     x   x   x | x   x   x
+		//               |
+		//     x   x   x | x   x   x
+
+		// Pick the rows of the ragged process grid with the smallest cut
+		// surface. A cut between two rows spans the large dimension, a cut
+		// between two devices of a row is as high as the row. A number of
+		// rows, which divides numDev, gives a regular process grid, one row
+		// gives a 1D split along the large dimension. Ties go to more rows,
+		// which keeps the partitions square.
+		vector<unsigned> bestRowDevs;
+		double bestSurface = 0;
+		double largeExtent = (double) orgGrid[largeDim] * orgBlock[largeDim];
+		for (unsigned numRows = min<unsigned>(numDev, smallGridSize); numRows > 0; --numRows) {
+			vector<unsigned> rowDevs = splitWeighted(numDev, numRows, {});
+			if (rowDevs[0] > largeGridSize) { continue; }
+			vector<unsigned> rows = splitWeighted(orgGrid[smallDim], numRows,
+			                                      vector<double>(rowDevs.begin(), rowDevs.end()));
+			double surface = (numRows - 1) * largeExtent;
+			for (unsigned row = 0; row < numRows; ++row) {
+				surface += (rowDevs[row] - 1) * (double) rows[row] * orgBlock[smallDim];
+			}
+			if (bestRowDevs.empty() || surface < bestSurface) {
+				bestRowDevs = move(rowDevs);
+				bestSurface = surface;
+			}
+		}
+		if (bestRowDevs.empty()) {
 			throw invalid_argument(
-				"I should split along dimensions " + parting->getSplitStr() +
-				", but the smallest of both dimensions has only a size of " +
-				to_string(smallGridSize) +
-				", wich I can not split in a two dimensional way."
+				"I should split along dimensions " + parting->getSplitStr() + ". "
+				"My split algorithm failed on the grid with size " +
+				"(" + to_string(orgGrid[0]) + ", " + to_string(orgGrid[1]) +
+				", " + to_string(orgGrid[2]) + ")"
 			);
 		}
-
-		for (int i = numDev/2; i > 1; --i) {
-			if (numDev % i == 0) {
-				int ii = numDev / i;
-				// now ii * i = numDev
-				int small_fac = min(ii, i);
-				int large_fac = max(ii, i);
-				// If the small factor is too large, search for a smaller one
-				if (small_fac > smallGridSize) { continue; }
-				else {
-					// Calculate how many work is on split dimension small;
-					// analog to 1D splitting for small_i gpus
-
-					vector<Array3> work(numDev, orgGrid);
-
-					for (unsigned short gpu = 0; gpu < numDev; ++gpu) {
-						work[gpu][smallDim] = orgGrid[smallDim] / small_fac;
-					}
-					// distribute the rest along the gpus
-					for (size_t rest = 0; rest < (orgGrid[smallDim] % small_fac); ++rest) {
-						++work[rest % numDev][smallDim];
-					}
-
-					// Calculate how many work is on split dimension big;
-					// analog to 1D splitting for big_i gpus
-					for (unsigned short gpu = 0; gpu < numDev; ++gpu) {
-						work[gpu][largeDim] = orgGrid[largeDim] / large_fac;
-					}
-					// distribute the rest along the gpus
-					for (size_t rest = 0; rest < (orgGrid[largeDim] % large_fac); ++rest) {
-						++work[rest % numDev][largeDim];
-					}
-
-					// Calculate the offsets
-					vector<Array3> offset(numDev, {0, 0, 0});
-					for (int i = 0; i < 2; ++i) {
-						int currSplitDim = splitDims[i];
-						unsigned count = work[0][currSplitDim];
-						for (unsigned short gpu = 1; gpu < numDev; ++gpu) {
-							offset[gpu][currSplitDim] = count * orgBlock[currSplitDim];
-							count += work[gpu][currSplitDim];
-						}
-					}
-
-					for (unsigned short gpu = 0; gpu < numDev; ++gpu) {
-						shared_ptr<const Partition> sh(new Partition(work[gpu], orgBlock, offset[gpu], gpu));
-						res.push_back(sh);
-					}
-					return res;
+		if (cycleLength_ > 0) {
+			// tiles need a regular process grid
+			unsigned numRows = bestRowDevs.size();
+			if (numDev % numRows != 0) {
+				numRows = 1;
+			}
+			return createCyclicPartitions(orgGrid, orgBlock, { smallDim, largeDim },
+			                              { numRows, numDev / numRows }, cycleLength_);
+		}
+		return createRaggedPartitions(orgGrid, orgBlock, smallDim, largeDim,
+		                              bestRowDevs, weights);
+	}
+/*******************
+ * 3D PARTITIONING *
+ *******************/
+	if (parting->getSplitStr().size() == 3) {
+		// Every cut along dimension d adds a face of N / N_d threads, where
+		// N_d is the extent of the grid along d in threads. The halos, which
+		// have to be exchanged, grow with these faces, thus pick the factors
+		// px * py * pz = numDev with the smallest cut surface.
+		double volume = 1;
+		Array3 extent;
+		for (int d = 0; d < 3; ++d) {
+			extent[d] = orgGrid[d] * orgBlock[d];
+			volume *= extent[d];
+		}
+		vector<unsigned> best;
+		double bestSurface = 0;
+		for (unsigned px = 1; px <= numDev; ++px) {
+			if (numDev % px != 0 || px > orgGrid[0]) { continue; }
+			for (unsigned py = 1; py <= numDev / px; ++py) {
+				if ((numDev / px) % py != 0 || py > orgGrid[1]) { continue; }
+				unsigned pz = numDev / px / py;
+				if (pz > orgGrid[2]) { continue; }
+				double surface = (px - 1) * volume / extent[0] +
+				                 (py - 1) * volume / extent[1] +
+				                 (pz - 1) * volume / extent[2];
+				if (best.empty() || surface < bestSurface) {
+					best = { px, py, pz };
+					bestSurface = surface;
 				}
-			} // if (numDev % i == 0)
-		} // loop over i
-		throw invalid_argument(
-			"I should split along dimensions " + parting->getSplitStr() + ". "
-			"My split algorithm failed on the grid with size " +
-			"(" + to_string(orgGrid[0]) + ", " + to_string(orgGrid[1]) +
-			", " + to_string(orgGrid[2]) + ")"
-		);
-	}
-/***************************
- * nD PARTITIONING (n > 2) *
- * not supported yet       *
- ***************************/
-	if (parting->getSplitStr().size() > 2) {
-		throw invalid_argument("Splitting along more than two dimensions is not "
-		                       "supported yet!");
+			}
+		}
+		if (best.empty()) {
+			throw invalid_argument(
+				"I should split along dimensions " + parting->getSplitStr() + ". "
+				"My split algorithm failed on the grid with size " +
+				"(" + to_string(orgGrid[0]) + ", " + to_string(orgGrid[1]) +
+				", " + to_string(orgGrid[2]) + ")"
+			);
+		}
+		if (cycleLength_ > 0) {
+			return createCyclicPartitions(orgGrid, orgBlock, { 0, 1, 2 }, best,
+			                              cycleLength_);
+		}
+		return createBlockPartitions(orgGrid, orgBlock, { 0, 1, 2 }, best, weights);
 	}
 
 /*******************
@@ -188,15 +634,18 @@ Partition::createPartitions(const Array3& orgGrid, const Array3& orgBlock,
 		                       "is smaller than number of gpus.");
 	}
 
+	if (cycleLength_ > 0) {
+		return createCyclicPartitions(orgGrid, orgBlock, { currSplitDim },
+		                              { numDev }, cycleLength_);
+	}
+
 	// CALCULATE THE WORK FOR EVERY GPU
-	// First we calculate how many rows each gpu has work along the splitted dimension
+	// First we calculate how many rows each gpu has work along the splitted
+	// dimension, proportional to the device weights
+	vector<unsigned> rows = splitWeighted(orgGrid[currSplitDim], numDev, weights);
 	vector<Array3> work(numDev, orgGrid);
 	for (unsigned short gpu = 0; gpu < numDev; ++gpu) {
-		work[gpu][currSplitDim] = orgGrid[currSplitDim] / numDev;
-	}
-	// distribute the rest along the gpus
-	for (size_t rest = 0; rest < orgGrid[currSplitDim] % numDev; ++rest) {
-		++work[rest % numDev][currSplitDim];
+		work[gpu][currSplitDim] = rows[gpu];
 	}
 
 	// CALCULATE THE GPU OFFSET ON THE GRID
@@ -209,8 +658,67 @@ Partition::createPartitions(const Array3& orgGrid, const Array3& orgBlock,
 	}
 
 	for (unsigned short gpu = 0; gpu < numDev; ++gpu) {
-		shared_ptr<const Partition> sh(new Partition(work[gpu], orgBlock, offset[gpu], gpu));
-		res.push_back(sh);
+		res.push_back(newPartition(work[gpu], orgBlock, offset[gpu], gpu));
+	}
+	return res;
+}
+
+/*! \brief Splits `size` blocks into `n` parts, proportional to the weights.
+
+    Uses the largest remainder method, thus equal weights give the first
+    `size % n` parts one block more than the others. If `size` is at least
+    `n`, every part gets at least one block.
+    \param weights one weight per part. An empty vector splits evenly.
+*/
+vector<unsigned> Partition::splitWeighted(unsigned size, unsigned n,
+                                          const vector<double>& weights) {
+	if (weights.empty()) {
+		vector<unsigned> res(n, size / n);
+		for (unsigned rest = 0; rest < size % n; ++rest) {
+			++res[rest];
+		}
+		return res;
+	}
+	if (weights.size() != n) {
+		throw invalid_argument("I need " + to_string(n) + " weights, but I got " +
+		                       to_string(weights.size()) + ".");
+	}
+	double total = 0;
+	for (double w : weights) {
+		if (!(w > 0)) {
+			throw invalid_argument("Device weights must be positive, but I got " +
+			                       to_string(w) + ".");
+		}
+		total += w;
+	}
+
+	vector<unsigned> res(n);
+	vector<pair<double, size_t>> remainders; // (remainder, part)
+	remainders.reserve(n);
+	unsigned assigned = 0;
+	for (size_t i = 0; i < n; ++i) {
+		double exact = size * weights[i] / total;
+		res[i] = min((unsigned) exact, size - assigned);
+		assigned += res[i];
+		remainders.push_back(make_pair(exact - res[i], i));
+	}
+	// the largest remainders get the rest, ties go to the lower part
+	stable_sort(remainders.begin(), remainders.end(),
+	            [] (const pair<double, size_t>& a, const pair<double, size_t>& b) {
+		return a.first > b.first;
+	});
+	for (size_t k = 0; assigned < size; ++k) {
+		++res[remainders[k % n].second];
+		++assigned;
+	}
+	// every device needs work, if there is enough
+	if (size >= n) {
+		for (auto& part : res) {
+			if (part == 0) {
+				--*max_element(res.begin(), res.end());
+				++part;
+			}
+		}
 	}
 	return res;
 }
@@ -279,6 +787,23 @@ int Partition::getDevice() const {
 	return device_;
 }
 
+//! True if the thread boxes of both partitions share a face
+bool Partition::touches(const Partition& other) const {
+	int adjacent = 0;
+	for (int d = 0; d < 3; ++d) {
+		size_t lo = max(offset_[d], other.offset_[d]);
+		size_t hi = min((size_t) offset_[d] + (size_t) grid_[d] * block_[d],
+		                (size_t) other.offset_[d] + (size_t) other.grid_[d] * other.block_[d]);
+		if (lo == hi) {
+			++adjacent;
+		}
+		else if (lo > hi) {
+			return false;
+		}
+	}
+	return adjacent == 1;
+}
+
 ostream& operator<<(ostream& out, const Partition& p) {
 	auto print3 = [&] (const Partition::Array3& a) {
 		out << "(" << a[0] << ", " << a[1] << ", " << a[2] << ")";
@@ -22,6 +22,38 @@ class Partition {
 		                 const Array3& orgBlock,
 		                 shared_ptr<AliasHandle> aliasH,
 		                 shared_ptr<const Partitioning> parting);
+		static vector<shared_ptr<const Partition>>
+		createPartitions(const Array3& orgGrid,
+		                 const Array3& orgBlock,
+		                 shared_ptr<AliasHandle> aliasH,
+		                 shared_ptr<const Partitioning> parting,
+		                 const vector<double>& weights);
+		static vector<shared_ptr<const Partition>>
+		createPartitions(const Array3& orgGrid,
+		                 const Array3& orgBlock,
+		                 unsigned short numDev,
+		                 shared_ptr<const Partitioning> parting,
+		                 const vector<double>& weights);
+		static vector<shared_ptr<const Partition>>
+		createPartitions(const Array3& orgGrid,
+		                 const Array3& orgBlock,
+		                 unsigned short firstDev,
+		                 unsigned short numDev,
+		                 shared_ptr<const Partitioning> parting,
+		                 const vector<double>& weights);
+		static vector<unsigned> splitWeighted(unsigned size, unsigned n,
+		                                      const vector<double>& weights);
+		static void setCycleLength(unsigned cycle);
+		static unsigned getCycleLength();
+		static void setOverDecomposition(unsigned factor);
+		static unsigned getOverDecomposition();
+		static vector<shared_ptr<const Partition>>
+		coalesce(const vector<shared_ptr<const Partition>>& parts);
+		static vector<shared_ptr<const Partition>>
+		extend(const vector<shared_ptr<const Partition>>& parts,
+		       const Array3& orgGrid, unsigned halo);
+		static vector<shared_ptr<const Partition>>
+		commit(const vector<shared_ptr<const Partition>>& parts);
 
 		Partition(const Array3& grid,
 		          const Array3& block,
@@ -31,12 +63,21 @@ class Partition {
 		const Array3& getOffset() const;
 		Array3 getSize() const;
 		int getDevice() const;
+		bool touches(const Partition& other) const;
 
 	private:
+		static vector<shared_ptr<const Partition>>
+		splitGrid(const Array3& orgGrid, const Array3& orgBlock,
+		          unsigned short numDev, shared_ptr<const Partitioning> parting,
+		          const vector<double>& weights);
+
 		Array3 grid_;   ///< number of blocks
 		Array3 block_;  ///< number of threads per block
 		Array3 offset_; ///< offset in threads on the total grid
 		int device_;
+
+		static unsigned cycleLength_; ///< tile size of the block-cyclic mode
+		static unsigned overDecomposition_; ///< partitions per device
 };
 
 ostream& operator<<(ostream& out, const Partition& p);
@@ -0,0 +1,192 @@
+#include "partition_planner.h"
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm> // std::max
+
+namespace Mekong {
+
+using namespace std;
+
+bool PartitionPlanner::enabled_ = false;
+bool PartitionPlanner::deviceCountSelection_ = false;
+bool PartitionPlanner::calibrated_ = false;
+PartitionPlanner::CostModel PartitionPlanner::model_;
+
+/*! \brief Returns the schemes worth evaluating for a grid.
+
+    The hint (the partitioning of the analysis database) comes first, thus
+    it wins ties. The other candidates split only dimensions with more than
+    one block.
+*/
+vector<shared_ptr<const Partitioning>>
+PartitionPlanner::getCandidates(const Partition::Array3& grid,
+                                shared_ptr<const Partitioning> hint) {
+	// the schemes are shared by all launches, like the ones of the database
+	static const vector<shared_ptr<const Partitioning>> all = {
+		make_shared<Partitioning>("x"),  make_shared<Partitioning>("y"),
+		make_shared<Partitioning>("z"),  make_shared<Partitioning>("xy"),
+		make_shared<Partitioning>("xz"), make_shared<Partitioning>("yz"),
+		make_shared<Partitioning>("xyz")
+	};
+
+	vector<shared_ptr<const Partitioning>> res;
+	res.push_back(hint);
+	for (const auto& parting : all) {
+		if (*parting == *hint) {
+			continue;
+		}
+		bool splittable = true;
+		for (unsigned short dim = 0; dim < 3; ++dim) {
+			if (parting->isSplitAt(dim) && grid[dim] < 2) {
+				splittable = false;
+			}
+		}
+		if (splittable) {
+			res.push_back(parting);
+		}
+	}
+	return res;
+}
+
+/*! \brief Returns the device counts worth evaluating: all devices and
+           halves of it down to one device.
+*/
+vector<unsigned short> PartitionPlanner::getDeviceCounts(unsigned short numDev) {
+	vector<unsigned short> res;
+	for (unsigned short n = numDev; n > 0; n /= 2) {
+		res.push_back(n);
+	}
+	return res;
+}
+
+/*! \brief Predicts the seconds of one iteration with the partitions `parts`.
+
+    \param exchange estimated data every device receives, one per device
+*/
+double PartitionPlanner::predictTime(const vector<shared_ptr<const Partition>>& parts,
+                                     const vector<Exchange>& exchange,
+                                     const CostModel& model) {
+	return predictBlockingTime({ parts }, exchange, model);
+}
+
+/*! \brief Predicts the seconds of one iteration, if the launches run a
+           cycle of phases and exchange data only before the first phase.
+
+    Every phase computes and launches its own partitions, but the devices
+    synchronize and receive their data once per cycle, thus the phases
+    share these costs. A cycle of one phase is an ordinary iteration.
+    \param phases the partitions of every phase, they may overlap
+    \param exchange estimated data every device receives per cycle
+    \sa KernelLaunch::getBlockingPhase
+*/
+double
+PartitionPlanner::predictBlockingTime(const vector<vector<shared_ptr<const Partition>>>& phases,
+                                      const vector<Exchange>& exchange,
+                                      const CostModel& model) {
+	if (phases.empty()) {
+		return 0;
+	}
+	double res = 0;
+	size_t usedDevs = 0;
+	for (const auto& parts : phases) {
+		// the devices compute in parallel, the host launches one after another
+		vector<double> threads(exchange.size(), 0);
+		for (const auto& part : parts) {
+			Partition::Array3 size = part->getSize();
+			double partThreads = (double) size[0] * size[1] * size[2];
+			if ((size_t) part->getDevice() >= threads.size()) {
+				threads.resize(part->getDevice() + 1, 0);
+			}
+			threads[part->getDevice()] += partThreads;
+		}
+		double compute = 0;
+		size_t devs = 0;
+		for (double t : threads) {
+			compute = max(compute, t / model.threadRate);
+			devs += t > 0 ? 1 : 0;
+		}
+		res += compute + parts.size() * model.launchLatency;
+		usedDevs = max(usedDevs, devs);
+	}
+
+	// every device receives its data over its own link
+	double transfer = 0;
+	for (const auto& ex : exchange) {
+		transfer = max(transfer, ex.copies * model.copyLatency +
+		                         ex.bytes / model.linkBW);
+	}
+	res += usedDevs * model.deviceLatency + transfer;
+	return res / phases.size();
+}
+
+/*! \brief Refines the compute rate of the cost model with the measured
+           times of an execution.
+
+    The slowest device determines the iteration time, thus its rate is the
+    one, which the prediction needs. The first measurement replaces the
+    estimate from the device properties, later ones are smoothed.
+    \param times seconds of every partition \sa KernelLaunch::getPartitionTimes
+    \return the measured rate in threads per second, 0 if it is unusable
+*/
+double PartitionPlanner::calibrate(const vector<shared_ptr<const Partition>>& parts,
+                                   const vector<double>& times) {
+	if (parts.size() != times.size()) {
+		return 0;
+	}
+	vector<double> threads;
+	vector<double> seconds;
+	for (size_t partId = 0; partId < parts.size(); ++partId) {
+		size_t dev = parts[partId]->getDevice();
+		if (dev >= threads.size()) {
+			threads.resize(dev + 1, 0);
+			seconds.resize(dev + 1, 0);
+		}
+		Partition::Array3 size = parts[partId]->getSize();
+		threads[dev] += (double) size[0] * size[1] * size[2];
+		seconds[dev] += times[partId];
+	}
+	double rate = 0;
+	for (size_t dev = 0; dev < threads.size(); ++dev) {
+		if (seconds[dev] <= 0) {
+			continue;
+		}
+		double r = threads[dev] / seconds[dev];
+		rate = (rate == 0 || r < rate) ? r : rate;
+	}
+	if (rate == 0) {
+		return 0;
+	}
+	model_.threadRate = calibrated_ ? 0.5 * (model_.threadRate + rate) : rate;
+	calibrated_ = true;
+	return rate;
+}
+
+//! Affects only launches created afterwards \sa KernelLaunch::setPartitions
+void PartitionPlanner::setEnabled(bool enable) {
+	enabled_ = enable;
+}
+
+bool PartitionPlanner::isEnabled() {
+	return enabled_;
+}
+
+//! Affects only launches created afterwards \sa KernelLaunch::setPartitions
+void PartitionPlanner::setDeviceCountSelection(bool enable) {
+	deviceCountSelection_ = enable;
+}
+
+bool PartitionPlanner::isDeviceCountSelection() {
+	return deviceCountSelection_;
+}
+
+void PartitionPlanner::setCostModel(const CostModel& model) {
+	model_ = model;
+}
+
+const PartitionPlanner::CostModel& PartitionPlanner::getCostModel() {
+	return model_;
+}
+
+}; // namespace end
@@ -0,0 +1,95 @@
+/*! \file partition_planner.h
+    \brief Predicts the iteration time of partitioning schemes.
+*/
+
+#ifndef MEKONG_PARTITION_PLANNER_H
+#define MEKONG_PARTITION_PLANNER_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "partition.h"
+#include "partitioning.h"
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Picks the partitioning scheme of a kernel launch at runtime.
+
+    The analysis database names one partitioning per kernel, which does not
+    fit every launch shape, e.g. a split along y of a grid with one block row.
+    The planner predicts the time of one iteration for every candidate
+    scheme: the largest partition at the compute rate of a device, one
+    launch latency per partition and the exchange of the data, which a
+    device reads but does not write itself. The exchange is estimated from
+    the access maps of the kernel (\sa KernelLaunch::estimateExchange):
+    every interval costs a copy latency and its bytes go over the link
+    between two devices.
+
+    Choosing a scheme other than the database's requires kernels, which
+    add the partition offset to every axis (bsp_transform -mekong_all_axes).
+
+    The planner also picks the number of devices, because small grids do
+    not scale: every device costs a fixed latency per iteration, which
+    outweighs its share of the work at some point. The compute rate of the
+    model is calibrated with the measured partition times of the planned
+    launches \sa calibrate.
+
+    For pairs of launches, which swap their buffers, the planner also picks
+    the depth of temporal blocking: the halos of several iterations are
+    exchanged at once and computed redundantly \sa predictBlockingTime.
+*/
+class PartitionPlanner {
+	public:
+		//! Estimated costs of the hardware, times in seconds
+		struct CostModel {
+			double launchLatency = 5e-6; ///< fixed costs of one kernel launch
+			double copyLatency = 10e-6;  ///< fixed costs of one submitted copy
+			double linkBW = 10e9;        ///< bandwidth between two devices in Byte/s
+			double threadRate = 1e11;    ///< threads a device finishes per second
+			double deviceLatency = 20e-6; ///< fixed costs of every used device,
+			                              ///< e.g. its synchronization
+		};
+
+		//! Estimated data, which one device has to receive per iteration
+		struct Exchange {
+			size_t bytes = 0;
+			size_t copies = 0;
+		};
+
+		static vector<shared_ptr<const Partitioning>>
+		getCandidates(const Partition::Array3& grid,
+		              shared_ptr<const Partitioning> hint);
+
+		static vector<unsigned short> getDeviceCounts(unsigned short numDev);
+
+		static double predictTime(const vector<shared_ptr<const Partition>>& parts,
+		                          const vector<Exchange>& exchange,
+		                          const CostModel& model);
+		static double
+		predictBlockingTime(const vector<vector<shared_ptr<const Partition>>>& phases,
+		                    const vector<Exchange>& exchange,
+		                    const CostModel& model);
+
+		static double calibrate(const vector<shared_ptr<const Partition>>& parts,
+		                        const vector<double>& times);
+
+		static void setEnabled(bool enable);
+		static bool isEnabled();
+		static void setDeviceCountSelection(bool enable);
+		static bool isDeviceCountSelection();
+		static void setCostModel(const CostModel& model);
+		static const CostModel& getCostModel();
+
+	private:
+		static bool enabled_;
+		static bool deviceCountSelection_;
+		static bool calibrated_;
+		static CostModel model_;
+};
+
+}; // namespace end
+
+#endif
@@ -0,0 +1,143 @@
+#ifdef MEKONG_TEST
+
+/*! \brief Micro benchmark of the host side launch path.
+
+    Counts heap allocations and measures the time of the runtime's metadata
+    handling for repeated kernel launches, which is executed for every
+    wrapLaunchKernel call:
+
+      - capturing the kernel arguments and looking up an equal launch
+      - partitioning a new launch
+      - walking the arguments and partitions of a launch
+
+    No GPU is needed, as no kernel is executed.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_set>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "alias_handle.h"
+#include "argument.h"
+#include "argument_type.h"
+#include "access_function.h"
+#include "kernel_info.h"
+#include "kernel_launch.h"
+#include "partition.h"
+#include "partitioning.h"
+
+using namespace std;
+using namespace Mekong;
+
+// Here we init a set, which saves only different kernel launches.
+unordered_set<shared_ptr<KernelLaunch>, KernelLaunch::hash, KernelLaunch::equal_to>
+KernelLaunch::all(0, KernelLaunch::hash(), KernelLaunch::equal_to());
+
+using Clock = chrono::high_resolution_clock;
+using Duration = chrono::duration<double>;
+
+static size_t numAllocs = 0;
+
+void* operator new(size_t size) {
+	++numAllocs;
+	void* ptr = malloc(size);
+	if (ptr == nullptr) {
+		throw bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+//! Runs `f` `reps` times and prints time and allocations per repetition
+template<class F>
+static void measure(const string& name, size_t reps, F f) {
+	size_t allocs = numAllocs;
+	auto timestamp = Clock::now();
+	for (size_t i = 0; i < reps; ++i) {
+		f(i);
+	}
+	Duration time = Clock::now() - timestamp;
+	cout << "  - " << left << setw(36) << name << right
+	     << setw(10) << time.count() / reps * 1e9 << " ns, "
+	     << setw(6) << (double) (numAllocs - allocs) / reps << " allocations"
+	     << endl;
+}
+
+int main(int argc, char** argv) {
+	size_t reps = argc > 1 ? atoi(argv[1]) : 100000;
+	unsigned numDev = argc > 2 ? atoi(argv[2]) : 4;
+
+	cout << "# Launch Path Benchmark" << endl;
+	cout << endl;
+	cout << "  - repetitions = " << reps << ", devices = " << numDev << endl;
+
+	shared_ptr<AliasHandle> aliasH(new AliasHandle);
+	MEdevice dev = 0;
+	(*aliasH)[dev] = vector<MEdevice>(numDev, dev);
+
+	// kernel(float* a, float* b, int n, float alpha)
+	vector<shared_ptr<const bsp_ArgType>> types = {
+		make_shared<const bsp_ArgType>("float*", 1, 'f', 8, 4, true, true, 1, vector<string>{}),
+		make_shared<const bsp_ArgType>("float*", 1, 'f', 8, 4, false, true, 1, vector<string>{}),
+		make_shared<const bsp_ArgType>("i32", 0, 'i', 4, 0, false, false, 0, vector<string>{}),
+		make_shared<const bsp_ArgType>("float", 0, 'f', 4, 0, false, false, 0, vector<string>{})
+	};
+	vector<shared_ptr<const AccFunc>> accFuncs;
+	for (int i = 0; i < (int) types.size(); ++i) {
+		accFuncs.push_back(make_shared<const AccFunc>(vector<shared_ptr<const string>>{},
+		                   "", vector<shared_ptr<const string>>{}, "", i));
+	}
+	shared_ptr<const Partitioning> parting(new Partitioning("y"));
+	auto info = make_shared<const bsp_KernelInfo>("kernel", types, parting, accFuncs);
+
+	MEfunction func = (MEfunction) 0x1;
+	MEdeviceptr a = 0x1000, b = 0x2000;
+	int n = 1 << 20;
+	float alpha = 2.0f;
+	void* args[] = { &a, &b, &n, &alpha };
+	Partition::Array3 grid = { 64, 512, 1 };
+	Partition::Array3 block = { 32, 8, 1 };
+
+	cout << endl;
+	measure("createArgs", reps, [&] (size_t) {
+		KernelArg::createArgs(types, args);
+	});
+	measure("createPartitions", reps, [&] (size_t) {
+		Partition::createPartitions(grid, block, aliasH, parting);
+	});
+	auto kl = get<0>(KernelLaunch::getOrInsert(func, grid, block, 0, args,
+	                                           info, aliasH));
+	measure("getOrInsert (equal launch exists)", reps, [&] (size_t) {
+		KernelLaunch::getOrInsert(func, grid, block, 0, args, info, aliasH);
+	});
+	measure("getOrInsert (new launch)", reps / 100, [&] (size_t i) {
+		int m = n + 1 + i;
+		void* newArgs[] = { &a, &b, &m, &alpha };
+		KernelLaunch::getOrInsert(func, grid, block, 0, newArgs, info, aliasH);
+	});
+	size_t sum = 0;
+	measure("getReads/getWrites/getGPU", reps, [&] (size_t) {
+		sum += kl->getReads().size() + kl->getWrites().size();
+		sum += kl->getGPU({ 0, 4095, 0 });
+	});
+	int m = n - 1;
+	void* otherArgs[] = { &b, &a, &m, &alpha };
+	auto other = get<0>(KernelLaunch::getOrInsert(func, grid, block, 0, otherArgs,
+	                                              info, aliasH));
+	measure("hasEqualArgAccess", reps, [&] (size_t) {
+		sum += kl->hasEqualArgAccess(*other);
+	});
+	cout << endl;
+	return sum == 0;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifdef MEKONG_TEST
+
+#include <iostream>
+#include <vector>
+
+#include "copy_plan.h"
+
+using namespace std;
+using namespace Mekong;
+
+static bool report(const string& name, bool success) {
+	cout << "  - " << name << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+	return success;
+}
+
+int main() {
+	cout << "# Test of CopyPlan Class" << endl;
+	cout << endl;
+
+	bool success = true;
+
+	// Test Case I: two contiguous copies become one
+	{
+		CopyPlan plan;
+		plan.add(0, 1, 0, 0, 100);
+		plan.add(0, 1, 100, 100, 50);
+		plan.add(0, 1, 200, 150, 10); // gap on the source
+		plan.merge();
+		const auto& ops = plan.getOps();
+		success &= report("Test Case I (merge contiguous)",
+		                  ops.size() == 2 && ops[0].size == 150
+		                  && ops[0].rows == 1 && plan.getBytes() == 160);
+	}
+
+	// Test Case II: equally sized copies with constant distances become
+	// one strided copy, e.g. a halo column of a grid split along x
+	{
+		CopyPlan plan;
+		for (size_t row = 0; row < 4; ++row) {
+			plan.add(1, 0, 8 + row * 64, row * 32, 8);
+		}
+		plan.add(1, 0, 8 + 5 * 64, 5 * 32, 8); // skips one row
+		plan.merge();
+		const auto& ops = plan.getOps();
+		success &= report("Test Case II (merge strided)",
+		                  ops.size() == 2 && ops[0].rows == 4
+		                  && ops[0].srcPitch == 64 && ops[0].dstPitch == 32
+		                  && ops[0].srcOff == 8 && ops[1].rows == 1);
+	}
+
+	// Test Case III: contiguous copies are cut into chunks, strided copies
+	// into groups of rows
+	{
+		CopyPlan plan;
+		plan.add(-1, 0, 0, 0, 1000);
+		plan.add({ 0, 1, 0, 0, 8, 10, 64, 64 });
+		plan.split(300);
+		const auto& ops = plan.getOps();
+		bool ok = ops.size() == 4 + 1 && plan.getBytes() == 1000 + 80;
+		ok = ok && ops[3].srcOff == 900 && ops[3].size == 100;
+		plan.split(24);
+		// 3 x 300 Bytes -> 3 x 13 chunks, 100 Bytes -> 5 chunks and
+		// 10 rows of 8 Bytes -> 4 groups of at most 3 rows
+		ok = ok && plan.getOps().size() == 3 * 13 + 5 + 4 && plan.getBytes() == 1080;
+		success &= report("Test Case III (split)", ok);
+	}
+
+	// Test Case IV: empty copies are dropped and the copies are grouped by
+	// the executing device, which keeps the order of equal device pairs
+	{
+		CopyPlan plan;
+		plan.add(0, 1, 0, 0, 10);
+		plan.add(1, 0, 0, 0, 10);
+		plan.add(0, 1, 10, 10, 0);
+		plan.add(0, 1, 20, 20, 10);
+		plan.add(2, -1, 0, 0, 10);
+		plan.dropEmpty().groupByDevice();
+		const auto& ops = plan.getOps();
+		bool ok = ops.size() == 4;
+		ok = ok && ops[0].getDevice() == 0 && ops[1].getDevice() == 1
+		        && ops[2].getDevice() == 1 && ops[3].getDevice() == 2;
+		ok = ok && ops[1].srcOff == 0 && ops[2].srcOff == 20;
+		plan.merge(); // the two copies 0 -> 1 become one strided copy
+		ok = ok && plan.getOps().size() == 3 && plan.getOps()[1].rows == 2
+		        && plan.getOps()[1].srcPitch == 20;
+		success &= report("Test Case IV (dropEmpty, groupByDevice)", ok);
+	}
+
+	return success ? 0 : 1;
+}
+
+#endif
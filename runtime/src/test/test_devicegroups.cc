@@ -0,0 +1,67 @@
+#ifdef MEKONG_TEST
+
+#include <iostream>
+#include <vector>
+
+#include "device_groups.h"
+
+using namespace std;
+using namespace Mekong;
+
+static bool report(const string& name, bool success) {
+	cout << "  - " << name << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+	return success;
+}
+
+int main() {
+	cout << "# Test of DeviceGroups Class" << endl;
+	cout << endl;
+
+	bool success = true;
+	const MEdeviceptr a = 0x1000, b = 0x2000, c = 0x3000, coef = 0x4000;
+
+	// Test Case I: a stencil, which swaps its buffers, is one group on all
+	// devices
+	{
+		DeviceGroups groups(4);
+		bool ok = groups.addLaunch(0, { a }, { b }, 100).empty();
+		ok = ok && groups.addLaunch(1, { b }, { a }, 100).empty();
+		ok = ok && groups.getNumGroups() == 1;
+		ok = ok && groups.getRange(1).first == 0 && groups.getRange(1).count == 4;
+		success &= report("Test Case I (one group)", ok);
+	}
+
+	// Test Case II: independent launches split the devices by their costs,
+	// a buffer, which both only read, does not connect them
+	{
+		DeviceGroups groups(4);
+		groups.addLaunch(0, { a, coef }, { a }, 300);
+		auto changed = groups.addLaunch(1, { b, coef }, { b }, 100);
+		bool ok = changed.size() == 2 && groups.getNumGroups() == 2;
+		ok = ok && groups.getRange(0).first == 0 && groups.getRange(0).count == 3;
+		ok = ok && groups.getRange(1).first == 3 && groups.getRange(1).count == 1;
+		success &= report("Test Case II (disjoint groups)", ok);
+	}
+
+	// Test Case III: a launch, which reads the results of both groups,
+	// merges them
+	{
+		DeviceGroups groups(4);
+		groups.addLaunch(0, {}, { a }, 100);
+		groups.addLaunch(1, {}, { b }, 100);
+		auto changed = groups.addLaunch(2, { a, b }, { c }, 100);
+		bool ok = groups.getNumGroups() == 1 && changed.size() == 2;
+		ok = ok && groups.getRange(0).count == 4 && groups.getRange(2).count == 4;
+		success &= report("Test Case III (merge)", ok);
+	}
+
+	return success ? 0 : 1;
+}
+
+#endif
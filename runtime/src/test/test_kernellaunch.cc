@@ -212,6 +212,154 @@ bool test1() {
 	return true;
 }
 
+// Every GPU of the arg access in [first, first + count), with intervals
+static bool onDevices(const ArgAccess& acc, int first, int count) {
+	for (const auto& gpu : acc.getMap()) {
+		if (!gpu.second.empty() &&
+		    (gpu.first < first || gpu.first >= first + count)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool test2() {
+	shared_ptr<AliasHandle> aliasH(new AliasHandle);
+
+	// INIT ALIAS HANDLE GLOBAL VAR
+	MEdevice dev;
+	vector<MEdevice> vdev(4, dev); // set 4 gpus
+	(*aliasH)[dev] = vdev;
+
+	// READ DATABASE
+	shared_ptr<const bsp_KernelInfo> kinfo = bsp_KernelInfo::createKInfos(bspAnalysisStr_TEST)[0];
+
+	// SET UP KERNEL ARGUMENTS
+	// the same kernel on the buffers of two independent groups
+	MEdeviceptr input0 = (MEdeviceptr) 10;
+	MEdeviceptr output0 = (MEdeviceptr) 11;
+	MEdeviceptr input1 = (MEdeviceptr) 12;
+	MEdeviceptr output1 = (MEdeviceptr) 13;
+	MEfunction kernel = (MEfunction) 3;
+	int N = 16;
+	void* rawArgs0[] = {&input0, &output0, &N};
+	void* rawArgs1[] = {&input1, &output1, &N};
+
+	using T3 = Partition::Array3;
+	T3 gridSize  = { 4, 4, 1 };
+	T3 blockSize = { 4, 4, 1 };
+
+	auto kl0 = KernelLaunch::getOrInsert(kernel, gridSize, blockSize, 0,
+	                                     rawArgs0, kinfo, aliasH).first;
+	auto kl1 = KernelLaunch::getOrInsert(kernel, gridSize, blockSize, 0,
+	                                     rawArgs1, kinfo, aliasH).first;
+	kl0->setDeviceRange(0, 2);
+	kl1->setDeviceRange(2, 2);
+
+	auto wac0 = kl0->getWriteArgAccess(1);
+	auto wac1 = kl1->getWriteArgAccess(1);
+	auto rac1 = kl1->getReadArgAccess(0);
+
+	cout << "  - equal launches on different device groups " << flush;
+	if (wac0 != wac1 && onDevices(*wac0, 0, 2) && onDevices(*wac1, 2, 2) &&
+	    onDevices(*rac1, 2, 2) && kl1->getFirstDev() == 2) {
+		cout << "[OK]" << endl;
+	}
+	else {
+		cout << "[FALSE] the second group uses the arg accesses or the "
+		     << "devices of the first group" << endl;
+	}
+	cout << endl;
+	return true;
+}
+
+// True if a piece of `range` lies in one of the sorted `intervals`
+static bool overlaps(const tuple<size_t, size_t>& range,
+                     const vector<tuple<size_t, size_t>>& intervals) {
+	auto rest = ArgAccess::subtractIntervals(range, intervals);
+	return rest.size() != 1 || rest[0] != range;
+}
+
+bool test3() {
+	shared_ptr<AliasHandle> aliasH(new AliasHandle);
+
+	// INIT ALIAS HANDLE GLOBAL VAR
+	MEdevice dev;
+	vector<MEdevice> vdev(2, dev); // set 2 gpus
+	(*aliasH)[dev] = vdev;
+
+	// READ DATABASE
+	shared_ptr<const bsp_KernelInfo> kinfo = bsp_KernelInfo::createKInfos(bspAnalysisStr_TEST)[0];
+
+	// SET UP KERNEL ARGUMENTS
+	// a stencil, which swaps its buffers
+	MEdeviceptr bufA = (MEdeviceptr) 20;
+	MEdeviceptr bufB = (MEdeviceptr) 21;
+	MEfunction kernel = (MEfunction) 4;
+	int N = 16;
+	void* rawArgsA[] = {&bufA, &bufB, &N};
+	void* rawArgsB[] = {&bufB, &bufA, &N};
+
+	using T3 = Partition::Array3;
+	T3 gridSize  = { 4, 4, 1 };
+	T3 blockSize = { 4, 4, 1 };
+
+	// expensive copies let the planner pick the deepest cycle
+	PartitionPlanner::CostModel model;
+	model.copyLatency = 1;
+	PartitionPlanner::setCostModel(model);
+	KernelLaunch::setTemporalBlocking(2);
+
+	auto klA = KernelLaunch::getOrInsert(kernel, gridSize, blockSize, 0,
+	                                     rawArgsA, kinfo, aliasH).first;
+	auto klB = KernelLaunch::getOrInsert(kernel, gridSize, blockSize, 0,
+	                                     rawArgsB, kinfo, aliasH).first;
+	// the base launch already calculated its arg accesses
+	klA->precomputeWrittenData();
+	auto phaseA = klA->getBlockingPhase();
+	auto phaseB = klB->getBlockingPhase();
+
+	cout << "  - phases of temporal blocking " << flush;
+	if (phaseA == klA || klA->getBlockingDepth() != 2) {
+		cout << "[FALSE] the launches are not blocked" << endl;
+	}
+	else if (phaseA->getWriteArgAccess(1) == klA->getWriteArgAccess(1)) {
+		cout << "[FALSE] the phase uses the arg access of the base launch" << endl;
+	}
+	else {
+		// the second phase reads on every GPU only what the first phase
+		// wrote on that GPU, elements of no phase are not exchanged
+		auto written = phaseA->getWriteArgAccess(1)->getMap();
+		for (auto& gpu : written) {
+			sort(gpu.second.begin(), gpu.second.end());
+		}
+		bool local = true;
+		for (const auto& gpu : phaseB->getReadArgAccess(0)->getMap()) {
+			for (const auto& interval : gpu.second) {
+				auto& own = written[gpu.first];
+				for (const auto& piece : ArgAccess::subtractIntervals(interval, own)) {
+					for (const auto& other : written) {
+						if (other.first != gpu.first && overlaps(piece, other.second)) {
+							local = false;
+						}
+					}
+				}
+			}
+		}
+		if (local) {
+			cout << "[OK]" << endl;
+		}
+		else {
+			cout << "[FALSE] the phases exchange halos" << endl;
+		}
+	}
+
+	KernelLaunch::setTemporalBlocking(1);
+	PartitionPlanner::setCostModel(PartitionPlanner::CostModel());
+	cout << endl;
+	return true;
+}
+
 int main() {
 
 	cout << endl;
@@ -220,6 +368,8 @@ int main() {
 
 	test0();
 	test1();
+	test2();
+	test3();
 	return 0;
 }
 
@@ -0,0 +1,73 @@
+#ifdef MEKONG_TEST
+
+#include <iostream>
+#include <vector>
+
+#include "load_balancer.h"
+
+using namespace std;
+using namespace Mekong;
+
+static bool report(const string& name, bool success) {
+	cout << "  - " << name << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+	return success;
+}
+
+int main() {
+	cout << "# Test of LoadBalancer Class" << endl;
+	cout << endl;
+
+	bool success = true;
+
+	// Test Case I: balanced partitions never trigger a re-partitioning
+	{
+		LoadBalancer balancer(0.1, 2);
+		bool rebalance = false;
+		for (int i = 0; i < 10; ++i) {
+			rebalance |= balancer.addMeasurement({ 1.0, 1.05 }, { 50, 50 });
+		}
+		success &= report("Test Case I (balanced)",
+		                  !rebalance && balancer.getWeights().empty());
+	}
+
+	// Test Case II: the second device is twice as slow. The first
+	// measurement is skipped, then it takes `patience` measurements.
+	{
+		LoadBalancer balancer(0.1, 2);
+		bool ok = !balancer.addMeasurement({ 1.0, 2.0 }, { 50, 50 });
+		ok = ok && !balancer.addMeasurement({ 1.0, 2.0 }, { 50, 50 });
+		ok = ok && balancer.addMeasurement({ 1.0, 2.0 }, { 50, 50 });
+		const auto& w = balancer.getWeights();
+		ok = ok && w.size() == 2 && w[0] > 1.9 * w[1] && w[0] < 2.1 * w[1];
+		success &= report("Test Case II (slow device)", ok);
+	}
+
+	// Test Case III: hysteresis, after a re-partitioning the balancer waits
+	// for fresh measurements
+	{
+		LoadBalancer balancer(0.1, 1);
+		balancer.addMeasurement({ 1.0, 2.0 }, { 50, 50 }); // warmup
+		bool ok = balancer.addMeasurement({ 1.0, 2.0 }, { 50, 50 });
+		ok = ok && !balancer.addMeasurement({ 1.0, 2.0 }, { 67, 33 });
+		ok = ok && balancer.getRebalances() == 1;
+		success &= report("Test Case III (hysteresis)", ok);
+	}
+
+	// Test Case IV: an imbalance, which one block can not fix, is ignored
+	{
+		LoadBalancer balancer(0.1, 1);
+		balancer.addMeasurement({ 1.0, 1.3 }, { 2, 2 }); // warmup
+		bool ok = !balancer.addMeasurement({ 1.0, 1.3 }, { 2, 2 });
+		success &= report("Test Case IV (block granularity)", ok);
+	}
+
+	return success ? 0 : 1;
+}
+
+#endif
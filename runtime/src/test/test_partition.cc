@@ -115,8 +115,11 @@ int main() {
 	size_t sum = 0;
 	set<T3> trueOff; // true offsets
 	trueOff.insert({ 0, 0, 0 });
-	trueOff.insert({ 14, 28, 0 });
-	trueOff.insert({ 28, 56, 0});
+	trueOff.insert({ 0, 14, 0 });
+	trueOff.insert({ 0, 28, 0 });
+	trueOff.insert({ 7, 0, 0 });
+	trueOff.insert({ 7, 14, 0 });
+	trueOff.insert({ 7, 28, 0 });
 
 	for (auto p : partitions) {
 		success = success && (get<0>(p->getSize()) == tiling)
@@ -135,6 +138,190 @@ int main() {
 	else {
 		cout << " [FAILED]" << endl;
 	}
+
+	// Test Case VII (1D, 10 rows on 3 devices with weights 2:1:1):
+	success = true;
+	(*aliasH)[dev] = vector<MEdevice>(3, dev);
+	grid = { 1, 10, 1 };
+	parting.reset(new Partitioning("y"));
+	partitions = Partition::createPartitions(grid, block, aliasH, parting,
+	                                         { 2.0, 1.0, 1.0 });
+	vector<unsigned> rows;
+	for (auto p : partitions) {
+		rows.push_back(p->getGrid()[1]);
+	}
+	success = success && rows == vector<unsigned>({ 5, 3, 2 });
+	success = success && partitions[1]->getOffset()[1] == 5 * tiling
+	                  && partitions[2]->getOffset()[1] == 8 * tiling;
+	// equal weights give the rest to the first devices, like no weights
+	success = success && Partition::splitWeighted(10, 3, {})
+	                     == vector<unsigned>({ 4, 3, 3 });
+	success = success && Partition::splitWeighted(10, 3, { 1.0, 1.0, 1.0 })
+	                     == vector<unsigned>({ 4, 3, 3 });
+	// every device gets at least one row
+	success = success && Partition::splitWeighted(3, 3, { 100.0, 1.0, 1.0 })
+	                     == vector<unsigned>({ 1, 1, 1 });
+	cout << "  - Test Case VII (weighted 1D)" << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+
+	// Test Case VIII (2D, 4x8 grid on 2x2 devices, the second column of
+	// devices is three times as fast):
+	success = true;
+	(*aliasH)[dev] = vector<MEdevice>(4, dev);
+	grid = { 4, 8, 1 };
+	parting.reset(new Partitioning("xy"));
+	partitions = Partition::createPartitions(grid, block, aliasH, parting,
+	                                         { 1.0, 3.0, 1.0, 3.0 });
+	size_t blocks = 0;
+	for (auto p : partitions) {
+		blocks += p->getGrid()[0] * p->getGrid()[1];
+	}
+	success = success && blocks == 32;
+	success = success && partitions[0]->getGrid() == T3({ 2, 2, 1 })
+	                  && partitions[1]->getGrid() == T3({ 2, 6, 1 })
+	                  && partitions[3]->getOffset() == T3({ 2 * tiling, 2 * tiling, 0 });
+	cout << "  - Test Case VIII (weighted 2D)" << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+
+	// Test Case IX (3D, 8x8x8 grid on 8 devices and 16x4x4 grid on 4 devices;
+	// the decomposition with the smallest cut surface wins):
+	success = true;
+	(*aliasH)[dev] = vector<MEdevice>(8, dev);
+	block = { tiling, tiling, tiling };
+	grid = { 8, 8, 8 };
+	parting.reset(new Partitioning("xyz"));
+	partitions = Partition::createPartitions(grid, block, aliasH, parting);
+	success = success && partitions.size() == 8;
+	for (auto p : partitions) {
+		success = success && p->getGrid() == T3({ 4, 4, 4 });
+	}
+	success = success && partitions[1]->getOffset() == T3({ 0, 0, 4 * tiling })
+	                  && partitions[2]->getOffset() == T3({ 0, 4 * tiling, 0 })
+	                  && partitions[7]->getOffset() == T3({ 4 * tiling, 4 * tiling, 4 * tiling });
+	(*aliasH)[dev] = vector<MEdevice>(4, dev);
+	grid = { 16, 4, 4 };
+	partitions = Partition::createPartitions(grid, block, aliasH, parting);
+	for (auto p : partitions) {
+		success = success && p->getGrid() == T3({ 4, 4, 4 });
+	}
+	success = success && partitions[3]->getOffset() == T3({ 12 * tiling, 0, 0 });
+	cout << "  - Test Case IX (3D)" << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+
+	// Test Case X (ragged 2D, 4x6 grid on 5 devices as rows of 3 and 2
+	// devices, 8x8 grid on 2 and on 7 devices):
+	success = true;
+	block = { tiling, tiling, 1 };
+	parting.reset(new Partitioning("xy"));
+	(*aliasH)[dev] = vector<MEdevice>(5, dev);
+	grid = { 4, 6, 1 };
+	partitions = Partition::createPartitions(grid, block, aliasH, parting);
+	success = success && partitions.size() == 5
+	                  && partitions[0]->getGrid() == T3({ 2, 2, 1 })
+	                  && partitions[3]->getGrid() == T3({ 2, 3, 1 })
+	                  && partitions[4]->getOffset() == T3({ 2 * tiling, 3 * tiling, 0 });
+	for (unsigned numDev : { 2, 7 }) {
+		(*aliasH)[dev] = vector<MEdevice>(numDev, dev);
+		grid = { 8, 8, 1 };
+		partitions = Partition::createPartitions(grid, block, aliasH, parting);
+		size_t blocks = 0;
+		for (auto p : partitions) {
+			blocks += p->getGrid()[0] * p->getGrid()[1];
+		}
+		success = success && partitions.size() == numDev && blocks == 64;
+	}
+	cout << "  - Test Case X (ragged 2D)" << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+
+	// Test Case XI (block-cyclic, 10 blocks along x in tiles of 2 blocks
+	// on 2 devices):
+	success = true;
+	Partition::setCycleLength(2);
+	(*aliasH)[dev] = vector<MEdevice>(2, dev);
+	grid = { 10, 1, 1 };
+	parting.reset(new Partitioning("x"));
+	partitions = Partition::createPartitions(grid, block, aliasH, parting);
+	success = success && partitions.size() == 5
+	                  && partitions[0]->getDevice() == 0
+	                  && partitions[0]->getOffset() == T3({ 0, 0, 0 })
+	                  && partitions[1]->getOffset() == T3({ 4 * tiling, 0, 0 })
+	                  && partitions[3]->getDevice() == 1
+	                  && partitions[3]->getOffset() == T3({ 2 * tiling, 0, 0 })
+	                  && partitions[4]->getOffset() == T3({ 6 * tiling, 0, 0 });
+	Partition::setCycleLength(0);
+	cout << "  - Test Case XI (block-cyclic)" << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+
+	// Test Case XII (over-decomposition, 10 blocks along x with 2 partitions
+	// on each of 2 devices; the partitions of a device coalesce into one box
+	// and only the middle partitions touch the other device):
+	success = true;
+	Partition::setOverDecomposition(2);
+	partitions = Partition::createPartitions(grid, block, aliasH, parting);
+	Partition::setOverDecomposition(1);
+	success = success && partitions.size() == 4
+	                  && partitions[1]->getDevice() == 0
+	                  && partitions[2]->getDevice() == 1
+	                  && partitions[2]->getOffset() == T3({ 5 * tiling, 0, 0 });
+	if (success) {
+		auto boxes = Partition::coalesce(partitions);
+		success = boxes.size() == 2 && boxes[0]->getGrid()[0] == 5
+		          && boxes[1]->getOffset() == T3({ 5 * tiling, 0, 0 })
+		          && partitions[1]->touches(*partitions[2])
+		          && !partitions[0]->touches(*partitions[2]);
+	}
+	cout << "  - Test Case XII (over-decomposition)" << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+
+	// Test Case XIII (temporal blocking, the partitions of Test Case XII
+	// widened by 2 blocks along x; they are clamped to the grid and keep
+	// their extent along y and z):
+	success = true;
+	partitions = Partition::extend(Partition::createPartitions(grid, block, aliasH, parting),
+	                               grid, 2);
+	success = success && partitions.size() == 2
+	                  && partitions[0]->getOffset() == T3({ 0, 0, 0 })
+	                  && partitions[0]->getGrid() == T3({ 7, 1, 1 })
+	                  && partitions[1]->getDevice() == 1
+	                  && partitions[1]->getOffset() == T3({ 3 * tiling, 0, 0 })
+	                  && partitions[1]->getGrid() == T3({ 7, 1, 1 });
+	cout << "  - Test Case XIII (temporal blocking)" << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
 	return 0;
 }
 
@@ -0,0 +1,126 @@
+#ifdef MEKONG_TEST
+
+#include <iostream>
+#include <vector>
+#include <memory>
+
+#include "partition_planner.h"
+#include "partitioning.h"
+#include "partition.h"
+#include "alias_handle.h"
+
+using namespace std;
+using namespace Mekong;
+
+static bool report(const string& name, bool success) {
+	cout << "  - " << name << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+	return success;
+}
+
+int main() {
+	cout << "# Test of PartitionPlanner Class" << endl;
+	cout << endl;
+
+	bool success = true;
+	using T3 = Partition::Array3;
+	shared_ptr<AliasHandle> aliasH(new AliasHandle);
+	MEdevice dev;
+	(*aliasH)[dev] = vector<MEdevice>(4, dev);
+
+	// Test Case I: the hint comes first, dimensions with one block are not
+	// split
+	{
+		shared_ptr<const Partitioning> hint(new Partitioning("y"));
+		auto candidates = PartitionPlanner::getCandidates({ 16, 16, 1 }, hint);
+		bool ok = candidates.size() == 3 && candidates[0] == hint;
+		for (const auto& c : candidates) {
+			ok = ok && !c->isSplitAt('z');
+		}
+		success &= report("Test Case I (candidates)", ok);
+	}
+
+	// Test Case II: many small copies make a scheme slower than few large
+	// ones with the same bytes
+	{
+		shared_ptr<const Partitioning> parting(new Partitioning("y"));
+		auto parts = Partition::createPartitions({ 16, 16, 1 }, { 32, 8, 1 },
+		                                         aliasH, parting);
+		PartitionPlanner::CostModel model;
+		vector<PartitionPlanner::Exchange> rows(4), cols(4);
+		for (int gpu = 0; gpu < 4; ++gpu) {
+			rows[gpu].bytes = cols[gpu].bytes = 2 * 512 * 4;
+			rows[gpu].copies = 2;
+			cols[gpu].copies = 2 * 512;
+		}
+		success &= report("Test Case II (copy latency)",
+		                  PartitionPlanner::predictTime(parts, rows, model) <
+		                  PartitionPlanner::predictTime(parts, cols, model));
+	}
+
+	// Test Case III: without an exchange the largest partition decides
+	{
+		PartitionPlanner::CostModel model;
+		model.launchLatency = 0;
+		model.deviceLatency = 0;
+		shared_ptr<const Partitioning> parting(new Partitioning("x"));
+		auto parts = Partition::createPartitions({ 10, 1, 1 }, { 100, 1, 1 },
+		                                         aliasH, parting);
+		double time = PartitionPlanner::predictTime(parts, vector<PartitionPlanner::Exchange>(4), model);
+		success &= report("Test Case III (compute)",
+		                  time == 300 / model.threadRate);
+	}
+
+	// Test Case IV: a tiny grid runs faster on fewer devices, a large one
+	// on all of them
+	{
+		PartitionPlanner::CostModel model;
+		shared_ptr<const Partitioning> parting(new Partitioning("x"));
+		auto counts = PartitionPlanner::getDeviceCounts(4);
+		bool ok = counts == vector<unsigned short>({ 4, 2, 1 });
+		vector<double> times;
+		for (T3 grid : { T3({ 4, 1, 1 }), T3({ 1 << 20, 1, 1 }) }) {
+			for (unsigned short numDev : { 4, 1 }) {
+				auto parts = Partition::createPartitions(grid, { 256, 1, 1 },
+				                                         numDev, parting, {});
+				times.push_back(PartitionPlanner::predictTime(parts,
+				                vector<PartitionPlanner::Exchange>(numDev), model));
+			}
+		}
+		ok = ok && times[1] < times[0] && times[2] < times[3];
+		success &= report("Test Case IV (device count)", ok);
+	}
+
+	// Test Case V: a cycle of phases synchronizes once, but computes extra
+	// blocks, thus it pays off only if the synchronization is expensive
+	{
+		PartitionPlanner::CostModel model;
+		model.launchLatency = 0;
+		shared_ptr<const Partitioning> parting(new Partitioning("x"));
+		T3 grid = { 64, 1, 1 };
+		auto parts = Partition::createPartitions(grid, { 256, 1, 1 }, 4, parting, {});
+		// the first phase computes 3 extra blocks on both sides
+		vector<vector<shared_ptr<const Partition>>> phases;
+		for (unsigned halo : { 3, 2, 1, 0 }) {
+			phases.push_back(Partition::extend(parts, grid, halo));
+		}
+		vector<PartitionPlanner::Exchange> exchange(4);
+		vector<double> times;
+		for (double latency : { 1e-3, 0.0 }) {
+			model.deviceLatency = latency;
+			times.push_back(PartitionPlanner::predictTime(parts, exchange, model));
+			times.push_back(PartitionPlanner::predictBlockingTime(phases, exchange, model));
+		}
+		success &= report("Test Case V (blocking depth)",
+		                  times[1] < times[0] && times[3] > times[2]);
+	}
+
+	return success ? 0 : 1;
+}
+
+#endif
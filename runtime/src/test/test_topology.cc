@@ -0,0 +1,71 @@
+#ifdef MEKONG_TEST
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "topology.h"
+
+using namespace std;
+using namespace Mekong;
+
+static bool report(const string& name, bool success) {
+	cout << "  - " << name << flush;
+	if (success) {
+		cout << " [OK]" << endl;
+	}
+	else {
+		cout << " [FAILED]" << endl;
+	}
+	return success;
+}
+
+int main() {
+	cout << "# Test of Topology Class" << endl;
+	cout << endl;
+
+	bool success = true;
+
+	// Test Case I: without a probe the devices are sorted by their bus ids
+	{
+		Topology topo({ "0000:81:00.0", "0000:02:00.0", "0000:82:00.0", "0000:01:00.0" });
+		auto order = topo.place(Topology::chainTraffic(4));
+		success &= report("Test Case I (bus order)",
+		                  order == vector<unsigned short>({ 3, 1, 0, 2 }));
+	}
+
+	// Test Case II: two sockets, the devices 0 and 2 and the devices 1 and 3
+	// have fast links. The chain crosses the slow link only once.
+	{
+		Topology topo({ "0000:01:00.0", "0000:02:00.0", "0000:03:00.0", "0000:04:00.0" });
+		for (unsigned short a = 0; a < 4; ++a) {
+			for (unsigned short b = 0; b < 4; ++b) {
+				if (a != b) {
+					topo.setBandwidth(a, b, a % 2 == b % 2 ? 20e9 : 5e9);
+				}
+			}
+		}
+		auto order = topo.place(Topology::chainTraffic(4));
+		unsigned slowLinks = 0;
+		for (size_t i = 0; i + 1 < order.size(); ++i) {
+			slowLinks += order[i] % 2 != order[i + 1] % 2 ? 1 : 0;
+		}
+		success &= report("Test Case II (sockets)", order.size() == 4 && slowLinks == 1);
+	}
+
+	// Test Case III: equal links keep the bus order
+	{
+		Topology topo({ "0000:02:00.0", "0000:01:00.0", "0000:03:00.0" });
+		for (unsigned short a = 0; a < 3; ++a) {
+			for (unsigned short b = 0; b < 3; ++b) {
+				topo.setBandwidth(a, b, 10e9);
+			}
+		}
+		success &= report("Test Case III (equal links)",
+		                  topo.place(Topology::chainTraffic(3)) == topo.getBusOrder());
+	}
+
+	return success ? 0 : 1;
+}
+
+#endif
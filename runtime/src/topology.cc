@@ -0,0 +1,148 @@
+#include "topology.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm> // std::stable_sort, std::swap
+#include <numeric> // std::iota
+
+namespace Mekong {
+
+using namespace std;
+
+//! \param busIds PCI bus id of every registered device \sa meDeviceGetPCIBusId
+Topology::Topology(const vector<string>& busIds)
+		: busIds_(busIds),
+		  bw_(busIds.size(), vector<double>(busIds.size(), 0)) {}
+
+//! Sets the measured bandwidth in Byte/s of the link from `src` to `dst`
+void Topology::setBandwidth(unsigned short src, unsigned short dst, double bw) {
+	if (src >= bw_.size() || dst >= bw_.size()) {
+		throw out_of_range("SPACE Mekong, CLASS Topology, FUNC setBandwidth(): "
+		                   "unknown device");
+	}
+	bw_[src][dst] = bw;
+	probed_ = true;
+}
+
+double Topology::getBandwidth(unsigned short src, unsigned short dst) const {
+	return bw_.at(src).at(dst);
+}
+
+//! True if at least one bandwidth was set
+bool Topology::isProbed() const {
+	return probed_;
+}
+
+unsigned short Topology::getNumDev() const {
+	return busIds_.size();
+}
+
+const string& Topology::getBusId(unsigned short dev) const {
+	return busIds_.at(dev);
+}
+
+//! The devices sorted by their PCI bus ids
+vector<unsigned short> Topology::getBusOrder() const {
+	vector<unsigned short> res(busIds_.size());
+	iota(res.begin(), res.end(), 0);
+	stable_sort(res.begin(), res.end(), [this] (unsigned short a, unsigned short b) {
+		return busIds_[a] < busIds_[b];
+	});
+	return res;
+}
+
+/*! \brief Predicts the seconds of one exchange, if device index i runs on
+           device order[i].
+
+    Every pair of indices sends its traffic over its own link, the links of
+    both directions are averaged. An unprobed link counts as very slow.
+    \param traffic bytes between every pair of device indices
+*/
+double Topology::predictTime(const vector<unsigned short>& order,
+                             const vector<vector<double>>& traffic) const {
+	double res = 0;
+	for (size_t i = 0; i < order.size(); ++i) {
+		for (size_t j = 0; j < order.size(); ++j) {
+			if (i == j || traffic[i][j] <= 0) {
+				continue;
+			}
+			double bw = 0.5 * (bw_[order[i]][order[j]] + bw_[order[j]][order[i]]);
+			res += traffic[i][j] / (bw > 0 ? bw : 1);
+		}
+	}
+	return res;
+}
+
+/*! \brief Returns the device for every device index, which sends the
+           traffic over the fastest links.
+
+    Starts with the bus order and swaps two devices as long as a swap
+    lowers the predicted time. The local search is cheap for the 16 devices
+    of a node and keeps the bus order, if all links are equal.
+    \param traffic bytes between every pair of device indices, e.g. chainTraffic()
+    \return order[i] is the device of device index i
+*/
+vector<unsigned short> Topology::place(const vector<vector<double>>& traffic) const {
+	if (traffic.size() != busIds_.size()) {
+		throw invalid_argument("SPACE Mekong, CLASS Topology, FUNC place(): "
+		                       "need the traffic of every device");
+	}
+	vector<unsigned short> order = getBusOrder();
+	if (!probed_) {
+		return order;
+	}
+	double time = predictTime(order, traffic);
+	bool improved = true;
+	while (improved) {
+		improved = false;
+		size_t bestI = 0, bestJ = 0;
+		double bestTime = time;
+		for (size_t i = 0; i < order.size(); ++i) {
+			for (size_t j = i + 1; j < order.size(); ++j) {
+				swap(order[i], order[j]);
+				double t = predictTime(order, traffic);
+				swap(order[i], order[j]);
+				// only clear improvements, the sums differ by rounding
+				if (t < bestTime * (1 - 1e-9)) {
+					bestTime = t;
+					bestI = i;
+					bestJ = j;
+				}
+			}
+		}
+		if (bestTime < time) {
+			swap(order[bestI], order[bestJ]);
+			time = bestTime;
+			improved = true;
+		}
+	}
+	return order;
+}
+
+/*! \brief Traffic of neighbouring device indices, one unit between i and
+           i + 1 in both directions.
+
+    The 1D schemes and the fastest varying dimension of the block schemes
+    exchange their halos between neighbouring indices \sa Partition.
+*/
+vector<vector<double>> Topology::chainTraffic(unsigned short numDev) {
+	vector<vector<double>> res(numDev, vector<double>(numDev, 0));
+	for (unsigned short i = 0; i + 1 < numDev; ++i) {
+		res[i][i + 1] = 1;
+		res[i + 1][i] = 1;
+	}
+	return res;
+}
+
+ostream& operator<<(ostream& out, const Topology& topo) {
+	out << "Topology(";
+	for (unsigned short dev = 0; dev < topo.getNumDev(); ++dev) {
+		out << (dev > 0 ? " " : "") << topo.getBusId(dev);
+	}
+	out << (topo.isProbed() ? ", probed)" : ")");
+	return out;
+}
+
+}; // namespace end
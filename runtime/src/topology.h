@@ -0,0 +1,59 @@
+/*! \file topology.h
+    \brief Places the partitions of neighbouring devices on fast links.
+*/
+
+#ifndef MEKONG_TOPOLOGY_H
+#define MEKONG_TOPOLOGY_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Interconnect of the registered devices and the device order,
+           which fits it best.
+
+    Partition i runs on device i of the alias handle, thus neighbouring
+    partitions exchange their halos between neighbouring device indices.
+    On nodes with several CPU sockets or PCIe switches the links between
+    two devices differ a lot. The topology knows the PCI bus id of every
+    device and, if probed, the bandwidth of every link. place() returns the
+    permutation of the devices, which minimizes the predicted transfer time
+    of a traffic graph between the device indices. The runtime applies the
+    permutation once to the device and context order of the alias handle,
+    thus it holds for every launch.
+
+    Without bandwidths the devices are sorted by their bus id, which keeps
+    devices behind the same switch together.
+*/
+class Topology {
+	public:
+		Topology(const vector<string>& busIds);
+
+		void setBandwidth(unsigned short src, unsigned short dst, double bw);
+		double getBandwidth(unsigned short src, unsigned short dst) const;
+		bool isProbed() const;
+		unsigned short getNumDev() const;
+		const string& getBusId(unsigned short dev) const;
+
+		vector<unsigned short> getBusOrder() const;
+		vector<unsigned short> place(const vector<vector<double>>& traffic) const;
+		double predictTime(const vector<unsigned short>& order,
+		                   const vector<vector<double>>& traffic) const;
+
+		static vector<vector<double>> chainTraffic(unsigned short numDev);
+
+	private:
+		vector<string> busIds_;
+		vector<vector<double>> bw_; ///< Byte/s from device [src] to [dst], 0 if unknown
+		bool probed_ = false;
+};
+
+ostream& operator<<(ostream& out, const Topology& topo);
+
+}; // namespace end
+
+#endif
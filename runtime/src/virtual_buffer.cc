@@ -1,5 +1,6 @@
 #include "mekong-cuda.h"
 #include "virtual_buffer.h"
+#include "kernel_launch.h"
 
 #include <unordered_set>
 #include <map>
@@ -17,8 +18,20 @@ bool Buffer::isWritten(MEdeviceptr ptr) const {
 	return ptr2launch_.find(ptr) != ptr2launch_.end();
 }
 
+/*! \brief Marks `kl` as the last writer of the buffer.
+
+    A launch, whose write accesses differ from the ones of the last writer,
+    may leave elements untouched, which the last writer changed on some
+    device. Then the first GPU does not hold the current values of the
+    unwritten elements any more, thus the broadcast mark is dropped.
+    \sa KernelLaunch::getWrittenData
+*/
 void Buffer::setWritten(MEdeviceptr ptr, shared_ptr<KernelLaunch> kl) {
-	broadcastPtrs_.erase(ptr);
+	auto it = ptr2launch_.find(ptr);
+	if (it != ptr2launch_.end() && (!kl->hasEqualArgAccess(*it->second) ||
+	                                !kl->hasEqualPartitions(*it->second))) {
+		broadcastPtrs_.erase(ptr);
+	}
 	ptr2launch_[ptr] = kl;
 }
 
@@ -30,8 +43,17 @@ bool Buffer::isBroadcast(MEdeviceptr ptr) const {
 	return broadcastPtrs_.count(ptr) != 0;
 }
 
+bool Buffer::isUntouchedBroadcast(MEdeviceptr ptr) const {
+	return isBroadcast(ptr) && !isWritten(ptr);
+}
+
 void Buffer::erase(MEdeviceptr ptr) {
 	ptr2launch_.erase(ptr);
 }
 
+void Buffer::clear(MEdeviceptr ptr) {
+	ptr2launch_.erase(ptr);
+	broadcastPtrs_.erase(ptr);
+}
+
 }; // namespace end
@@ -20,13 +20,19 @@ class Buffer {
 		void setWritten(MEdeviceptr ptr, shared_ptr<KernelLaunch> kl);
 		void setBroadcast(MEdeviceptr ptr);
 		bool isBroadcast(MEdeviceptr ptr) const;
+		//! true if the buffer holds a broadcast, which no kernel overwrote
+		bool isUntouchedBroadcast(MEdeviceptr ptr) const;
 		void erase(MEdeviceptr ptr);
+		//! forget everything we know about the buffer (e.g. after a free)
+		void clear(MEdeviceptr ptr);
 	private:
 		map<MEdeviceptr, shared_ptr<KernelLaunch>> ptr2launch_;
 
 		// here we save if there was a cuMemcpyHtoD which was casted
-		// to a broadcast on a certain buffer. If there is a kernel
-		// launch, which writes to that buffer we remove the buffer
+		// to a broadcast on a certain buffer. The first kernel writing to
+		// that buffer and the kernels with equal write accesses do not
+		// remove the mark, as the elements they did not write are still
+		// equal on every device. Any other kernel removes it.
 		unordered_set<MEdeviceptr> broadcastPtrs_;
 };
 
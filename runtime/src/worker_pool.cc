@@ -0,0 +1,94 @@
+#include "worker_pool.h"
+
+#include <functional>
+#include <queue>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Mekong {
+
+using namespace std;
+
+WorkerPool::WorkerPool(unsigned numThreads) :
+	numThreads_(numThreads > 0 ? numThreads : 1) {}
+
+//! Finishes all submitted tasks and joins the threads
+WorkerPool::~WorkerPool() {
+	join();
+}
+
+/*! \brief Finishes all submitted tasks and joins the threads.
+
+    A later submit() starts the threads again.
+*/
+void WorkerPool::join() {
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	newTask_.notify_all();
+	for (auto& t : threads_) {
+		t.join();
+	}
+	lock_guard<mutex> lock(mutex_);
+	threads_.clear();
+	stop_ = false;
+}
+
+//! Enqueues `task` and returns immediately
+void WorkerPool::submit(function<void()> task) {
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (threads_.empty()) {
+			for (unsigned i = 0; i < numThreads_; ++i) {
+				threads_.push_back(thread(&WorkerPool::work, this));
+			}
+		}
+		tasks_.push(move(task));
+		++numTasks_;
+	}
+	newTask_.notify_one();
+}
+
+//! Blocks until all submitted tasks are finished
+void WorkerPool::wait() {
+	unique_lock<mutex> lock(mutex_);
+	idle_.wait(lock, [this] { return tasks_.empty() && running_ == 0; });
+}
+
+//! Returns the total number of submitted tasks
+size_t WorkerPool::getNumTasks() const {
+	lock_guard<mutex> lock(mutex_);
+	return numTasks_;
+}
+
+unsigned WorkerPool::getNumThreads() const {
+	return numThreads_;
+}
+
+void WorkerPool::work() {
+	unique_lock<mutex> lock(mutex_);
+	while (true) {
+		newTask_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+		if (tasks_.empty()) { // stop_ is set and nothing is left to do
+			return;
+		}
+		auto task = move(tasks_.front());
+		tasks_.pop();
+		++running_;
+		lock.unlock();
+		try {
+			task();
+		}
+		catch (...) {}
+		lock.lock();
+		--running_;
+		if (tasks_.empty() && running_ == 0) {
+			idle_.notify_all();
+		}
+	}
+}
+
+}; // namespace end
@@ -0,0 +1,58 @@
+/*! \file worker_pool.h
+    \brief Small thread pool to execute work in the background of the host
+           application.
+*/
+
+#ifndef MEKONG_WORKER_POOL_H
+#define MEKONG_WORKER_POOL_H
+
+#include <functional>
+#include <queue>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Mekong {
+
+using namespace std;
+
+/*! \brief Executes submitted tasks on a fixed number of worker threads.
+
+    The tasks are executed in submission order, but tasks may run
+    concurrently if the pool has more than one thread. Tasks must not throw,
+    exceptions leaving a task are dropped. The threads are started with the
+    first submitted task.
+*/
+class WorkerPool {
+	public:
+		WorkerPool(unsigned numThreads = 1);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		void submit(function<void()> task);
+		void wait();
+		void join();
+		size_t getNumTasks() const;
+		unsigned getNumThreads() const;
+
+	private:
+		void work();
+
+		const unsigned numThreads_;
+		vector<thread> threads_;
+		queue<function<void()>> tasks_;
+		unsigned running_ = 0; ///< tasks taken from the queue but not finished
+		bool stop_ = false;
+		size_t numTasks_ = 0;  ///< total number of submitted tasks
+
+		mutable mutex mutex_;
+		condition_variable newTask_;
+		condition_variable idle_;
+};
+
+}; // namespace end
+
+#endif
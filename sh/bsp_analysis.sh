@@ -14,7 +14,9 @@ LIBCLC=${HOME}/src/libclc
 
 DCA=bsp_analysis
 DB="../${DCA}/dbs/kernel_info.ddb"
+BIN_DB="../${DCA}/dbs/kernel_info.mkdb"
 echo "Database output: ${DB}"
+echo "Binary database output: ${BIN_DB}"
 SCRIPTPATH=$PWD
 PROJECTPATH=$PWD/../
 PASSBUILDPATH=../build/
@@ -44,10 +46,10 @@ TESTPATH_CANONIC_LL="${TESTPATH_LL%.*}.canonic.ll"
 if [ "$pollyLoaded" = true ]; then
 	opt -S -load $LWPASSPATH -lwpass $TESTPATH_LL > $TESTPATH_WRAPPED 
 	opt -S -polly-canonicalize $TESTPATH_WRAPPED > ${TESTPATH_CANONIC_LL}
-	opt -load ${PASSPATH} -${STRUCTNAME} -mekong_db ${DB} ${TESTPATH_CANONIC_LL} > /dev/null
+	opt -load ${PASSPATH} -${STRUCTNAME} -mekong_db ${DB} -mekong_bin_db ${BIN_DB} ${TESTPATH_CANONIC_LL} > /dev/null
 else
 	opt -S -load $LWPASSPATH -lwpass $TESTPATH_LL > $TESTPATH_WRAPPED 
 	opt -load ${POLLY_LIB} -S -polly-canonicalize $TESTPATH_WRAPPED > $TESTPATH_CANONIC_LL
-	opt -load ${POLLY_LIB} -load ${PASSPATH} -${STRUCTNAME} -mekong_db ${DB} ${TESTPATH_CANONIC_LL} > /dev/null
+	opt -load ${POLLY_LIB} -load ${PASSPATH} -${STRUCTNAME} -mekong_db ${DB} -mekong_bin_db ${BIN_DB} ${TESTPATH_CANONIC_LL} > /dev/null
 fi
 #opt -debug -load ${POLLY_LIB} -load ${PASSPATH} -${STRUCTNAME} -mekong_db ${DB} ${TESTPATH_BC} > /dev/null